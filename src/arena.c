@@ -0,0 +1,37 @@
+/*
+ * arena.c — Bump allocator (both platforms)
+ */
+
+#include "arena.h"
+#include "pmm.h"
+#include <stdint.h>
+
+static arena_t *arenas;             /* registry, in creation order */
+
+int arena_init(arena_t *a, const char *name, unsigned order) {
+    a->name       = name;
+    a->base       = pmm_alloc(order);
+    a->size       = a->base ? (uint32_t)PAGE_SIZE << order : 0;
+    a->used       = 0;
+    a->high_water = 0;
+    a->next       = 0;
+
+    arena_t **link = &arenas;
+    while (*link) link = &(*link)->next;
+    *link = a;
+    return a->base != 0;
+}
+
+void *arena_alloc(arena_t *a, uint32_t size) {
+    uint32_t start = (a->used + 7) & ~7u;
+    if (size > a->size || start > a->size - size)
+        return 0;
+    a->used = start + size;
+    if (a->used > a->high_water)
+        a->high_water = a->used;
+    return a->base + start;
+}
+
+const arena_t *arena_list(void) {
+    return arenas;
+}
@@ -0,0 +1,47 @@
+/*
+ * arena.h — Bump allocator with bulk reset
+ *
+ * An arena is one contiguous block from the pmm plus an offset.  Each
+ * allocation just advances the offset; nothing is freed individually.
+ * Instead the whole arena is reset at once, when everything allocated
+ * from it is known to be dead:
+ *
+ *   [ used used used used | free ..................... ]
+ *                          ^ used
+ *
+ * The shell owns one such arena and resets it after every command, so a
+ * command can take scratch memory (shell_alloc(), shell.h) without ever
+ * having to free it — and nothing can leak from one command to the next.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+
+typedef struct arena {
+    const char    *name;
+    uint8_t       *base;
+    uint32_t       size;            /* bytes                          */
+    uint32_t       used;            /* bytes handed out since reset   */
+    uint32_t       high_water;      /* maximum of used so far         */
+    struct arena  *next;            /* all arenas, for meminfo        */
+} arena_t;
+
+/* arena_init() — Back the arena with 2^order pages from the pmm.
+ * Returns 0 if the pmm cannot provide them. */
+int arena_init(arena_t *a, const char *name, unsigned order);
+
+/* arena_alloc() — size bytes, 8-byte aligned, or NULL if the arena is
+ * full.  Constant time. */
+void *arena_alloc(arena_t *a, uint32_t size);
+
+/* arena_reset() — Forget every allocation at once. */
+static inline void arena_reset(arena_t *a) {
+    a->used = 0;
+}
+
+/* arena_list() — First registered arena; follow ->next. */
+const arena_t *arena_list(void);
+
+#endif
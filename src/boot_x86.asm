@@ -21,7 +21,8 @@
 ;    to _start.  EAX contains 0x2BADB002 (proof of Multiboot compliance)
 ;    and EBX points to a Multiboot information structure.
 ;
-; 5. This file: _start sets up a stack and calls our C function kernel_main().
+; 5. This file: _start loads our own GDT, sets up a stack and calls our C
+;    function kernel_main().
 ;
 ; MULTIBOOT SPECIFICATION (version 1)
 ; ------------------------------------
@@ -29,15 +30,20 @@
 ; 8 KB of the kernel image for a 4-byte-aligned magic header:
 ;
 ;   [magic]    = 0x1BADB002   ← the bootloader searches for this value
-;   [flags]    = 0x00000000   ← no optional features requested here
+;   [flags]    = 0x00000002   ← bit 1: please provide a memory map
 ;   [checksum] = -(magic + flags)  ← the 32-bit sum of all three must be 0
 ;
 ; The linker script guarantees .multiboot is the very first section in the
 ; binary, so the header is always within the first 8 KB.
+;
+; With flags bit 1 set, the information structure passed in EBX holds the
+; amount of RAM and the BIOS memory map.  _start passes EAX and EBX on to
+; kernel_main(magic, info); memmap.c reads them.
 ; =============================================================================
 
 MULTIBOOT_MAGIC    equ 0x1BADB002
-MULTIBOOT_FLAGS    equ 0x00
+MULTIBOOT_MEMINFO  equ 1 << 1
+MULTIBOOT_FLAGS    equ MULTIBOOT_MEMINFO
 MULTIBOOT_CHECKSUM equ -(MULTIBOOT_MAGIC + MULTIBOOT_FLAGS)
 
 ; ── Multiboot header ─────────────────────────────────────────────────────────
@@ -58,19 +64,92 @@ stack_bottom:
     resb 16384          ; 16 KB stack
 stack_top:
 
+; ── Global Descriptor Table ──────────────────────────────────────────────────
+;
+; The Multiboot specification guarantees flat 4 GB code and data segments on
+; entry, but NOT the selector values nor that the GDT they came from still
+; exists in memory.  The IDT (irq.c) must name a code selector for every
+; interrupt gate, so we install a GDT of our own with known selectors:
+;
+;   0x00 : null descriptor (required by the CPU)
+;   0x08 : code, base 0, limit 4 GB, ring 0, execute/read, 32-bit
+;   0x10 : data, base 0, limit 4 GB, ring 0, read/write,   32-bit
+;
+; Descriptor encoding of 0x00CF9A000000FFFF (code):
+;   limit 0xFFFFF with G=1 (4 KB units) → 4 GB, base 0,
+;   access 0x9A = present | ring 0 | code | readable, flags 0xC = 4 KB / 32-bit.
+; The data descriptor differs only in its access byte (0x92 = writable data).
+section .rodata
+align 8
+gdt:
+    dq 0x0000000000000000   ; null
+    dq 0x00CF9A000000FFFF   ; 0x08: kernel code
+    dq 0x00CF92000000FFFF   ; 0x10: kernel data
+gdt_end:
+
+gdt_ptr:
+    dw gdt_end - gdt - 1    ; limit (size in bytes - 1)
+    dd gdt                  ; linear base address
+
 ; ── Kernel entry point ───────────────────────────────────────────────────────
 section .text
 global _start           ; exported so the linker can find the entry point
 extern kernel_main      ; defined in kernel.c
+extern bootstats_early  ; defined in bootstats.c
 
 _start:
+    ; Install our GDT.  A far jump is the only way to reload CS; the data
+    ; segment registers are reloaded with plain MOVs.  CX is used for the
+    ; selector: EAX and EBX still hold the Multiboot magic and info pointer.
+    lgdt [gdt_ptr]
+    jmp 0x08:.reload_cs
+.reload_cs:
+    mov cx, 0x10
+    mov ds, cx
+    mov es, cx
+    mov fs, cx
+    mov gs, cx
+    mov ss, cx
+
     ; Load the stack pointer with the top of our reserved stack area.
     mov esp, stack_top
 
+    ; First boot stamp (bootstats.h): the TSC, counting since reset.  An
+    ; i486 has no TSC, and may not even have CPUID: CPUID exists if the
+    ; EFLAGS.ID bit (21) can be flipped, and leaf 1 reports the TSC in EDX
+    ; bit 4.  Without one, bootstats_early[0] stays 0.  EAX and EBX are
+    ; kept in ESI / EDI meanwhile: CPUID overwrites both.
+    mov esi, eax
+    mov edi, ebx
+    pushfd
+    pop eax
+    mov ecx, eax
+    xor eax, 1 << 21
+    push eax
+    popfd
+    pushfd
+    pop eax
+    push ecx            ; put the original EFLAGS back
+    popfd
+    cmp eax, ecx
+    je .no_tsc
+    mov eax, 1
+    cpuid
+    test edx, 1 << 4
+    jz .no_tsc
+    rdtsc
+    mov [bootstats_early], eax
+    mov [bootstats_early + 4], edx
+.no_tsc:
+    mov eax, esi
+    mov ebx, edi
+
     ; The System V i386 ABI requires ESP to be 16-byte aligned *before* CALL.
-    ; Push two dummy zero words to satisfy this requirement.
-    push 0
-    push 0
+    ; Four words keep that alignment; the last two pushed are the
+    ; arguments of kernel_main(magic, info), pushed right to left.
+    sub esp, 8
+    push ebx            ; info: Multiboot information structure
+    push eax            ; magic: 0x2BADB002
 
     ; Jump into the C kernel.
     call kernel_main
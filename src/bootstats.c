@@ -0,0 +1,55 @@
+/*
+ * bootstats.c — Boot phase table (both platforms)
+ *
+ * Every stamp is a raw counter value, 0 where none was taken; `bootstats`
+ * (cmd_boot.c) converts them to time once the frequency is known.
+ */
+
+#include "bootstats.h"
+#include "clock.h"
+#include <stdint.h>
+
+uint64_t bootstats_early[3];
+
+static uint64_t span[BOOT_PHASES][2];
+static uint64_t prompt;
+
+/* stamp() — The counter, or 0 on an x86 CPU without a TSC (the boot
+ * stub found none and left bootstats_early[0] at zero). */
+static uint64_t stamp(void) {
+#ifndef PLATFORM_RPI3
+    if (!bootstats_early[0])
+        return 0;
+#endif
+    return clock_cycles();
+}
+
+void bootstats_begin(boot_phase_t p) {
+    span[p][0] = stamp();
+}
+
+void bootstats_end(boot_phase_t p) {
+    span[p][1] = stamp();
+}
+
+void bootstats_prompt(void) {
+    if (!prompt)
+        prompt = stamp();
+}
+
+/* The stub's phases come from its early stamps. */
+int bootstats_get(boot_phase_t p, uint64_t *start, uint64_t *end) {
+    *start = span[p][0];
+    *end   = span[p][1];
+    if (p == BOOT_STUB)
+        *start = bootstats_early[0];
+    if (p == BOOT_BSS) {
+        *start = bootstats_early[1];
+        *end   = bootstats_early[2];
+    }
+    return *start && *end;
+}
+
+uint64_t bootstats_prompt_at(void) {
+    return prompt;
+}
@@ -0,0 +1,60 @@
+/*
+ * bootstats.h — Boot phase timing (both platforms)
+ *
+ * How long from power-on to the first `Kernel# ` prompt, and where does
+ * the time go?  Each phase of the boot is bracketed with
+ * bootstats_begin() / bootstats_end(), which store raw counter values
+ * (clock_cycles(), clock.h) in a static table; `bootstats` (cmd_boot.c)
+ * prints it.
+ *
+ * Raw values, because most of the boot runs before clock_init() has
+ * measured the counter frequency: they are only converted to time when
+ * printed.  The counter also runs from reset, before the kernel exists,
+ * so the first row is the firmware's share (BIOS / boot loader, or the
+ * VideoCore firmware on the Pi).
+ *
+ * The boot stubs take the earliest stamps themselves, in assembly:
+ *   x86 : the TSC at _start (CPUID is asked first: an i486 has none, and
+ *         then nothing is recorded at all).  The boot loader has already
+ *         cleared the BSS.
+ *   RPi3: CNTPCT_EL0 at _start, and around the MMU set-up and the BSS
+ *         clear, kept in callee-saved registers until the BSS is zero.
+ */
+
+#ifndef BOOTSTATS_H
+#define BOOTSTATS_H
+
+#include <stdint.h>
+
+typedef enum {
+    BOOT_STUB,          /* _start → kernel_main()                  */
+    BOOT_BSS,           /* RPi3: mmu_init() + BSS clear, in the stub */
+    BOOT_CONSOLE,       /* irq_init() … vga_init()                 */
+    BOOT_CLOCK,         /* clock_init(): TSC calibration on x86,
+                           rtc_init(): one careful RTC read        */
+    BOOT_KEYBOARD,      /* keyboard_init()                         */
+    BOOT_KBD_DRAIN,     /*   its PS/2 FIFO drain loop (x86)         */
+    BOOT_MEMORY,        /* memmap_detect() … slab_init()           */
+    BOOT_SMP,           /* smp_init(): waiting for cores 1–3       */
+    BOOT_PHASES
+} boot_phase_t;
+
+/* Stamps of the boot stubs: _start, BSS clear start, BSS clear end.
+ * Zero where not taken. */
+extern uint64_t bootstats_early[3];
+
+void bootstats_begin(boot_phase_t p);
+void bootstats_end(boot_phase_t p);
+
+/* bootstats_prompt() — The shell is about to print its first prompt;
+ * later calls are ignored. */
+void bootstats_prompt(void);
+
+/* bootstats_get() — Counter values at the start and end of phase p.
+ * Returns 0 if the phase was not timed on this platform or CPU. */
+int bootstats_get(boot_phase_t p, uint64_t *start, uint64_t *end);
+
+/* bootstats_prompt_at() — Counter value at the first prompt, or 0. */
+uint64_t bootstats_prompt_at(void);
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * clock.c — TSC calibration against PIT channel 2 (x86)
+ *
+ * MEASURING THE TSC
+ * ------------------
+ * PIT channel 2 counts at a known 1,193,180 Hz and, unlike channel 0,
+ * its output can be read back: bit 5 of port 0x61.  In mode 0 ("interrupt
+ * on terminal count") that output goes high once the programmed count
+ * has run down.  So:
+ *
+ *   1. port 0x61: gate of channel 2 on (bit 0), speaker off (bit 1)
+ *   2. control word 0xB0: channel 2, low/high byte, mode 0, binary
+ *   3. load CALIBRATE_COUNT — the countdown starts — and read the TSC
+ *   4. poll port 0x61 until bit 5 is set, read the TSC again
+ *
+ * The TSC advanced by f × CALIBRATE_COUNT / 1,193,180 cycles.  20 ms is
+ * long enough for the microsecond or so a port read takes (much more
+ * under QEMU) to stay below 0.01 %.  Channel 2 also drives the PC
+ * speaker, so port 0x61 is put back as it was; sound.c reprograms the
+ * channel for every note anyway.
+ *
+ * 64-BIT DIVISION
+ * ----------------
+ * Computing clock_mult divides a 64-bit value by a 32-bit one, which
+ * i386 C would compile to a call to libgcc's __udivdi3.  div64_32()
+ * (clock.h) does it with the DIV instruction instead.
+ */
+
+#include "clock.h"
+#include "io.h"
+#include <stdint.h>
+
+#define PIT_BASE_FREQ   1193180UL
+#define PIT_CH2         0x42
+#define PIT_CMD         0x43
+#define PORT_B          0x61        /* speaker gate / channel 2 output */
+#define PORTB_GATE2     0x01
+#define PORTB_SPEAKER   0x02
+#define PORTB_OUT2      0x20
+
+#define CALIBRATE_COUNT 23864       /* 20 ms of PIT input clock */
+
+#define CPUID_TSC       (1u << 4)   /* leaf 1, EDX          */
+#define CPUID_INVTSC    (1u << 8)   /* leaf 0x80000007, EDX */
+
+uint64_t clock_base;
+uint32_t clock_mult;
+
+static const char *source = "tick";
+static uint32_t    khz;
+
+static void cpuid(uint32_t leaf, uint32_t *eax, uint32_t *edx) {
+    uint32_t ebx, ecx;
+    __asm__ volatile ("cpuid" : "=a"(*eax), "=b"(ebx), "=c"(ecx), "=d"(*edx) : "a"(leaf));
+}
+
+/* tsc_measure() — Steps 1–4 above: TSC cycles in CALIBRATE_COUNT. */
+static uint32_t tsc_measure(void) {
+    uint8_t portb = inb(PORT_B);
+    outb(PORT_B, (portb & ~PORTB_SPEAKER) | PORTB_GATE2);
+
+    outb(PIT_CMD, 0xB0);
+    outb(PIT_CH2, CALIBRATE_COUNT & 0xFF);
+    outb(PIT_CH2, CALIBRATE_COUNT >> 8);
+    uint64_t start = clock_cycles();
+    while (!(inb(PORT_B) & PORTB_OUT2))
+        ;
+    uint64_t cycles = clock_cycles() - start;
+
+    outb(PORT_B, portb);
+    return (uint32_t)cycles;        /* < 2^32 below ~200 GHz */
+}
+
+void clock_init(void) {
+    uint32_t eax, edx;
+    cpuid(1, &eax, &edx);
+    if (!(edx & CPUID_TSC))
+        return;                     /* clock_ns() uses timer_ticks() */
+
+    uint32_t cycles = tsc_measure();
+    uint32_t ns = (uint32_t)div64_32((uint64_t)CALIBRATE_COUNT * 1000000000u, PIT_BASE_FREQ);
+
+    /* mult = ns per cycle × 2^CLOCK_SHIFT; overflows only below 4 MHz. */
+    if (!cycles || ((uint64_t)ns << CLOCK_SHIFT) >> 32 >= cycles)
+        return;
+    clock_mult = (uint32_t)div64_32((uint64_t)ns << CLOCK_SHIFT, cycles);
+    khz        = (uint32_t)div64_32((uint64_t)cycles * 1000000u, ns);
+
+    cpuid(0x80000000, &eax, &edx);
+    if (eax >= 0x80000007) {
+        cpuid(0x80000007, &eax, &edx);
+        source = edx & CPUID_INVTSC ? "tsc (invariant)" : "tsc";
+    } else {
+        source = "tsc";
+    }
+    clock_base = clock_cycles();
+}
+
+const char *clock_source(void) {
+    return source;
+}
+
+uint32_t clock_khz(void) {
+    return khz;
+}
@@ -0,0 +1,117 @@
+/*
+ * clock.h — High-resolution monotonic clock: nanoseconds since boot
+ *
+ * timer.h counts milliseconds, which is too coarse to measure how long a
+ * flush, an interrupt handler or a memcpy takes.  clock_ns() reads a
+ * free-running CPU counter instead and scales it to nanoseconds:
+ *
+ *   x86 : the Time Stamp Counter (RDTSC), counting CPU clock cycles.
+ *         Its frequency is not reported anywhere, so clock_init()
+ *         measures it against PIT channel 2 once at boot (clock.c).
+ *   RPi3: the ARM generic timer's physical count CNTPCT_EL0, whose
+ *         frequency the firmware stores in CNTFRQ_EL0 (19.2 MHz on the
+ *         board, 62.5 MHz under QEMU) (clock_rpi3.c).
+ *
+ * Both are a single instruction with no port or MMIO access, so
+ * clock_ns() is cheap enough for hot paths: a counter read, one
+ * subtraction and a fixed-point multiply.
+ *
+ * FIXED-POINT SCALING
+ * --------------------
+ * ns = ticks × clock_mult / 2^CLOCK_SHIFT, where clock_init() computes
+ * clock_mult = 10^9 × 2^CLOCK_SHIFT / frequency.  No division at run
+ * time, and on i386 no 64×64-bit multiply (which would need libgcc):
+ * the tick count is multiplied one 32-bit half at a time.
+ *
+ * INVARIANT TSC
+ * --------------
+ * On old x86 CPUs the TSC rate follows the core clock, which power
+ * management changes on the fly.  CPUs with an INVARIANT TSC (CPUID
+ * 0x80000007 EDX bit 8) count at a constant rate in every power state;
+ * clock_source() reports which kind was found.  Hypervisors often do not
+ * advertise the bit even though their TSC is constant, so the TSC is
+ * used either way.  A CPU without any TSC (i486) falls back to
+ * timer_ticks() at millisecond resolution.
+ *
+ * RDTSC is not a serialising instruction: the CPU may execute it a few
+ * instructions early or late.  That is noise of a few nanoseconds, far
+ * below anything worth measuring with it.
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+
+/* clock_init() — Measure (x86) or read (RPi3) the counter frequency and
+ * make clock_ns() count from now.  Call before timer_init(), which
+ * schedules its deadlines on this clock. */
+void clock_init(void);
+
+/* clock_source() — "tsc (invariant)", "tsc", "tick" or "cntpct". */
+const char *clock_source(void);
+
+/* clock_khz() — Counter frequency in kHz (0 for "tick"). */
+uint32_t clock_khz(void);
+
+/* div64_32() — n / d without libgcc's __udivdi3 on i386: two DIV
+ * instructions, high word first, so neither quotient can overflow. */
+static inline uint64_t div64_32(uint64_t n, uint32_t d) {
+#ifndef PLATFORM_RPI3
+    uint32_t hi = (uint32_t)(n >> 32), lo, r = hi % d;
+    __asm__ ("divl %4" : "=a"(lo), "=d"(r) : "0"((uint32_t)n), "1"(r), "rm"(d));
+    return ((uint64_t)(hi / d) << 32) | lo;
+#else
+    return n / d;
+#endif
+}
+
+#ifndef PLATFORM_RPI3
+
+#include "timer.h"
+
+#define CLOCK_SHIFT 24              /* mult fits 32 bits down to 4 MHz */
+
+extern uint64_t clock_base;         /* TSC value at clock_init()       */
+extern uint32_t clock_mult;         /* 0: no TSC, use timer_ticks()    */
+
+/* clock_cycles() — Raw TSC value. */
+static inline uint64_t clock_cycles(void) {
+    uint32_t lo, hi;
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/* clock_ns() — Nanoseconds since clock_init(). */
+static inline uint64_t clock_ns(void) {
+    if (__builtin_expect(!clock_mult, 0))
+        return (uint64_t)timer_ticks() * 1000000u;
+    uint64_t d = clock_cycles() - clock_base;
+    return (((uint64_t)(uint32_t)d * clock_mult) >> CLOCK_SHIFT)
+         + (((uint64_t)(uint32_t)(d >> 32) * clock_mult) << (32 - CLOCK_SHIFT));
+}
+
+#else   /* PLATFORM_RPI3 */
+
+#define CLOCK_SHIFT 32
+
+extern uint64_t clock_base;         /* CNTPCT_EL0 at clock_init() */
+extern uint64_t clock_mult;
+
+/* clock_cycles() — Raw CNTPCT_EL0.  The ISB keeps the read from being
+ * performed ahead of the instructions before it. */
+static inline uint64_t clock_cycles(void) {
+    uint64_t v;
+    __asm__ volatile ("isb; mrs %0, cntpct_el0" : "=r"(v) : : "memory");
+    return v;
+}
+
+/* clock_ns() — The 64×64 → 128-bit product is one MUL + UMULH. */
+static inline uint64_t clock_ns(void) {
+    unsigned __int128 p = (unsigned __int128)(clock_cycles() - clock_base) * clock_mult;
+    return (uint64_t)(p >> CLOCK_SHIFT);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * clock_rpi3.c — Nanosecond clock from the ARM generic timer (RPi3)
+ *
+ * Every Cortex-A53 has a 64-bit system counter, CNTPCT_EL0, that ticks at
+ * a fixed rate on all cores and in every power state — the AArch64
+ * equivalent of an invariant TSC.  The rate is not probed: the firmware
+ * writes it to CNTFRQ_EL0 before starting the kernel, and boot_rpi3.S
+ * lets EL1 read the counter (CNTHCTL_EL2.EL1PCTEN).
+ *
+ * clock_mult = 10^9 × 2^32 / CNTFRQ is computed once here; 64-bit
+ * division is a single UDIV instruction on AArch64.
+ */
+
+#include "clock.h"
+#include <stdint.h>
+
+uint64_t clock_base;
+uint64_t clock_mult;
+
+static uint32_t khz;
+
+void clock_init(void) {
+    uint64_t freq;
+    __asm__ volatile ("mrs %0, cntfrq_el0" : "=r"(freq));
+    if (!freq)
+        freq = 19200000;            /* the board's crystal, if unset */
+    khz        = (uint32_t)(freq / 1000);
+    clock_mult = (1000000000ull << CLOCK_SHIFT) / freq;
+    clock_base = clock_cycles();
+}
+
+const char *clock_source(void) {
+    return "cntpct";
+}
+
+uint32_t clock_khz(void) {
+    return khz;
+}
@@ -0,0 +1,286 @@
+/*
+ * cmd_bench.c — `bench [N]`: console, timer and memory primitives
+ *
+ * Numbers for comparing machines — QEMU with TCG or with KVM, real
+ * hardware — taken from inside the kernel with clock_ns() (clock.h).
+ * Every case runs once untimed (caches, a full screen), then N times
+ * (default 10); the table gives the minimum, median and maximum of the N
+ * samples.  The minimum is what the machine can do, the spread is what
+ * interrupts, the other tasks and the host add to it.
+ *
+ *   text, one row    25 × 80 characters, each line rewriting the same row
+ *                    ("\r"): drawing without scrolling
+ *   text, scrolling  25 lines of 80 characters, each one scrolling
+ *   uart (RPi3)      2000 bytes through uart_write(), until uart_sync()
+ *                    has seen them leave: the line speed itself (waiting
+ *                    for room in the ring, even with a framebuffer)
+ *   vga_clear        one call
+ *   vga_flash        one call, including its 100 ms pause
+ *   sleep 1 / 10 ms  how late timer_sleep_ms() returns, by clock_ns()
+ *   cmos_read (x86)  one register read: two port accesses and io_wait()
+ *   rtc_now          what `date` and `time` cost instead (rtc.h)
+ *   memcpy / memset  bandwidth at 64 B, 4 KB and 64 KB (kstring.h)
+ *
+ * The text goes through console_write(), like everything the kernel
+ * prints.  On x86 the VGA sink draws it and the serial sink only queues
+ * it (uart.h: what does not fit is dropped), so the rate is the screen's.
+ * So it is on RPi3 with an HDMI framebuffer (fb.h); without one the
+ * console IS the serial line, and once the TX ring is full the text
+ * cases run at its speed too (115200 baud: about 11.5 KB/s).
+ *
+ * Measuring scribbles over the screen: the results are kept until the
+ * end and printed on a cleared screen.
+ *
+ * One bench at a time: the buffers, text_row[] and the UART drop
+ * setting are shared, and two runs would only measure each other.  A
+ * second `bench` while one runs (`bench &`, then `bench`) is refused.
+ */
+
+#include "shell.h"
+#include "kprintf.h"
+#include "console.h"
+#include "vga.h"
+#include "uart.h"
+#include "timer.h"
+#include "clock.h"
+#include "kstring.h"
+#include "pmm.h"
+#include "rtc.h"
+#include "task.h"
+#include "irq.h"
+#include <stdint.h>
+
+#define BENCH_DEFAULT 10
+#define BENCH_MAX     32                /* samples per case */
+#define TEXT_LINES    25
+#define TEXT_WIDTH    80
+#define MEM_ORDER     4                 /* 64 KB buffers */
+#define MEM_SAMPLE    (256u * 1024u)    /* bytes moved per sample */
+
+typedef enum {
+    PER_OP_NS,          /* time per operation, in ns                 */
+    PER_OP_US,          /*                     in µs                 */
+    LATE_US,            /* µs beyond the arg milliseconds asked for  */
+    PER_SECOND,         /* work units per second                     */
+    MB_PER_SECOND,      /* work bytes per second, in MB (10^6 bytes) */
+} bench_unit_t;
+
+typedef struct {
+    const char   *name;
+    void        (*run)(uint32_t arg);
+    uint32_t      arg;
+    uint32_t      work;     /* operations, characters or bytes per run */
+    bench_unit_t  unit;
+    const char   *label;
+} bench_case_t;
+
+static char     text_row[TEXT_WIDTH], text_line[TEXT_WIDTH];
+static uint8_t *mem_src, *mem_dst;
+static int      busy;                   /* a bench owns the above */
+
+/* ── The cases ────────────────────────────────────────────────────── */
+
+static void run_text(uint32_t scroll) {
+    const char *s = scroll ? text_line : text_row;
+    for (int i = 0; i < TEXT_LINES; i++)
+        console_write(s, TEXT_WIDTH);
+}
+
+#ifdef PLATFORM_RPI3
+static void run_uart(uint32_t arg) {
+    (void)arg;
+    int drop = uart_set_drop(0);
+    for (int i = 0; i < TEXT_LINES; i++)
+        uart_write(text_row, TEXT_WIDTH);
+    uart_sync();
+    uart_set_drop(drop);
+}
+#endif
+
+static void run_clear(uint32_t arg) {
+    (void)arg;
+    vga_clear();
+}
+
+static void run_flash(uint32_t arg) {
+    (void)arg;
+    vga_flash();
+}
+
+static void run_sleep(uint32_t ms) {
+    timer_sleep_ms(ms);
+}
+
+#ifndef PLATFORM_RPI3
+static void run_cmos(uint32_t arg) {
+    for (int i = 0; i < 16; i++)
+        cmos_read((uint8_t)arg);
+}
+#endif
+
+static void run_rtc_now(uint32_t arg) {
+    rtc_time_t t;
+    for (uint32_t i = 0; i < arg; i++) {
+        rtc_now(&t);
+        __asm__ volatile ("" : : "r"(&t) : "memory");
+    }
+}
+
+/* The empty asm tells the compiler the buffers are used, so that it can
+ * neither merge the repeated calls nor drop them. */
+static void run_memcpy(uint32_t size) {
+    for (uint32_t n = 0; n < MEM_SAMPLE; n += size) {
+        memcpy(mem_dst, mem_src, size);
+        __asm__ volatile ("" : : : "memory");
+    }
+}
+
+static void run_memset(uint32_t size) {
+    for (uint32_t n = 0; n < MEM_SAMPLE; n += size) {
+        memset(mem_dst, (int)n, size);
+        __asm__ volatile ("" : : : "memory");
+    }
+}
+
+static const bench_case_t cases[] = {
+    { "text, one row",   run_text,  0, TEXT_LINES * TEXT_WIDTH, PER_SECOND, "char/s" },
+    { "text, scrolling", run_text,  1, TEXT_LINES * TEXT_WIDTH, PER_SECOND, "char/s" },
+#ifdef PLATFORM_RPI3
+    { "uart",            run_uart,  0, TEXT_LINES * TEXT_WIDTH, PER_SECOND, "B/s" },
+#endif
+    { "vga_clear",       run_clear, 0, 1,  PER_OP_US, "us" },
+    { "vga_flash",       run_flash, 0, 1,  PER_OP_US, "us" },
+    { "sleep 1 ms",      run_sleep, 1, 1,  LATE_US,   "us late" },
+    { "sleep 10 ms",     run_sleep, 10, 1, LATE_US,   "us late" },
+#ifndef PLATFORM_RPI3
+    { "cmos_read",       run_cmos,  0x0A, 16, PER_OP_NS, "ns" },
+#endif
+    { "rtc_now",         run_rtc_now, 16, 16, PER_OP_NS, "ns" },
+    { "memcpy 64 B",     run_memcpy, 64,    MEM_SAMPLE, MB_PER_SECOND, "MB/s" },
+    { "memcpy 4 KB",     run_memcpy, 4096,  MEM_SAMPLE, MB_PER_SECOND, "MB/s" },
+    { "memcpy 64 KB",    run_memcpy, 65536, MEM_SAMPLE, MB_PER_SECOND, "MB/s" },
+    { "memset 64 B",     run_memset, 64,    MEM_SAMPLE, MB_PER_SECOND, "MB/s" },
+    { "memset 4 KB",     run_memset, 4096,  MEM_SAMPLE, MB_PER_SECOND, "MB/s" },
+    { "memset 64 KB",    run_memset, 65536, MEM_SAMPLE, MB_PER_SECOND, "MB/s" },
+};
+
+#define CASES (sizeof(cases) / sizeof(cases[0]))
+
+/* ── Statistics ───────────────────────────────────────────────────── */
+
+/* rate() — num / ns, both halved until ns fits div64_32()'s divisor. */
+static uint32_t rate(uint64_t num, uint64_t ns) {
+    while (ns >> 32) {
+        ns  >>= 1;
+        num >>= 1;
+    }
+    return (uint32_t)div64_32(num, (uint32_t)ns);
+}
+
+/* value() — One sample of c, ns long, in the case's unit. */
+static uint32_t value(const bench_case_t *c, uint64_t ns) {
+    uint64_t late = (uint64_t)c->arg * 1000000u;
+    if (!ns)
+        ns = 1;
+    switch (c->unit) {
+    case PER_OP_NS:     return (uint32_t)div64_32(ns, c->work);
+    case PER_OP_US:     return (uint32_t)div64_32(ns, c->work * 1000u);
+    case LATE_US:       return ns > late ? (uint32_t)div64_32(ns - late, 1000u) : 0;
+    case PER_SECOND:    return rate((uint64_t)c->work * 1000000000u, ns);
+    default:            return rate((uint64_t)c->work * 1000u, ns);
+    }
+}
+
+static void sort(uint32_t *v, unsigned n) {
+    for (unsigned i = 1; i < n; i++) {
+        uint32_t x = v[i];
+        unsigned j = i;
+        for (; j > 0 && v[j - 1] > x; j--)
+            v[j] = v[j - 1];
+        v[j] = x;
+    }
+}
+
+/* measure() — Warm up, take n samples of c, and store min/median/max. */
+static void measure(const bench_case_t *c, unsigned n, uint32_t out[3]) {
+    uint32_t v[BENCH_MAX];
+
+    c->run(c->arg);
+    for (unsigned i = 0; i < n; i++) {
+        uint64_t t0 = clock_ns();
+        c->run(c->arg);
+        v[i] = value(c, clock_ns() - t0);
+    }
+    sort(v, n);
+    out[0] = v[0];
+    out[1] = v[n / 2];
+    out[2] = v[n - 1];
+}
+
+/* ── The command ──────────────────────────────────────────────────── */
+
+/* parse_iters() — Optional N, 1 to BENCH_MAX. */
+static int parse_iters(const char *arg, shell_args_t *out) {
+    if (!arg) {
+        out->num = BENCH_DEFAULT;
+        return 1;
+    }
+    return shell_arg_uint(arg, out) && out->num >= 1 && out->num <= BENCH_MAX;
+}
+
+static void cmd_bench(const shell_args_t *args) {
+    unsigned n = args->num;
+    uint32_t res[CASES][3];
+    uint8_t  done[CASES];
+
+    /* A kill runs no cleanup (task.h): `bench &` must not die holding
+     * busy or the buffers, or in run_uart() with the drop setting
+     * changed. */
+    task_nokill_begin();
+    irq_flags_t f = irq_save();
+    int taken = busy;
+    busy = 1;
+    irq_restore(f);
+    if (taken) {
+        task_nokill_end();
+        kprintf("\nbench: already running (see jobs).\n");
+        return;
+    }
+
+    for (int i = 0; i < TEXT_WIDTH - 1; i++)
+        text_row[i] = text_line[i] = (char)('0' + i % 10);
+    text_row[TEXT_WIDTH - 1]  = '\r';
+    text_line[TEXT_WIDTH - 1] = '\n';
+
+    mem_src = pmm_alloc(MEM_ORDER);
+    mem_dst = pmm_alloc(MEM_ORDER);
+
+    kprintf("\n");
+    for (unsigned i = 0; i < CASES; i++) {
+        const bench_case_t *c = &cases[i];
+        done[i] = c->unit != MB_PER_SECOND || (mem_src && mem_dst);
+        if (done[i])
+            measure(c, n, res[i]);
+    }
+
+    if (mem_src) pmm_free(mem_src, MEM_ORDER);
+    if (mem_dst) pmm_free(mem_dst, MEM_ORDER);
+    busy = 0;
+    task_nokill_end();
+
+    vga_clear();
+    kprintf("bench: %u samples each, clock %s, memcpy %s\n\n",
+            n, clock_source(), kstring_impl());
+    kprintf("%-18s%-9s%11s%11s%11s\n", "case", "unit", "min", "median", "max");
+    for (unsigned i = 0; i < CASES; i++) {
+        if (!done[i]) {
+            kprintf("%-18s(no memory for the buffers)\n", cases[i].name);
+            continue;
+        }
+        kprintf("%-18s%-9s%11u%11u%11u\n", cases[i].name, cases[i].label,
+                res[i][0], res[i][1], res[i][2]);
+    }
+}
+
+SHELL_COMMAND(bench, cmd_bench, parse_iters, "bench [N]",
+              "console, timer and memory benchmarks, N runs each");
@@ -0,0 +1,61 @@
+/*
+ * cmd_boot.c — `bootstats`: where the boot time went (bootstats.h)
+ */
+
+#include "shell.h"
+#include "kprintf.h"
+#include "bootstats.h"
+#include "clock.h"
+#include <stdint.h>
+
+static const char *const names[BOOT_PHASES] = {
+    [BOOT_STUB]      = "boot stub",
+    [BOOT_BSS]       = "  mmu + bss clear",
+    [BOOT_CONSOLE]   = "irq, uart, console, vga",
+    [BOOT_CLOCK]     = "clock_init + rtc_init",
+    [BOOT_KEYBOARD]  = "keyboard_init",
+    [BOOT_KBD_DRAIN] = "  ps/2 drain",
+    [BOOT_MEMORY]    = "memmap, pmm, slab",
+    [BOOT_SMP]       = "smp_init",
+};
+
+/* to_us() — Counter cycles → microseconds: cycles × 1000 / kHz. */
+static uint32_t to_us(uint64_t cycles) {
+    return (uint32_t)div64_32(cycles * 1000u, clock_khz());
+}
+
+static void row(const char *name, uint64_t start, uint64_t end) {
+    uint32_t at  = to_us(start);
+    uint32_t len = to_us(end - start);
+    kprintf("%-24s%6u.%03u%7u.%03u\n", name, at / 1000, at % 1000,
+            len / 1000, len % 1000);
+}
+
+/*
+ * cmd_bootstats() — One row per timed phase: when it started, counted
+ * from counter reset, and how long it took.  The gaps between rows are
+ * the init steps too short to be worth a phase of their own.
+ */
+static void cmd_bootstats(const shell_args_t *args) {
+    (void)args;
+    uint64_t entry, end, prompt = bootstats_prompt_at();
+
+    if (!bootstats_get(BOOT_STUB, &entry, &end) || !clock_khz()) {
+        kprintf("\nNo cycle counter: the boot was not timed.\n");
+        return;
+    }
+    kprintf("\n%-24s%10s%11s\n", "phase", "at (ms)", "took (ms)");
+    row("firmware", 0, entry);
+    for (int p = 0; p < BOOT_PHASES; p++) {
+        uint64_t a, b;
+        if (bootstats_get(p, &a, &b))
+            row(names[p], a, b);
+    }
+    if (prompt) {
+        row("first prompt", prompt, prompt);
+        uint32_t total = to_us(prompt - entry);
+        kprintf("\n_start to first prompt: %u.%03u ms\n", total / 1000, total % 1000);
+    }
+}
+
+SHELL_COMMAND(bootstats, cmd_bootstats, 0, "bootstats", "time taken by each boot phase");
@@ -0,0 +1,49 @@
+/*
+ * cmd_idle.c — `idle`: timer wake-ups and idle residency (timer.h)
+ */
+
+#include "shell.h"
+#include "kprintf.h"
+#include "timer.h"
+#include "clock.h"
+#include <stdint.h>
+
+/*
+ * print_window() — One row for the interval between two snapshots.
+ * Rates are computed in milliseconds, with div64_32() for the 64-bit
+ * nanosecond counters (x86 has no 64-bit division).
+ */
+static void print_window(const char *label, const timer_stats_t *a,
+                         const timer_stats_t *b) {
+    uint32_t span_ms = (uint32_t)div64_32(b->uptime_ns - a->uptime_ns, 1000000u);
+    uint32_t idle_ms = (uint32_t)div64_32(b->idle_ns - a->idle_ns, 1000000u);
+    uint32_t wakeups = b->wakeups - a->wakeups;
+    if (!span_ms)
+        span_ms = 1;
+
+    uint32_t rate10 = (uint32_t)div64_32((uint64_t)wakeups * 10000u, span_ms);
+    uint32_t idle10 = (uint32_t)div64_32((uint64_t)idle_ms * 1000u, span_ms);
+    kprintf("%-12s%8u%9u%7u.%u%12u%6u.%u%%\n", label, span_ms / 1000, wakeups,
+            rate10 / 10, rate10 % 10, b->timer_irqs - a->timer_irqs,
+            idle10 / 10, idle10 % 10);
+}
+
+/*
+ * cmd_idle() — Totals since boot, then one second measured live: with
+ * the one-shot timer an idle second shows a single wake-up (the end of
+ * the measurement itself); with the PIT tick, a thousand.
+ */
+static void cmd_idle(const shell_args_t *args) {
+    (void)args;
+    timer_stats_t boot = { 0 }, a, b;
+
+    kprintf("\nTimer: %s\n", timer_mode());
+    kprintf("             seconds  wakeups     /s  timer IRQs   idle\n");
+    timer_stats(&a);
+    print_window("since boot", &boot, &a);
+    timer_sleep_ms(1000);
+    timer_stats(&b);
+    print_window("last second", &a, &b);
+}
+
+SHELL_COMMAND(idle, cmd_idle, 0, "idle", "timer wake-ups and idle residency");
@@ -0,0 +1,53 @@
+/*
+ * cmd_initrd.c — `ls`, `cat` and `run`: the initial RAM disk (initrd.h)
+ *
+ * `cat` hands the file's bytes to the console as they lie in the
+ * archive, in one write; `run` feeds them to shell_script().
+ */
+
+#include "shell.h"
+#include "kprintf.h"
+#include "console.h"
+#include "initrd.h"
+#include <stdint.h>
+
+/* lookup() — Look a file up, or say it is not there. */
+static int lookup(const char *name, initrd_file_t *f) {
+    if (initrd_open(name, f))
+        return 1;
+    if (!initrd_count())
+        kprintf("\nNo initrd: boot with one (see make INITRD=).\n");
+    else
+        kprintf("\n%s: no such file.\n", name);
+    return 0;
+}
+
+static void cmd_ls(const shell_args_t *args) {
+    (void)args;
+    initrd_file_t f = { 0 };
+
+    kprintf("\n");
+    while (initrd_next(&f))
+        kprintf("%8u  %s\n", f.size, f.name);
+    kprintf("%u files, %u bytes of archive\n", initrd_count(), initrd_size());
+}
+
+static void cmd_cat(const shell_args_t *args) {
+    initrd_file_t f;
+    if (!lookup(args->str, &f))
+        return;
+    kprintf("\n");
+    console_write(f.data, f.size);
+    if (f.size && f.data[f.size - 1] != '\n')
+        kprintf("\n");
+}
+
+static void cmd_run(const shell_args_t *args) {
+    initrd_file_t f;
+    if (lookup(args->str, &f))
+        shell_script(f.name, f.data, f.size);
+}
+
+SHELL_COMMAND(ls, cmd_ls, 0, "ls", "list the files of the initrd");
+SHELL_COMMAND(cat, cmd_cat, shell_arg_string, "cat <file>", "print an initrd file");
+SHELL_COMMAND(run, cmd_run, shell_arg_string, "run <script>", "run the commands in an initrd file");
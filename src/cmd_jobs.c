@@ -0,0 +1,36 @@
+/*
+ * cmd_jobs.c — `jobs` and `kill`: the tasks on core 0 (task.h)
+ *
+ * `jobs` lists every live task, the shell included, with the CPU time it
+ * has had so far; start one with a trailing '&' on any command line.
+ * `kill` takes the task id from that list (the number after the job
+ * number when the job started), not the job number.
+ */
+
+#include "shell.h"
+#include "kprintf.h"
+#include "task.h"
+#include "clock.h"
+#include <stdint.h>
+
+static void cmd_jobs(const shell_args_t *args) {
+    (void)args;
+    task_info_t t[TASK_MAX];
+    unsigned n = task_list(t, TASK_MAX);
+
+    kprintf("\n  ID  STATE    CPU ms  NAME\n");
+    for (unsigned i = 0; i < n; i++)
+        kprintf("%4d  %-5s %9u  %s\n", t[i].id, task_state_name(t[i].state),
+                (uint32_t)div64_32(t[i].run_ns, 1000000u), t[i].name);
+}
+
+static void cmd_kill(const shell_args_t *args) {
+    int id = (int)args->num;
+    if (id == 0)
+        kprintf("\nTask 0 is the shell.\n");
+    else if (!task_kill(id))
+        kprintf("\nNo task %d to kill.\n", id);
+}
+
+SHELL_COMMAND(jobs, cmd_jobs, 0, "jobs", "list tasks and their CPU time");
+SHELL_COMMAND(kill, cmd_kill, shell_arg_uint, "kill <id>", "end a background task");
@@ -0,0 +1,30 @@
+/*
+ * cmd_mem.c — `meminfo`: page allocator, slab caches and arenas
+ */
+
+#include "shell.h"
+#include "kprintf.h"
+#include "pmm.h"
+#include "slab.h"
+#include "arena.h"
+#include <stdint.h>
+
+/*
+ * cmd_meminfo() — Page allocator totals, then every slab cache and
+ * arena with its current use and high-water mark.
+ */
+static void cmd_meminfo(const shell_args_t *args) {
+    (void)args;
+    kprintf("\nPages (4 KB): %u free of %u\n\n", pmm_free_pages(), pmm_total_pages());
+
+    kprintf("cache           size  in use    peak  slabs\n");
+    for (const kmem_cache_t *c = kmem_cache_list(); c; c = c->next)
+        kprintf("%-14s%6u%8u%8u%7u\n", c->name, c->obj_size, c->in_use,
+                c->high_water, c->slabs);
+
+    kprintf("\narena           size    used    peak\n");
+    for (const arena_t *a = arena_list(); a; a = a->next)
+        kprintf("%-14s%6u%8u%8u\n", a->name, a->size, a->used, a->high_water);
+}
+
+SHELL_COMMAND(meminfo, cmd_meminfo, 0, "meminfo", "page, slab and arena usage");
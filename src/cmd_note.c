@@ -0,0 +1,19 @@
+/*
+ * cmd_note.c — `note`: play a sequence of notes in the background (sound.c)
+ */
+
+#include "shell.h"
+#include "sound.h"
+#include "kprintf.h"
+#include "kstring.h"
+
+static void cmd_note(const shell_args_t *args) {
+    if (strcmp(args->str, "stop") == 0)
+        sound_stop();
+    else if (!sound_sequence(args->str))
+        kprintf("note: notes do re mi fa sol la si, rest -, tempo t<20-600>, octave o<1-8>\n");
+}
+
+SHELL_COMMAND(note, cmd_note, shell_arg_string,
+              "note <notes> | note stop  (e.g. note t90 o5 do re mi)",
+              "play notes in the background (do re mi fa sol la si)");
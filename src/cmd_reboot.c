@@ -0,0 +1,64 @@
+/*
+ * cmd_reboot.c — `reboot`
+ *
+ * SYSTEM RESET
+ * -------------
+ * x86: Write 0xFE to port 0x64 (PS/2 controller command port).
+ *   The keyboard controller (Intel 8042) then pulses the CPU RESET#
+ *   line, causing an immediate hard reset — the standard software reboot
+ *   mechanism on PC hardware, equivalent to pressing the physical reset
+ *   button.  The hlt loop is defensive; it should never execute after
+ *   the reset fires.
+ *
+ * RPi3: Write to the BCM2837 Power Management / Watchdog registers.
+ *   PM_RSTC (0x3F10001C): reset control register.
+ *   PM_WDOG (0x3F100024): watchdog timer (set to 32 ticks ≈ immediate).
+ *   Setting PM_WDOG to a small tick count and PM_RSTC to the full-chip-
+ *   reset mode triggers an immediate hardware reset.  The magic password
+ *   0x5A000000 must be ORed into every write, or the hardware ignores it.
+ */
+
+#include "shell.h"
+#include "kprintf.h"
+#include "qemu.h"
+#ifndef PLATFORM_RPI3
+#  include "io.h"
+#endif
+#include <stdint.h>
+
+static void cmd_reboot(const shell_args_t *args) {
+    (void)args;
+#ifndef PLATFORM_RPI3
+    outb(0x64, 0xFE);                       /* PS/2: pulse CPU RESET# line */
+    for (;;) __asm__ volatile ("hlt");
+#else
+    volatile uint32_t *PM_WDOG = (volatile uint32_t *)0x3F100024UL;
+    volatile uint32_t *PM_RSTC = (volatile uint32_t *)0x3F10001CUL;
+    *PM_WDOG = 0x5A000020U;                 /* watchdog timeout: 32 ticks  */
+    *PM_RSTC = 0x5A000020U;                 /* full chip reset             */
+    for (;;) __asm__ volatile ("wfe");
+#endif
+}
+
+SHELL_COMMAND(reboot, cmd_reboot, 0, "reboot", "restart the computer");
+
+/* parse_code() — Optional exit code, 0 to 255 (default 0). */
+static int parse_code(const char *arg, shell_args_t *out) {
+    if (!arg) {
+        out->num = 0;
+        return 1;
+    }
+    return shell_arg_uint(arg, out) && out->num <= 255;
+}
+
+static void cmd_exit(const shell_args_t *args) {
+    qemu_exit((uint8_t)args->num);
+#ifndef PLATFORM_RPI3
+    kprintf("\nexit: needs QEMU with -device isa-debug-exit,iobase=0xf4\n");
+#else
+    kprintf("\nexit: needs QEMU with -semihosting\n");
+#endif
+}
+
+SHELL_COMMAND(exit, cmd_exit, parse_code, "exit [code]",
+              "leave QEMU with an exit status (scripted runs)");
@@ -0,0 +1,33 @@
+/*
+ * cmd_rtc.c — `date` and `time` from the wall clock (rtc.h)
+ *
+ * Neither command touches the CMOS: rtc_now() works the time out from
+ * the reading taken at boot (x86) or the build-time epoch (RPi3) and the
+ * nanosecond clock.
+ */
+
+#include "shell.h"
+#include "kprintf.h"
+#include "rtc.h"
+#include <stdint.h>
+
+/* cmd_date() — Display the current date, and where the time comes from
+ * (rtc_source()).  Output format: DD/MM/YYYY */
+static void cmd_date(const shell_args_t *args) {
+    (void)args;
+    rtc_time_t t;
+    rtc_now(&t);
+    kprintf("\n%02u/%02u/%04u  (%s)\n", t.day, t.month, t.year, rtc_source());
+}
+
+SHELL_COMMAND(date, cmd_date, 0, "date", "display current date");
+
+/* cmd_time() — Display the current time.  Output format: HH:MM:SS */
+static void cmd_time(const shell_args_t *args) {
+    (void)args;
+    rtc_time_t t;
+    rtc_now(&t);
+    kprintf("\n%02u:%02u:%02u\n", t.hour, t.min, t.sec);
+}
+
+SHELL_COMMAND(time, cmd_time, 0, "time", "display current time");
@@ -0,0 +1,95 @@
+/*
+ * cmd_screen.c — `cls`, `beep` and `color`
+ *
+ * VGA COLOURS
+ * ------------
+ * The 16 VGA colours are defined by the attribute byte format:
+ *   bits 3-0: foreground (0-15)  bits 6-4: background (0-7)  bit 7: blink
+ *
+ * `color` finds its name the same way the shell finds commands: the
+ * names in color_table[] get their own perfect hash (COLOR_HASH_SEED /
+ * COLOR_HASH_SIZE in the generated shell_hash.h; the Makefile extracts
+ * every `{ "name",` line of the table for tools/mkhash.c).
+ */
+
+#include "shell.h"
+#include "vga.h"
+#include "kprintf.h"
+#include "kstring.h"
+#include "phash.h"
+#include "shell_hash.h"
+#include <stdint.h>
+
+static void cmd_cls(const shell_args_t *args) {
+    (void)args;
+    vga_clear();
+}
+
+SHELL_COMMAND(cls, cmd_cls, 0, "cls", "clear the screen");
+
+/*
+ * cmd_beep() — Flash the screen as a visual bell.
+ *
+ * vga_flash() inverts all cell colours for a short delay, then restores
+ * them — a classic visual alert when an audio beep is unavailable or
+ * unwanted.
+ */
+static void cmd_beep(const shell_args_t *args) {
+    (void)args;
+    vga_flash();
+}
+
+SHELL_COMMAND(beep, cmd_beep, 0, "beep", "visual flash (screen bell)");
+
+/* ── Text colour ─────────────────────────────────────────────────── */
+
+typedef struct { const char *name; uint8_t code; } color_entry_t;
+
+static const color_entry_t color_table[] = {
+    { "black",        0  },
+    { "blue",         1  },
+    { "green",        2  },
+    { "cyan",         3  },
+    { "red",          4  },
+    { "magenta",      5  },
+    { "brown",        6  },
+    { "grey",         7  },
+    { "darkgrey",     8  },
+    { "lightblue",    9  },
+    { "lightgreen",   10 },
+    { "lightcyan",    11 },
+    { "lightred",     12 },
+    { "lightmagenta", 13 },
+    { "yellow",       14 },
+    { "white",        15 },
+};
+
+#define COLOR_COUNT (sizeof(color_table) / sizeof(color_table[0]))
+
+/* color_slot[h] = index + 1 of the colour hashing to h, 0 = none.
+ * Filled on first use. */
+static uint8_t color_slot[COLOR_HASH_SIZE];
+
+static const color_entry_t *color_find(const char *name) {
+    if (!color_slot[phash_slot(COLOR_HASH_SEED, COLOR_HASH_SIZE, color_table[0].name)])
+        for (unsigned i = 0; i < COLOR_COUNT; i++)
+            color_slot[phash_slot(COLOR_HASH_SEED, COLOR_HASH_SIZE, color_table[i].name)] =
+                (uint8_t)(i + 1);
+
+    unsigned i = color_slot[phash_slot(COLOR_HASH_SEED, COLOR_HASH_SIZE, name)];
+    if (i && strcmp(color_table[i - 1].name, name) == 0)
+        return &color_table[i - 1];
+    return 0;
+}
+
+static void cmd_color(const shell_args_t *args) {
+    const color_entry_t *c = color_find(args->str);
+    if (c) {
+        vga_set_color(c->code, 0);
+        return;
+    }
+    kprintf("\nUnknown color name.\n");
+}
+
+SHELL_COMMAND(color, cmd_color, shell_arg_string,
+              "color <name>  (e.g. color white)", "change text foreground color");
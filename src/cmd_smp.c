@@ -0,0 +1,79 @@
+/*
+ * cmd_smp.c — `cores` and `primes`: the SMP job queue (smp.h) at work
+ */
+
+#include "shell.h"
+#include "kprintf.h"
+#include "smp.h"
+#include "timer.h"
+#include <stdint.h>
+
+/* cmd_cores() — Cores online and how many jobs each one has run. */
+static void cmd_cores(const shell_args_t *args) {
+    (void)args;
+    unsigned n = smp_cores_online();
+    kprintf("\n%u %s online\n", n, n == 1 ? "core" : "cores");
+    for (unsigned cpu = 0; cpu < n; cpu++)
+        kprintf("  core %u: %u jobs\n", cpu, smp_jobs_done(cpu));
+}
+
+SHELL_COMMAND(cores, cmd_cores, 0, "cores", "show cores and jobs run per core");
+
+/*
+ * cmd_primes() — Count the primes below N by trial division, split into
+ * PRIME_CHUNKS jobs for the SMP work queue.  Chunks near N cost more
+ * than chunks near 0; work stealing evens that out, as idle cores keep
+ * taking the remaining chunks.
+ */
+#define PRIME_CHUNKS 16
+#define PRIME_LIMIT  10000000u
+
+typedef struct {
+    uint32_t lo, hi;        /* range [lo, hi) */
+    uint32_t count;         /* result         */
+} prime_range_t;
+
+static void count_primes(void *arg) {
+    prime_range_t *r = arg;
+    uint32_t count = 0;
+    for (uint32_t n = r->lo < 2 ? 2 : r->lo; n < r->hi; n++) {
+        int prime = 1;
+        for (uint32_t d = 2; d * d <= n; d++)
+            if (n % d == 0) { prime = 0; break; }
+        count += prime;
+    }
+    r->count = count;
+}
+
+/* parse_limit() — A decimal N no larger than PRIME_LIMIT. */
+static int parse_limit(const char *arg, shell_args_t *out) {
+    return shell_arg_uint(arg, out) && out->num <= PRIME_LIMIT;
+}
+
+static void cmd_primes(const shell_args_t *args) {
+    uint32_t limit = args->num;
+    prime_range_t ranges[PRIME_CHUNKS];
+    smp_job_t     jobs[PRIME_CHUNKS];
+    smp_group_t   group = SMP_GROUP_INIT;
+    uint32_t start = timer_ticks();
+
+    for (int i = 0; i < PRIME_CHUNKS; i++) {
+        ranges[i].lo = (uint32_t)((uint64_t)limit * i / PRIME_CHUNKS);
+        ranges[i].hi = (uint32_t)((uint64_t)limit * (i + 1) / PRIME_CHUNKS);
+        jobs[i].fn   = count_primes;
+        jobs[i].arg  = &ranges[i];
+        smp_run(&group, &jobs[i]);
+    }
+    smp_wait(&group);
+
+    uint32_t total = 0;
+    for (int i = 0; i < PRIME_CHUNKS; i++)
+        total += ranges[i].count;
+
+    unsigned cores = smp_cores_online();
+    kprintf("\n%u primes below %u (%u ms on %u %s)\n", total, limit,
+            timer_ticks() - start, cores, cores == 1 ? "core" : "cores");
+}
+
+SHELL_COMMAND(primes, cmd_primes, parse_limit,
+              "primes <N>  (N up to 10000000)", "count primes below N on all cores");
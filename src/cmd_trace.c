@@ -0,0 +1,82 @@
+/*
+ * cmd_trace.c — `trace`: summary, CSV dump and reset of the trace rings
+ *
+ * The summary goes to the console.  The CSV dump goes to the serial port
+ * only, straight through uart_write(): through the console it would also
+ * be drawn on the VGA screen, and the x86 UART ring drops what does not
+ * fit, so every line waits for uart_sync() before the next.  Tracing is
+ * paused while dumping; otherwise the dump would record itself.
+ *
+ *   cpu,ns,event,arg
+ *   0,1523400112,cmd_start,7
+ *   0,1523401873,vga_put,10
+ */
+
+#include "shell.h"
+#include "kprintf.h"
+#include "kstring.h"
+#include "trace.h"
+#include "uart.h"
+#include "smp.h"
+#include <stdint.h>
+
+static int trace_arg(const char *arg, shell_args_t *out) {
+    out->str = arg;
+    return !arg || strcmp(arg, "csv") == 0 || strcmp(arg, "clear") == 0;
+}
+
+static void summary(void) {
+    uint32_t count[TRACE_EVENTS] = { 0 };
+    uint32_t total = 0, lost = 0;
+    trace_rec_t r;
+
+    trace_pause(1);
+    for (unsigned cpu = 0; cpu < SMP_MAX_CORES; cpu++) {
+        for (uint32_t i = 0; trace_read(cpu, i, &r); i++, total++)
+            if (r.event < TRACE_EVENTS)
+                count[r.event]++;
+        lost += trace_lost(cpu);
+    }
+    trace_pause(0);
+
+    kprintf("\n%u records held, %u overwritten\n\n", total, lost);
+    for (unsigned e = 0; e < TRACE_EVENTS; e++)
+        kprintf("  %-12s%8u\n", trace_event_name(e), count[e]);
+}
+
+static void dump_csv(void) {
+    char line[64];
+    uint32_t total = 0;
+    trace_rec_t r;
+
+    trace_pause(1);
+    uart_write("cpu,ns,event,arg\r\n", 18);
+    for (unsigned cpu = 0; cpu < SMP_MAX_CORES; cpu++)
+        for (uint32_t i = 0; trace_read(cpu, i, &r); i++, total++) {
+            int n = ksnprintf(line, sizeof(line), "%u,%llu,%s,%u\r\n", r.cpu,
+                              (unsigned long long)r.ns, trace_event_name(r.event),
+                              r.arg);
+            uart_write(line, (uint32_t)n);
+            uart_sync();
+        }
+    trace_pause(0);
+    kprintf("\n%u records sent to the serial port.\n", total);
+}
+
+static void cmd_trace(const shell_args_t *args) {
+    if (!trace_enabled()) {
+        kprintf("\nTracing is compiled out: rebuild with make clean; make TRACE=1\n");
+        return;
+    }
+    if (!args->str)
+        summary();
+    else if (strcmp(args->str, "csv") == 0)
+        dump_csv();
+    else {
+        trace_clear();
+        kprintf("\nTrace rings cleared.\n");
+    }
+}
+
+SHELL_COMMAND(trace, cmd_trace, trace_arg, "trace [csv|clear]",
+              "trace point summary, CSV dump to serial");
@@ -0,0 +1,110 @@
+/*
+ * console.c — Console fan-out and the serial sink (both platforms)
+ *
+ * The sinks form a singly linked list and are called in registration
+ * order.  Only core 0 prints, but several tasks may (task.h): a switch
+ * inside sink_write() would interleave two half-buffered lines, or two
+ * uart_write() calls, so writing and flushing hold sched_lock().
+ * Interrupts stay on — uart_write() may wait for the transmitter.
+ *
+ * THE SERIAL SINK
+ * ----------------
+ * A terminal on the other end of a serial line expects "\r\n" at line
+ * ends, and a backspace only moves its cursor: erasing the character
+ * takes "\b \b".  serial_write() translates both and hands every run of
+ * ordinary characters to uart_write() in one call.
+ */
+
+#include "console.h"
+#include "uart.h"
+#include "task.h"
+#include <stdint.h>
+
+#define SERIAL_BUF 256
+
+static console_sink_t *sinks;
+
+void console_register(console_sink_t *sink) {
+    console_sink_t **p = &sinks;
+    sink->len  = 0;
+    sink->next = 0;
+    while (*p) p = &(*p)->next;
+    *p = sink;
+}
+
+/* sink_push() — Hand a LINE sink's buffer to its device. */
+static void sink_push(console_sink_t *s) {
+    if (s->len) {
+        s->write(s->buf, s->len);
+        s->len = 0;
+    }
+}
+
+static void sink_write(console_sink_t *s, const char *buf, uint32_t len) {
+    if (s->policy == CONSOLE_DIRECT) {
+        s->write(buf, len);
+        return;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        s->buf[s->len++] = buf[i];
+        if (buf[i] == '\n' || s->len == s->size)
+            sink_push(s);
+    }
+}
+
+void console_write(const char *buf, uint32_t len) {
+    sched_lock();
+    for (console_sink_t *s = sinks; s; s = s->next)
+        sink_write(s, buf, len);
+    sched_unlock();
+}
+
+void console_putchar(char c) {
+    console_write(&c, 1);
+}
+
+void console_flush(void) {
+    sched_lock();
+    for (console_sink_t *s = sinks; s; s = s->next)
+        if (s->policy == CONSOLE_LINE)
+            sink_push(s);
+    sched_unlock();
+}
+
+void console_sync(void) {
+    console_flush();
+    for (console_sink_t *s = sinks; s; s = s->next)
+        if (s->sync)
+            s->sync();
+}
+
+/* ── Serial sink ──────────────────────────────────────────────────── */
+
+static void serial_write(const char *s, uint32_t len) {
+    const char *end = s + len;
+    while (s < end) {
+        const char *run = s;
+        while (s < end && *s != '\n' && *s != '\b') s++;
+        if (s > run) uart_write(run, (uint32_t)(s - run));
+        if (s < end) {
+            if (*s == '\n') uart_write("\r\n", 2);
+            else            uart_write("\b \b", 3);
+            s++;
+        }
+    }
+}
+
+static char serial_buf[SERIAL_BUF];
+
+static console_sink_t serial_sink = {
+    .name   = "serial",
+    .write  = serial_write,
+    .sync   = uart_sync,
+    .policy = CONSOLE_LINE,
+    .buf    = serial_buf,
+    .size   = SERIAL_BUF,
+};
+
+void console_init(void) {
+    console_register(&serial_sink);
+}
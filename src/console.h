@@ -0,0 +1,69 @@
+/*
+ * console.h — Kernel text output, fanned out to several sinks
+ *
+ * Everything the kernel prints — kprintf(), the shell, the keyboard
+ * echo — goes through console_write().  The console copies it to every
+ * registered SINK: the VGA screen, a serial line, later a framebuffer.
+ *
+ *   kprintf() ─┐                   ┌─► VGA sink    (vga.c)      DIRECT
+ *   echo ──────┼─► console_write() ┼─► serial sink (console.c)  LINE
+ *              │                   └─► …
+ *
+ * PER-SINK BATCHING
+ * ------------------
+ * Each sink has its own flush policy, and LINE sinks their own buffer:
+ *   CONSOLE_DIRECT : every console_write() is passed straight on.  The
+ *                    VGA sink is cheap (RAM copy + one flush) and an
+ *                    interactive screen must show keystrokes at once.
+ *   CONSOLE_LINE   : bytes collect in the sink's buffer and are passed
+ *                    on at each '\n', when the buffer is full, and on
+ *                    console_flush().  Serial drivers pay per call (lock,
+ *                    FIFO kick), so they get whole lines.
+ * The serial driver only queues bytes (uart.h): a slow line never makes
+ * the VGA sink wait, and the screen never delays the serial log.
+ *
+ * console_flush() pushes the partial lines out; the keyboard calls it
+ * before waiting for a key, so that prompts and echo show up everywhere.
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdint.h>
+
+typedef enum {
+    CONSOLE_DIRECT,
+    CONSOLE_LINE,
+} console_policy_t;
+
+typedef struct console_sink {
+    const char       *name;
+    void            (*write)(const char *buf, uint32_t len);
+    void            (*sync)(void);  /* optional: wait until output is out */
+    console_policy_t  policy;
+    char             *buf;          /* CONSOLE_LINE: staging buffer */
+    uint32_t          size, len;
+    struct console_sink *next;
+} console_sink_t;
+
+/* console_init() — Register the built-in serial sink, which writes
+ * through uart.h with "\n" → "\r\n" and "\b" → "\b \b" translation.
+ * Call after uart_init(). */
+void console_init(void);
+
+/* console_register() — Add a sink; output from now on reaches it too. */
+void console_register(console_sink_t *sink);
+
+/* console_write() / console_putchar() — Text to every sink. */
+void console_write(const char *buf, uint32_t len);
+void console_putchar(char c);
+
+/* console_flush() — Pass every LINE sink's partial line on. */
+void console_flush(void);
+
+/* console_sync() — Flush, then wait until each sink's device has
+ * really sent everything (polling: works with interrupts off).  For
+ * last words before the machine halts. */
+void console_sync(void);
+
+#endif
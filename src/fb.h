@@ -0,0 +1,63 @@
+/*
+ * fb.h — HDMI framebuffer text console (RPi3, fb_rpi3.c)
+ *
+ * The serial line carries about 11 KB/s; a screen drawn by the CPU takes
+ * text as fast as memory does.  fb_init() asks the VideoCore firmware
+ * (mbox.h) for a 640 × 480, 32-bit framebuffer and registers it as a
+ * DIRECT console sink next to the serial one: 80 × 30 cells of 8 × 16
+ * pixels, the 8 × 8 glyphs of font.h drawn with every row doubled.
+ *
+ * GLYPH BLIT
+ * -----------
+ * A glyph row is one byte, eight pixels of foreground or background.
+ * For the current colour pair the driver keeps all 256 possible rows
+ * already expanded to 32-bit pixels (8 KB), rebuilt by fb_set_color():
+ * drawing a character is then 16 copies of 32 bytes, with no per-pixel
+ * test.
+ *
+ * SCROLLING BY PANNING
+ * ---------------------
+ * The framebuffer is allocated FB_PAGES screens tall, and the firmware
+ * shows a 480-line window of it starting at the "virtual offset".
+ * Scrolling moves the window down one text row (16 pixel lines) and
+ * clears the row that comes into view: one mailbox call instead of
+ * copying 1.2 MB.  Only when the window reaches the end of the buffer
+ * are its lines copied back to the top — once every
+ * (FB_PAGES - 1) × 30 lines.  A firmware that refuses the tall buffer
+ * gets row scrolling by copying instead.  One console write that scrolls
+ * many lines pans once, at its end.
+ *
+ * CACHES
+ * -------
+ * The framebuffer lies in the GPU's part of the RAM, which the identity
+ * map makes Normal cached memory (mmu_rpi3.c), and the display reads the
+ * RAM directly.  Each call ends by cleaning the lines it changed from the
+ * data cache (DC CVAC) — before it pans, so that a new row is never
+ * shown before it has reached the RAM.
+ */
+
+#ifndef FB_H
+#define FB_H
+
+#include <stdint.h>
+
+#define FB_WIDTH   640
+#define FB_HEIGHT  480
+#define FB_PAGES   3                /* virtual height, in screens */
+#define FB_CELL_W  8
+#define FB_CELL_H  16
+#define FB_COLS    (FB_WIDTH / FB_CELL_W)
+#define FB_ROWS    (FB_HEIGHT / FB_CELL_H)
+
+/* fb_init() — Allocate the framebuffer, clear it, and register it as a
+ * console sink; from then on the UART drops what it cannot send
+ * (uart_set_drop()).  Returns 0, and changes nothing, if the firmware
+ * has no framebuffer to give (no display configured). */
+int fb_init(void);
+
+/* The vga.h display calls, for vga_rpi3.c.  No-ops without fb_init(). */
+void fb_clear(void);
+void fb_set_color(uint8_t fg, uint8_t bg);
+void fb_invert(void);               /* vga_flash(): twice restores */
+
+#endif
@@ -0,0 +1,299 @@
+/*
+ * fb_rpi3.c — Framebuffer console sink (RPi3)
+ *
+ * See fb.h for the glyph table, the panning and the cache cleaning.
+ *
+ * COORDINATES
+ * ------------
+ * `top` is the first line of the virtual buffer on screen; text cell
+ * (col, row) starts at pixel line top + row × FB_CELL_H.  `shown` is
+ * the offset the firmware was last told: flush() pans only when the two
+ * differ.  `lo` / `hi` bound the pixel lines written since the last
+ * flush, in virtual-buffer lines.
+ *
+ * The cursor is an underline in the bottom two pixel lines of its cell,
+ * drawn by XOR: hiding it is drawing it again.  Every entry point hides
+ * it first and shows it again before flushing.
+ */
+
+#include "fb.h"
+#include "font.h"
+#include "mbox.h"
+#include "console.h"
+#include "uart.h"
+#include "kstring.h"
+#include <stdint.h>
+
+#define CACHE_LINE 64
+#define BUS_MASK   0x3FFFFFFFu      /* bus address → ARM physical */
+#define CURSOR_H   2
+
+static uint8_t  *fb;                /* 0: no framebuffer */
+static uint32_t  pitch, virt_h, rgb;
+static uint32_t  top, shown, lo, hi;
+static int       col, row, cursor_on, cursor_col, cursor_row;
+static uint32_t  cursor_xor;
+
+static uint32_t  fg_px, bg_px;
+static uint8_t   cur_fg = 0xFF, cur_bg = 0xFF;
+static uint64_t  expand[256][FB_CELL_W / 2];     /* two pixels a word */
+
+/* The 16 VGA colours, as 0xRRGGBB. */
+static const uint32_t palette[16] = {
+    0x000000, 0x0000AA, 0x00AA00, 0x00AAAA,
+    0xAA0000, 0xAA00AA, 0xAA5500, 0xAAAAAA,
+    0x555555, 0x5555FF, 0x55FF55, 0x55FFFF,
+    0xFF5555, 0xFF55FF, 0xFFFF55, 0xFFFFFF,
+};
+
+/* ── Pixels ───────────────────────────────────────────────────────── */
+
+/* pixel() — 0xRRGGBB in the byte order the firmware settled on: with
+ * "RGB" order red is the first byte in memory, i.e. the low one. */
+static uint32_t pixel(uint32_t rrggbb) {
+    uint32_t r = rrggbb >> 16, g = (rrggbb >> 8) & 0xFF, b = rrggbb & 0xFF;
+    return rgb ? (b << 16 | g << 8 | r) : (r << 16 | g << 8 | b);
+}
+
+static uint8_t *line(uint32_t y) {
+    return fb + y * pitch;
+}
+
+static void dirty(uint32_t y0, uint32_t y1) {
+    if (y0 < lo) lo = y0;
+    if (y1 > hi) hi = y1;
+}
+
+/* fill() — Pixel lines [y0, y1) of the virtual buffer in colour px. */
+static void fill(uint32_t y0, uint32_t y1, uint32_t px) {
+    for (uint32_t y = y0; y < y1; y++) {
+        uint32_t *p = (uint32_t *)line(y);
+        for (int x = 0; x < FB_WIDTH; x++)
+            p[x] = px;
+    }
+    dirty(y0, y1);
+}
+
+/* xor_lines() — XOR pixels [x0, x1) of lines [y0, y1) with v. */
+static void xor_lines(uint32_t y0, uint32_t y1, int x0, int x1, uint32_t v) {
+    for (uint32_t y = y0; y < y1; y++) {
+        uint32_t *p = (uint32_t *)line(y);
+        for (int x = x0; x < x1; x++)
+            p[x] ^= v;
+    }
+    dirty(y0, y1);
+}
+
+/* build_expand() — Every glyph row pattern in the current colours.  The
+ * left pixel of each pair is at the lower address: the low word. */
+static void build_expand(void) {
+    for (int bits = 0; bits < 256; bits++)
+        for (int x = 0; x < FB_CELL_W; x += 2) {
+            uint64_t l = (bits & (0x80 >> x)) ? fg_px : bg_px;
+            uint64_t r = (bits & (0x40 >> x)) ? fg_px : bg_px;
+            expand[bits][x / 2] = l | r << 32;
+        }
+}
+
+/* draw() — Character c in cell (col, row): one 32-byte copy from the
+ * expanded table per pixel line. */
+static void draw(int c_col, int c_row, char c) {
+    const uint8_t *g = font_glyph(c);
+    uint32_t y = top + (uint32_t)c_row * FB_CELL_H;
+    uint8_t *p = line(y) + c_col * FB_CELL_W * 4;
+
+    for (int r = 0; r < FONT_HEIGHT; r++) {
+        const uint64_t *src = expand[g[r]];
+        for (int k = 0; k < FB_CELL_H / FONT_HEIGHT; k++, p += pitch) {
+            uint64_t *dst = (uint64_t *)p;
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst[3] = src[3];
+        }
+    }
+    dirty(y, y + FB_CELL_H);
+}
+
+/* ── Cursor, scrolling, flushing ──────────────────────────────────── */
+
+static void cursor_toggle(void) {
+    uint32_t y = top + (uint32_t)(cursor_row + 1) * FB_CELL_H;
+    xor_lines(y - CURSOR_H, y, cursor_col * FB_CELL_W,
+              (cursor_col + 1) * FB_CELL_W, cursor_xor);
+}
+
+static void cursor_hide(void) {
+    if (cursor_on)
+        cursor_toggle();
+    cursor_on = 0;
+}
+
+static void cursor_show(void) {
+    cursor_col = col;
+    cursor_row = row;
+    cursor_xor = fg_px ^ bg_px;
+    cursor_toggle();
+    cursor_on = 1;
+}
+
+/* scroll() — One text row up: move the window down, or copy it back to
+ * the top of the buffer when it would run past the end. */
+static void scroll(void) {
+    if (top + FB_HEIGHT + FB_CELL_H <= virt_h) {
+        top += FB_CELL_H;
+    } else {
+        memmove(line(0), line(top + FB_CELL_H),
+                (FB_HEIGHT - FB_CELL_H) * pitch);
+        top = 0;
+        dirty(0, FB_HEIGHT - FB_CELL_H);
+    }
+    fill(top + FB_HEIGHT - FB_CELL_H, top + FB_HEIGHT, bg_px);
+    row = FB_ROWS - 1;
+}
+
+/* pan() — Tell the firmware which line of the buffer is at the top. */
+static void pan(uint32_t y) {
+    static volatile uint32_t msg[16] __attribute__((aligned(64)));
+
+    msg[0] = 8 * sizeof(uint32_t);
+    msg[1] = MBOX_REQUEST;
+    msg[2] = MBOX_TAG_FB_OFFSET;
+    msg[3] = 8;
+    msg[4] = 0;
+    msg[5] = 0;                     /* x */
+    msg[6] = y;
+    msg[7] = MBOX_TAG_END;
+    mbox_property(msg);
+}
+
+/* flush() — Clean the changed lines to RAM, then pan if needed. */
+static void flush(void) {
+    if (hi > lo) {
+        uintptr_t a   = (uintptr_t)line(lo) & ~(uintptr_t)(CACHE_LINE - 1);
+        uintptr_t end = (uintptr_t)line(hi);
+        for (; a < end; a += CACHE_LINE)
+            __asm__ volatile ("dc cvac, %0" : : "r"(a) : "memory");
+        __asm__ volatile ("dsb sy" ::: "memory");
+    }
+    lo = UINT32_MAX;
+    hi = 0;
+    if (top != shown) {
+        pan(top);
+        shown = top;
+    }
+}
+
+/* ── The console sink ─────────────────────────────────────────────── */
+
+static void put(char c) {
+    if (c == '\n') {
+        col = 0;
+        row++;
+    } else if (c == '\r') {
+        col = 0;
+    } else if (c == '\b') {
+        if (col > 0)
+            draw(--col, row, ' ');
+    } else {
+        draw(col, row, c);
+        if (++col >= FB_COLS) {
+            col = 0;
+            row++;
+        }
+    }
+    if (row >= FB_ROWS)
+        scroll();
+}
+
+static void fb_write(const char *buf, uint32_t len) {
+    cursor_hide();
+    for (uint32_t i = 0; i < len; i++)
+        put(buf[i]);
+    cursor_show();
+    flush();
+}
+
+static console_sink_t fb_sink = {
+    .name   = "fb",
+    .write  = fb_write,
+    .policy = CONSOLE_DIRECT,
+};
+
+/* ── vga.h calls ──────────────────────────────────────────────────── */
+
+void fb_clear(void) {
+    if (!fb)
+        return;
+    cursor_on = 0;                  /* erased with everything else */
+    fill(top, top + FB_HEIGHT, bg_px);
+    col = row = 0;
+    cursor_show();
+    flush();
+}
+
+void fb_set_color(uint8_t fg_c, uint8_t bg_c) {
+    if (fg_c > 15 || bg_c > 15 || (fg_c == cur_fg && bg_c == cur_bg))
+        return;
+    cur_fg = fg_c;
+    cur_bg = bg_c;
+    fg_px  = pixel(palette[fg_c]);
+    bg_px  = pixel(palette[bg_c]);
+    build_expand();
+    if (fb) {
+        cursor_hide();
+        cursor_show();
+        flush();
+    }
+}
+
+void fb_invert(void) {
+    if (!fb)
+        return;
+    xor_lines(top, top + FB_HEIGHT, 0, FB_WIDTH, pixel(0xFFFFFF));
+    flush();
+}
+
+int fb_init(void) {
+    /* A whole number of cache lines of its own: see mbox.h. */
+    static volatile uint32_t msg[48] __attribute__((aligned(64)));
+
+    msg[0]  = 35 * sizeof(uint32_t);
+    msg[1]  = MBOX_REQUEST;
+    msg[2]  = MBOX_TAG_FB_PHYS_WH;  msg[3]  = 8; msg[4]  = 0;
+    msg[5]  = FB_WIDTH;             msg[6]  = FB_HEIGHT;
+    msg[7]  = MBOX_TAG_FB_VIRT_WH;  msg[8]  = 8; msg[9]  = 0;
+    msg[10] = FB_WIDTH;             msg[11] = FB_HEIGHT * FB_PAGES;
+    msg[12] = MBOX_TAG_FB_OFFSET;   msg[13] = 8; msg[14] = 0;
+    msg[15] = 0;                    msg[16] = 0;
+    msg[17] = MBOX_TAG_FB_DEPTH;    msg[18] = 4; msg[19] = 0;
+    msg[20] = 32;
+    msg[21] = MBOX_TAG_FB_ORDER;    msg[22] = 4; msg[23] = 0;
+    msg[24] = 1;                    /* RGB */
+    msg[25] = MBOX_TAG_FB_ALLOC;    msg[26] = 8; msg[27] = 0;
+    msg[28] = 4096;                 msg[29] = 0;    /* ← address, size */
+    msg[30] = MBOX_TAG_FB_PITCH;    msg[31] = 4; msg[32] = 0;
+    msg[33] = 0;                    /* ← pitch */
+    msg[34] = MBOX_TAG_END;
+
+    if (!mbox_property(msg) || msg[20] != 32 || !msg[28] ||
+        msg[5] != FB_WIDTH || msg[6] != FB_HEIGHT || msg[33] < FB_WIDTH * 4)
+        return 0;
+
+    pitch  = msg[33];
+    virt_h = msg[11] >= FB_HEIGHT ? msg[11] : FB_HEIGHT;
+    if (virt_h > msg[29] / pitch)   /* more lines than memory for them */
+        virt_h = msg[29] / pitch >= FB_HEIGHT ? msg[29] / pitch : FB_HEIGHT;
+    rgb    = msg[24];
+    fb     = (uint8_t *)(uintptr_t)(msg[28] & BUS_MASK);
+    top    = shown = 0;
+    lo     = UINT32_MAX;
+    hi     = 0;
+
+    cur_fg = cur_bg = 0xFF;         /* force the table for this order */
+    fb_set_color(7, 0);
+    fb_clear();
+    console_register(&fb_sink);
+    uart_set_drop(1);
+    return 1;
+}
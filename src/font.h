@@ -0,0 +1,33 @@
+/*
+ * font.h — 8×8 bitmap font for printable ASCII (font.c)
+ *
+ * One byte per pixel row, top row first; bit 7 is the leftmost pixel.
+ * The glyphs are 5 × 7 pixels, drawn in columns 1–5 of the cell, with
+ * the descenders of g, j, p, q and y in row 7: the leftover columns and
+ * row space the characters apart, so that no glyph touches the next.
+ *
+ * Only ' ' (32) to '~' (126) are present: font_glyph() gives the glyph
+ * to draw for any byte, a box for the ones the font lacks.
+ */
+
+#ifndef FONT_H
+#define FONT_H
+
+#include <stdint.h>
+
+#define FONT_WIDTH  8
+#define FONT_HEIGHT 8
+#define FONT_FIRST  ' '
+#define FONT_LAST   '~'
+
+extern const uint8_t font_8x8[FONT_LAST - FONT_FIRST + 2][FONT_HEIGHT];
+
+/* font_glyph() — Rows of the glyph for c. */
+static inline const uint8_t *font_glyph(char c) {
+    uint8_t u = (uint8_t)c;
+    if (u < FONT_FIRST || u > FONT_LAST)
+        return font_8x8[FONT_LAST - FONT_FIRST + 1];
+    return font_8x8[u - FONT_FIRST];
+}
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * fpu.c — x87 / SSE enabling and lazy FPU switching (x86)
+ *
+ * CONTROL REGISTER BITS
+ * ----------------------
+ *   CR0.MP (bit 1)  "monitor coprocessor": WAIT/FWAIT also honour TS
+ *   CR0.EM (bit 2)  "emulation": x87 instructions raise #NM — cleared
+ *   CR0.TS (bit 3)  "task switched": the next x87/SSE instruction raises
+ *                   #NM (vector 7), the hook for lazy switching
+ *   CR0.NE (bit 5)  report x87 errors as exception 16, not via the PIC
+ *   CR4.OSFXSR    (bit 9)  the OS saves state with FXSAVE: SSE allowed
+ *   CR4.OSXMMEXCPT(bit 10) the OS handles SIMD exceptions (#XM, vector 19)
+ *
+ * CLTS clears TS without touching the rest of CR0.
+ *
+ * SAVING THE STATE
+ * -----------------
+ * FXSAVE / FXRSTOR move the whole x87 + SSE state (512 bytes, 16-byte
+ * aligned) in one instruction.  CPUs older than the Pentium II lack them
+ * (CPUID.1 EDX bit 24) and only have the x87: FNSAVE / FRSTOR, 108 bytes.
+ * MXCSR, the SSE control register, starts at 0x1F80: all SIMD exceptions
+ * masked, round to nearest.
+ */
+
+#include "fpu.h"
+#include "kstring.h"
+#include <stdint.h>
+
+#define CR0_MP          (1u << 1)
+#define CR0_EM          (1u << 2)
+#define CR0_TS          (1u << 3)
+#define CR0_NE          (1u << 5)
+#define CR4_OSFXSR      (1u << 9)
+#define CR4_OSXMMEXCPT  (1u << 10)
+
+#define CPUID_FPU       (1u << 0)
+#define CPUID_FXSR      (1u << 24)
+#define CPUID_SSE       (1u << 25)
+#define CPUID_SSE2      (1u << 26)
+
+#define MXCSR_DEFAULT   0x1F80
+
+static fpu_state_t  boot_state;     /* kernel_main() and the shell */
+static fpu_state_t  clean;          /* right after initialisation  */
+static fpu_state_t *owner;          /* whose values are in the registers */
+static fpu_state_t *current;        /* whose values should be          */
+static int          have_fxsr, have_sse2;
+static uint32_t     traps;
+
+static uint32_t read_cr0(void) {
+    uint32_t v;
+    __asm__ volatile ("mov %%cr0, %0" : "=r"(v));
+    return v;
+}
+
+static void write_cr0(uint32_t v) {
+    __asm__ volatile ("mov %0, %%cr0" : : "r"(v) : "memory");
+}
+
+static void save(fpu_state_t *s) {
+    if (have_fxsr)
+        __asm__ volatile ("fxsave %0" : "=m"(*s));
+    else
+        __asm__ volatile ("fnsave %0; fwait" : "=m"(*s));
+}
+
+static void restore(const fpu_state_t *s) {
+    if (have_fxsr)
+        __asm__ volatile ("fxrstor %0" : : "m"(*s));
+    else
+        __asm__ volatile ("frstor %0" : : "m"(*s));
+}
+
+void fpu_init(void) {
+    uint32_t eax, ebx, ecx, edx;
+    __asm__ volatile ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(1));
+    if (!(edx & CPUID_FPU))
+        return;                     /* no x87 at all: leave EM set */
+
+    write_cr0((read_cr0() & ~(CR0_EM | CR0_TS)) | CR0_MP | CR0_NE);
+    __asm__ volatile ("fninit");
+
+    have_fxsr = (edx & CPUID_FXSR) != 0;
+    if (have_fxsr && (edx & CPUID_SSE)) {
+        uint32_t cr4, mxcsr = MXCSR_DEFAULT;
+        __asm__ volatile ("mov %%cr4, %0" : "=r"(cr4));
+        __asm__ volatile ("mov %0, %%cr4" : : "r"(cr4 | CR4_OSFXSR | CR4_OSXMMEXCPT));
+        __asm__ volatile ("ldmxcsr %0" : : "m"(mxcsr));
+        have_sse2 = (edx & CPUID_SSE2) != 0;
+    }
+
+    save(&clean);
+    if (!have_fxsr)
+        restore(&clean);            /* FNSAVE re-initialised the FPU */
+    owner = current = &boot_state;
+}
+
+int fpu_simd(void) {
+    return have_sse2;
+}
+
+void fpu_state_init(fpu_state_t *s) {
+    memcpy(s, &clean, sizeof(*s));
+}
+
+void fpu_switch(fpu_state_t *next) {
+    if (!current)
+        return;                     /* no FPU */
+    current = next;
+    if (next == owner)
+        __asm__ volatile ("clts");
+    else
+        write_cr0(read_cr0() | CR0_TS);
+}
+
+fpu_state_t *fpu_current(void) {
+    return current;
+}
+
+void fpu_release(fpu_state_t *s) {
+    if (owner == s)
+        owner = 0;
+}
+
+int fpu_trap(void) {
+    if (!current)
+        return 0;                   /* EM set: there really is no FPU */
+
+    __asm__ volatile ("clts");
+    if (owner != current) {
+        if (owner)
+            save(owner);
+        restore(current);
+        owner = current;
+    }
+    traps++;
+    return 1;
+}
+
+uint32_t fpu_traps(void) {
+    return traps;
+}
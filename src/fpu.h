@@ -0,0 +1,95 @@
+/*
+ * fpu.h — Floating point / SIMD unit: enabling and lazy context switch
+ *
+ * OFF AT RESET
+ * -------------
+ * Both CPUs come out of reset with their FP/SIMD unit unusable, so that
+ * an operating system that does not save those registers on a context
+ * switch cannot corrupt them by accident:
+ *   x86    CR0.EM set (x87 instructions raise #NM, "device not
+ *          available") and CR4.OSFXSR clear (SSE instructions raise #UD).
+ *   AArch64 CPACR_EL1.FPEN = 0b00: every FP/NEON instruction traps.
+ * fpu_init() (x86, fpu.c) and the boot stub (AArch64, boot_rpi3.S, before
+ * kstring_init() looks at FPEN) turn them on.
+ *
+ * LAZY SWITCHING
+ * ---------------
+ * The FP/SIMD registers are big (x86 FXSAVE area: 512 bytes; AArch64
+ * Q0–Q31: 512 bytes) and most tasks never touch them.  Instead of saving
+ * and loading them on every switch, fpu_switch() only DISABLES the unit
+ * again (x86: CR0.TS, "task switched"; AArch64: FPEN = 0b00).  The first
+ * FP/SIMD instruction of the next task traps, and only then does
+ * fpu_trap() save the registers of their previous OWNER and load the
+ * current task's.  A task that never uses FP/SIMD costs nothing:
+ *
+ *   fpu_switch(B)   unit off, registers still hold A's state (owner A)
+ *   B: addps ...    trap → save A, load B, unit on, retry (owner B)
+ *   fpu_switch(A)   unit off
+ *   fpu_switch(B)   owner is B already: unit stays on, no trap at all
+ *
+ * The state of whatever runs before the first fpu_switch() — kernel_main()
+ * and the shell — is kept in a built-in fpu_state_t; task_init() adopts
+ * it for task 0 through fpu_current().
+ *
+ * RULES
+ * ------
+ *   - Interrupt handlers must not use FP/SIMD: the registers they would
+ *     clobber belong to the interrupted task and are not saved on
+ *     interrupt entry.  The compiler generates no FP/SIMD code (x86:
+ *     no SSE code generation; AArch64: -mgeneral-regs-only).  The SIMD
+ *     paths of memcpy() / memset(), which opt back in with a target
+ *     attribute, are only taken while interrupts are enabled (x86
+ *     EFLAGS.IF, AArch64 DAIF.I), which no handler is; vga_flash()'s
+ *     SSE2 loop is a shell command's.  On RPi3 an FP trap taken with
+ *     IRQs masked is reported as a fault, not switched.
+ *   - Lazy switching is for core 0.  On RPi3 cores 1–3 simply keep
+ *     FP/SIMD enabled for their jobs.
+ */
+
+#ifndef FPU_H
+#define FPU_H
+
+#include <stdint.h>
+
+/* Saved FP/SIMD registers of one task. */
+typedef struct {
+#ifndef PLATFORM_RPI3
+    uint8_t  area[512];             /* FXSAVE image (or FNSAVE, 108 bytes) */
+#else
+    uint64_t q[64];                 /* Q0–Q31, 128 bits each */
+    uint64_t fpcr, fpsr;            /* control / status      */
+#endif
+} __attribute__((aligned(16))) fpu_state_t;
+
+/* fpu_init() — Enable the unit and record its clean state.  Call first
+ * in kernel_main(), before kstring_init() looks at what is enabled. */
+void fpu_init(void);
+
+/* fpu_simd() — 1 if SSE2 (x86) / NEON (AArch64) is usable. */
+int fpu_simd(void);
+
+/* fpu_state_init() — Give a new task a clean state (all registers zero,
+ * default rounding, exceptions masked). */
+void fpu_state_init(fpu_state_t *s);
+
+/* fpu_switch() — About to run the task whose registers live in `next`.
+ * Disables the unit unless `next` already owns it. */
+void fpu_switch(fpu_state_t *next);
+
+/* fpu_current() — The state fpu_switch() last selected (the built-in
+ * one until the first switch; 0 without an FPU). */
+fpu_state_t *fpu_current(void);
+
+/* fpu_release() — `s` is going away (task exit): never save into it. */
+void fpu_release(fpu_state_t *s);
+
+/* fpu_trap() — Called by the exception dispatcher for the "FP/SIMD
+ * disabled" trap (x86 #NM, vector 7; AArch64 ESR class 0x07).  Returns 1
+ * if the trap was a lazy switch and the instruction can be retried, 0 if
+ * it is a genuine fault. */
+int fpu_trap(void);
+
+/* fpu_traps() — Number of lazy switches performed so far. */
+uint32_t fpu_traps(void);
+
+#endif
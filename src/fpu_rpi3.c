@@ -0,0 +1,150 @@
+/*
+ * fpu_rpi3.c — FP/NEON state and lazy switching (RPi3 / AArch64)
+ *
+ * CPACR_EL1.FPEN
+ * ---------------
+ * Bits [21:20] of CPACR_EL1 decide which exception levels may execute
+ * FP/SIMD instructions:
+ *   0b00  trap at EL0 and EL1     0b01  trap at EL0 only
+ *   0b11  no trapping
+ * boot_rpi3.S sets 0b11 on every core before the first C call.  Here
+ * fpu_switch() drops core 0 back to 0b00; the trapped instruction arrives
+ * as a synchronous exception with ESR_EL1 class 0x07, and after
+ * fpu_trap() the ERET re-executes it.
+ *
+ * Only task code may trap: an FP/SIMD instruction in an interrupt
+ * handler would load the interrupted task's registers and then clobber
+ * them.  The kernel is compiled with -mgeneral-regs-only and kstring's
+ * NEON paths need IRQs unmasked (kstring_rpi3.c), so a trap taken with
+ * IRQs masked — SPSR_EL1.I set — is a bug, and fpu_trap() reports it as
+ * a fault.  save() and restore() are the two functions here built with
+ * "+simd".
+ *
+ * THE STATE
+ * ----------
+ * 32 registers of 128 bits (Q0–Q31, the same storage as the D/S views
+ * and the NEON V registers) plus FPCR (rounding mode, trap enables) and
+ * FPSR (cumulative exception flags).  FPCR = 0 is round to nearest with
+ * every floating point exception untrapped.
+ */
+
+#include "fpu.h"
+#include "kstring.h"
+#include <stdint.h>
+
+#define FPEN_MASK   (3ull << 20)
+#define SPSR_I      (1ull << 7)
+
+static fpu_state_t  boot_state;
+static fpu_state_t  clean;
+static fpu_state_t *owner;
+static fpu_state_t *current;
+static int          have_neon;
+static uint32_t     traps;
+
+static void fpen(uint64_t bits) {
+    uint64_t cpacr;
+    __asm__ volatile ("mrs %0, cpacr_el1" : "=r"(cpacr));
+    cpacr = (cpacr & ~FPEN_MASK) | bits;
+    __asm__ volatile ("msr cpacr_el1, %0; isb" : : "r"(cpacr) : "memory");
+}
+
+__attribute__((target("+simd")))
+static void save(fpu_state_t *s) {
+    __asm__ volatile (
+        "stp q0,  q1,  [%0, #16 * 0]\n"
+        "stp q2,  q3,  [%0, #16 * 2]\n"
+        "stp q4,  q5,  [%0, #16 * 4]\n"
+        "stp q6,  q7,  [%0, #16 * 6]\n"
+        "stp q8,  q9,  [%0, #16 * 8]\n"
+        "stp q10, q11, [%0, #16 * 10]\n"
+        "stp q12, q13, [%0, #16 * 12]\n"
+        "stp q14, q15, [%0, #16 * 14]\n"
+        "stp q16, q17, [%0, #16 * 16]\n"
+        "stp q18, q19, [%0, #16 * 18]\n"
+        "stp q20, q21, [%0, #16 * 20]\n"
+        "stp q22, q23, [%0, #16 * 22]\n"
+        "stp q24, q25, [%0, #16 * 24]\n"
+        "stp q26, q27, [%0, #16 * 26]\n"
+        "stp q28, q29, [%0, #16 * 28]\n"
+        "stp q30, q31, [%0, #16 * 30]\n"
+        : : "r"(s->q) : "memory");
+    __asm__ volatile ("mrs %0, fpcr" : "=r"(s->fpcr));
+    __asm__ volatile ("mrs %0, fpsr" : "=r"(s->fpsr));
+}
+
+__attribute__((target("+simd")))
+static void restore(const fpu_state_t *s) {
+    __asm__ volatile (
+        "ldp q0,  q1,  [%0, #16 * 0]\n"
+        "ldp q2,  q3,  [%0, #16 * 2]\n"
+        "ldp q4,  q5,  [%0, #16 * 4]\n"
+        "ldp q6,  q7,  [%0, #16 * 6]\n"
+        "ldp q8,  q9,  [%0, #16 * 8]\n"
+        "ldp q10, q11, [%0, #16 * 10]\n"
+        "ldp q12, q13, [%0, #16 * 12]\n"
+        "ldp q14, q15, [%0, #16 * 14]\n"
+        "ldp q16, q17, [%0, #16 * 16]\n"
+        "ldp q18, q19, [%0, #16 * 18]\n"
+        "ldp q20, q21, [%0, #16 * 20]\n"
+        "ldp q22, q23, [%0, #16 * 22]\n"
+        "ldp q24, q25, [%0, #16 * 24]\n"
+        "ldp q26, q27, [%0, #16 * 26]\n"
+        "ldp q28, q29, [%0, #16 * 28]\n"
+        "ldp q30, q31, [%0, #16 * 30]\n"
+        : : "r"(s->q) : "memory");
+    __asm__ volatile ("msr fpcr, %0" : : "r"(s->fpcr));
+    __asm__ volatile ("msr fpsr, %0" : : "r"(s->fpsr));
+}
+
+void fpu_init(void) {
+    uint64_t pfr0;
+    __asm__ volatile ("mrs %0, id_aa64pfr0_el1" : "=r"(pfr0));
+    have_neon = ((pfr0 >> 20) & 0xF) != 0xF;    /* AdvSIMD field */
+
+    /* clean: all zero, FPCR = FPSR = 0 (static storage is zeroed). */
+    owner = current = &boot_state;
+}
+
+int fpu_simd(void) {
+    return have_neon;
+}
+
+void fpu_state_init(fpu_state_t *s) {
+    memcpy(s, &clean, sizeof(*s));
+}
+
+void fpu_switch(fpu_state_t *next) {
+    current = next;
+    fpen(next == owner ? FPEN_MASK : 0);
+}
+
+fpu_state_t *fpu_current(void) {
+    return current;
+}
+
+void fpu_release(fpu_state_t *s) {
+    if (owner == s)
+        owner = 0;
+}
+
+int fpu_trap(void) {
+    uint64_t spsr;
+    __asm__ volatile ("mrs %0, spsr_el1" : "=r"(spsr));
+    if (!current || (spsr & SPSR_I))
+        return 0;
+
+    fpen(FPEN_MASK);
+    if (owner != current) {
+        if (owner)
+            save(owner);
+        restore(current);
+        owner = current;
+    }
+    traps++;
+    return 1;
+}
+
+uint32_t fpu_traps(void) {
+    return traps;
+}
@@ -0,0 +1,116 @@
+/*
+ * initrd.c — The initial RAM disk's tar archive, read in place (both platforms)
+ *
+ * See initrd.h for the format and for where the archive comes from.
+ *
+ * initrd_init() walks the headers once and remembers `length`, the end
+ * of the last entry that checked out; from then on the walks of
+ * initrd_next() stop there and can trust every header before it.  A
+ * lookup is a walk from the first header: a few dozen files, each one
+ * header read.
+ */
+
+#include "initrd.h"
+#include "kstring.h"
+#include <stdint.h>
+
+#define BLOCK     512
+#define OFF_SIZE  124
+#define OFF_SUM   148
+#define OFF_TYPE  156
+#define OFF_MAGIC 257
+#define NAME_MAX  100
+
+static const uint8_t *archive;
+static uint32_t       length;       /* bytes up to the last good entry */
+static uint32_t       files;
+
+/* octal() — An octal ASCII field: leading spaces, digits, then a space
+ * or NUL. */
+static uint32_t octal(const uint8_t *p, int n) {
+    uint32_t v = 0;
+    int i = 0;
+    while (i < n && p[i] == ' ')
+        i++;
+    for (; i < n && p[i] >= '0' && p[i] <= '7'; i++)
+        v = v * 8 + (uint32_t)(p[i] - '0');
+    return v;
+}
+
+/* span() — Header plus data, rounded up to whole blocks. */
+static uint32_t span(uint32_t size) {
+    return BLOCK + (size + BLOCK - 1) / BLOCK * BLOCK;
+}
+
+/* valid() — Is there a sound header at h, with its data within the
+ * left bytes?  A zeroed block (the end marker) is not. */
+static int valid(const uint8_t *h, uint32_t left) {
+    if (left < BLOCK || h[0] == '\0' || memcmp(h + OFF_MAGIC, "ustar", 5))
+        return 0;
+
+    uint32_t sum = 0;
+    for (int i = 0; i < BLOCK; i++)
+        sum += (i >= OFF_SUM && i < OFF_SUM + 8) ? ' ' : h[i];
+    if (sum != octal(h + OFF_SUM, 8))
+        return 0;
+    return octal(h + OFF_SIZE, 12) <= left - BLOCK;
+}
+
+/* file_name() — The name of a regular file's entry, NULL for anything
+ * else (directories, links, names that fill the whole field). */
+static const char *file_name(const uint8_t *h) {
+    const char *name = (const char *)h;
+    if ((h[OFF_TYPE] != '0' && h[OFF_TYPE] != '\0') || h[NAME_MAX - 1] != '\0')
+        return 0;
+    if (name[0] == '.' && name[1] == '/')
+        name += 2;
+    return *name ? name : 0;
+}
+
+uint32_t initrd_init(const void *base, uint32_t size) {
+    archive = base;
+    length  = 0;
+    files   = 0;
+    while (archive && valid(archive + length, size - length)) {
+        const uint8_t *h = archive + length;
+        uint32_t next = span(octal(h + OFF_SIZE, 12));
+        if (file_name(h))
+            files++;
+        /* The last file's padding may be cut off. */
+        length += next < size - length ? next : size - length;
+    }
+    return files;
+}
+
+int initrd_next(initrd_file_t *f) {
+    uint32_t at = f->hdr ? (uint32_t)(f->hdr - archive) + span(f->size) : 0;
+
+    for (; at < length; at += span(octal(archive + at + OFF_SIZE, 12))) {
+        const uint8_t *h    = archive + at;
+        const char    *name = file_name(h);
+        if (name) {
+            f->name = name;
+            f->size = octal(h + OFF_SIZE, 12);
+            f->data = (const char *)h + BLOCK;
+            f->hdr  = h;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int initrd_open(const char *name, initrd_file_t *f) {
+    f->hdr = 0;
+    while (initrd_next(f))
+        if (strcmp(f->name, name) == 0)
+            return 1;
+    return 0;
+}
+
+uint32_t initrd_size(void) {
+    return length;
+}
+
+uint32_t initrd_count(void) {
+    return files;
+}
@@ -0,0 +1,66 @@
+/*
+ * initrd.h — Read-only initial RAM disk: a tar archive read in place (initrd.c)
+ *
+ * Typing a batch of commands on the serial line costs a keyboard
+ * interrupt, an echo and a console write per character.  The boot loader
+ * can instead hand the kernel a file in memory, and the shell runs the
+ * scripts in it (`run`, shell_script()):
+ *
+ *   x86 : the first Multiboot module (QEMU -initrd).  The loader puts it
+ *         in RAM above the kernel and lists it in the information
+ *         structure; memmap_detect() keeps those pages away from the
+ *         page allocator.
+ *   RPi3: the firmware loads no modules.  The archive is linked into the
+ *         kernel image instead (initrd_rpi3.S, `.incbin`).
+ *
+ * The Makefile builds the archive from the initrd/ directory; INITRD=
+ * names another, INITRD= with no value boots without one.
+ *
+ * USTAR IN PLACE
+ * ---------------
+ * A tar archive is a sequence of 512-byte headers, each followed by its
+ * file's data rounded up to 512 bytes, and ends with a zeroed block:
+ *
+ *   offset  size  field
+ *     0     100   name, NUL-terminated unless it is 100 characters long
+ *   124      12   size, octal ASCII
+ *   148       8   checksum: the sum of the header bytes, octal ASCII,
+ *                 counting the checksum field itself as eight spaces
+ *   156       1   type: '0' (or NUL) regular file, '5' directory, ...
+ *   257       6   "ustar" magic
+ *
+ * Nothing is copied or unpacked: an initrd_file_t points at the name in
+ * the header and at the data after it, inside the archive.  The data is
+ * not NUL-terminated — use the size.  Only regular files with names of
+ * at most 99 characters are listed; a leading "./" is skipped.
+ */
+
+#ifndef INITRD_H
+#define INITRD_H
+
+#include <stdint.h>
+
+typedef struct {
+    const char    *name;
+    const char    *data;            /* size bytes, not NUL-terminated */
+    uint32_t       size;
+    const uint8_t *hdr;             /* initrd_next(): this entry's header */
+} initrd_file_t;
+
+/* initrd_init() — Take the archive of size bytes at base.  Entries are
+ * checked here, once: the first bad checksum or truncated file ends the
+ * archive.  Returns the number of files. */
+uint32_t initrd_init(const void *base, uint32_t size);
+
+/* initrd_next() — The file after *f, or the first one if f->hdr is NULL.
+ * Returns 0 after the last. */
+int initrd_next(initrd_file_t *f);
+
+/* initrd_open() — Find a file by name.  Returns 0 if there is none. */
+int initrd_open(const char *name, initrd_file_t *f);
+
+/* initrd_size() / initrd_count() — Archive bytes and files, 0 if none. */
+uint32_t initrd_size(void);
+uint32_t initrd_count(void);
+
+#endif
@@ -14,6 +14,10 @@
  * NOTE: This header is NOT included on Raspberry Pi (PLATFORM_RPI3).
  * ARM uses memory-mapped I/O exclusively — all peripherals are
  * reached via normal pointer dereferences to physical addresses.
+ *
+ * The host build (make PLATFORM=host, PLATFORM_HOST) has no ports to
+ * talk to: inb() and outb() are functions of tools/host_mock.c there,
+ * which records every access and answers reads from a table.
  */
 
 #ifndef IO_H
@@ -21,6 +25,8 @@
 
 #include <stdint.h>
 
+#ifndef PLATFORM_HOST
+
 /*
  * inb() — Read one byte from an I/O port.
  *
@@ -47,6 +53,13 @@ static inline void outb(uint16_t port, uint8_t val) {
     __asm__ volatile ("outb %0, %1" : : "a"(val), "Nd"(port));
 }
 
+#else
+
+uint8_t inb(uint16_t port);
+void    outb(uint16_t port, uint8_t val);
+
+#endif
+
 /*
  * io_wait() — Insert a small delay after an I/O write.
  *
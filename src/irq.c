@@ -0,0 +1,221 @@
+/*
+ * irq.c — IDT and 8259 PIC setup, interrupt dispatch (x86)
+ *
+ * THE INTERRUPT DESCRIPTOR TABLE (IDT)
+ * -------------------------------------
+ * In protected mode the CPU finds interrupt handlers through the IDT, an
+ * array of up to 256 8-byte "gate descriptors".  Entry n describes the
+ * handler for vector n:
+ *
+ *   bits  0–15 : handler offset, low 16 bits
+ *   bits 16–31 : code segment selector to load into CS
+ *   bits 32–39 : reserved (0)
+ *   bits 40–47 : type/attributes — 0x8E = present, ring 0, 32-bit
+ *                interrupt gate (the CPU clears IF on entry)
+ *   bits 48–63 : handler offset, high 16 bits
+ *
+ * The LIDT instruction loads the table's base and limit into the IDTR.
+ *
+ * Vectors 0–31 are reserved by Intel for CPU exceptions (divide error,
+ * page fault, general protection …).  We place hardware IRQs right after
+ * them, at vectors 32–47, and leave 48–63 to the CPU's local APIC; its
+ * interrupts bypass the PIC (and its EOI) entirely.
+ *
+ * THE 8259 PROGRAMMABLE INTERRUPT CONTROLLER
+ * -------------------------------------------
+ * A PC has two cascaded 8259 PICs: the master handles IRQ 0–7 and the
+ * slave IRQ 8–15, chained into the master's IRQ 2 input.
+ *
+ *   Master: command 0x20, data 0x21
+ *   Slave : command 0xA0, data 0xA1
+ *
+ * The BIOS programs the master to deliver IRQ 0–7 on vectors 8–15 —
+ * which collide with CPU exceptions (IRQ 0 would look like a double
+ * fault!).  We "remap" both chips with the four Initialisation Command
+ * Words (ICW1–ICW4):
+ *
+ *   ICW1 (0x11)      : start initialisation, ICW4 will follow
+ *   ICW2 (0x20/0x28) : vector offset for IRQ 0 / IRQ 8
+ *   ICW3 (0x04/0x02) : master has a slave on IRQ 2 / slave's cascade id
+ *   ICW4 (0x01)      : 8086 mode
+ *
+ * After that, writing to the data port sets the interrupt mask (bit n set
+ * = IRQ n disabled).  At the end of every handler the PIC must receive an
+ * End Of Interrupt command (0x20), otherwise it never raises that line
+ * (or any lower-priority one) again.
+ *
+ * SPURIOUS INTERRUPTS
+ * --------------------
+ * If a device drops its request line before the PIC has delivered it,
+ * the PIC still signals the lowest-priority line of that chip (IRQ 7 or
+ * IRQ 15).  Such a spurious IRQ is recognised by its bit being clear in
+ * the In-Service Register, and must NOT be acknowledged with an EOI.
+ */
+
+#include "irq.h"
+#include "vga.h"
+#include "io.h"
+#include "fpu.h"
+#include "task.h"
+#include "kprintf.h"
+#include "console.h"
+#include <stdint.h>
+
+#define PIC1_CMD   0x20
+#define PIC1_DATA  0x21
+#define PIC2_CMD   0xA0
+#define PIC2_DATA  0xA1
+#define PIC_EOI    0x20
+#define PIC_READ_ISR 0x0B   /* OCW3: next read of the command port = ISR */
+
+#define IRQ_BASE   32       /* vector of IRQ 0 after remapping */
+#define IRQ_COUNT  16
+#define VEC_LOCAL  48       /* first local APIC vector */
+#define LOCAL_COUNT 16
+#define VEC_DEVICE_NA 7     /* #NM: FPU instruction with CR0.TS set (fpu.c) */
+
+/* Flat 32-bit code segment selector — see the GDT in boot_x86.asm. */
+#define KERNEL_CS  0x08
+
+typedef struct __attribute__((packed)) {
+    uint16_t offset_lo;
+    uint16_t selector;
+    uint8_t  zero;
+    uint8_t  type_attr;
+    uint16_t offset_hi;
+} idt_entry_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t limit;
+    uint32_t base;
+} idt_ptr_t;
+
+/*
+ * Register snapshot built on the stack by isr_common in isr_x86.asm.
+ * Field order is the reverse of the push order: the last value pushed
+ * (EDI by PUSHA) sits at the lowest address.
+ */
+typedef struct {
+    uint32_t edi, esi, ebp, esp, ebx, edx, ecx, eax;   /* PUSHA          */
+    uint32_t vector, error;                            /* pushed by stub */
+    uint32_t eip, cs, eflags;                          /* pushed by CPU  */
+} irq_frame_t;
+
+/* Entry points of the 64 assembly stubs (32 exceptions + 16 IRQs + 16
+ * local APIC vectors). */
+extern const uint32_t isr_stub_table[VEC_LOCAL + LOCAL_COUNT];
+
+static idt_entry_t   idt[256];
+static irq_handler_t handlers[IRQ_COUNT];
+static irq_handler_t local_handlers[LOCAL_COUNT];
+
+static void idt_set_gate(int vec, uint32_t handler) {
+    idt[vec].offset_lo = (uint16_t)(handler & 0xFFFF);
+    idt[vec].selector  = KERNEL_CS;
+    idt[vec].zero      = 0;
+    idt[vec].type_attr = 0x8E;   /* present, ring 0, 32-bit interrupt gate */
+    idt[vec].offset_hi = (uint16_t)(handler >> 16);
+}
+
+/* pic_remap() — Move IRQ 0–15 to vectors 32–47 and mask all lines. */
+static void pic_remap(void) {
+    outb(PIC1_CMD,  0x11); io_wait();   /* ICW1: init + ICW4 needed */
+    outb(PIC2_CMD,  0x11); io_wait();
+    outb(PIC1_DATA, IRQ_BASE);     io_wait();   /* ICW2: vector offsets */
+    outb(PIC2_DATA, IRQ_BASE + 8); io_wait();
+    outb(PIC1_DATA, 0x04); io_wait();   /* ICW3: slave on IRQ 2      */
+    outb(PIC2_DATA, 0x02); io_wait();   /*       slave cascade id 2  */
+    outb(PIC1_DATA, 0x01); io_wait();   /* ICW4: 8086 mode           */
+    outb(PIC2_DATA, 0x01); io_wait();
+    outb(PIC1_DATA, 0xFF);              /* mask everything for now   */
+    outb(PIC2_DATA, 0xFF);
+}
+
+static void pic_unmask(unsigned irq) {
+    if (irq < 8) {
+        outb(PIC1_DATA, inb(PIC1_DATA) & ~(1 << irq));
+    } else {
+        outb(PIC2_DATA, inb(PIC2_DATA) & ~(1 << (irq - 8)));
+        outb(PIC1_DATA, inb(PIC1_DATA) & ~(1 << 2));   /* cascade line */
+    }
+}
+
+/* pic_in_service() — Read the In-Service Register of one PIC. */
+static uint8_t pic_in_service(uint16_t cmd_port) {
+    outb(cmd_port, PIC_READ_ISR);
+    return inb(cmd_port);
+}
+
+void irq_init(void) {
+    for (int i = 0; i < VEC_LOCAL + LOCAL_COUNT; i++)
+        idt_set_gate(i, isr_stub_table[i]);
+
+    idt_ptr_t ptr = { sizeof(idt) - 1, (uint32_t)idt };
+    __asm__ volatile ("lidt %0" : : "m"(ptr));
+
+    pic_remap();
+}
+
+void irq_register(unsigned irq, irq_handler_t handler) {
+    if (irq >= IRQ_COUNT) return;
+    handlers[irq] = handler;
+    pic_unmask(irq);
+}
+
+void irq_register_vector(unsigned vector, irq_handler_t handler) {
+    if (vector >= VEC_LOCAL && vector < VEC_LOCAL + LOCAL_COUNT)
+        local_handlers[vector - VEC_LOCAL] = handler;
+}
+
+/*
+ * cpu_exception() — A CPU exception in ring 0 means a kernel bug.
+ * There is nothing to return to, so report it and stop the machine.
+ */
+static void cpu_exception(irq_frame_t *f) {
+    vga_set_color(VGA_COLOR_WHITE, VGA_COLOR_RED);
+    kprintf("\nCPU exception %u (error 0x%08X) at EIP 0x%08X\n",
+            f->vector, f->error, f->eip);
+    console_sync();
+    for (;;) __asm__ volatile ("cli; hlt");
+}
+
+/*
+ * irq_dispatch() — Common C entry point, called by isr_common with a
+ * pointer to the saved registers.  Interrupts are disabled throughout.
+ */
+void irq_dispatch(irq_frame_t *f) {
+    if (f->vector < IRQ_BASE) {
+        if (f->vector == VEC_DEVICE_NA && fpu_trap())
+            return;                 /* lazy FPU switch: retry the insn */
+        cpu_exception(f);
+        return;
+    }
+
+    if (f->vector >= VEC_LOCAL) {   /* local APIC: no PIC EOI */
+        if (local_handlers[f->vector - VEC_LOCAL])
+            local_handlers[f->vector - VEC_LOCAL]();
+        sched_irq_exit();
+        return;
+    }
+
+    unsigned irq = f->vector - IRQ_BASE;
+
+    /* Filter spurious IRQ 7 / IRQ 15 (see header comment). */
+    if (irq == 7 && !(pic_in_service(PIC1_CMD) & 0x80))
+        return;
+    if (irq == 15 && !(pic_in_service(PIC2_CMD) & 0x80)) {
+        outb(PIC1_CMD, PIC_EOI);   /* the master did see the cascade */
+        return;
+    }
+
+    if (handlers[irq])
+        handlers[irq]();
+
+    if (irq >= 8)
+        outb(PIC2_CMD, PIC_EOI);
+    outb(PIC1_CMD, PIC_EOI);
+
+    /* Last: a task switch here resumes the interrupted task much later,
+     * so the PIC must have had its EOI. */
+    sched_irq_exit();
+}
@@ -0,0 +1,145 @@
+/*
+ * irq.h — Hardware interrupt interface
+ *
+ * WHY INTERRUPTS?
+ * ----------------
+ * Without interrupts the CPU can only learn that a device needs attention
+ * by asking it over and over (polling).  While it polls it does nothing
+ * else, and if it stops polling — to run a command, say — events are
+ * simply missed.  With interrupts the device pulls a line, the CPU
+ * suspends whatever it is doing, runs a short handler, and resumes.
+ * When there is nothing to do the CPU can halt and draw almost no power.
+ *
+ * On x86 (irq.c) interrupts are routed through the legacy Intel 8259
+ * PIC pair and dispatched via the IDT (Interrupt Descriptor Table).
+ * On Raspberry Pi 3 (irq_rpi3.c) they go through the BCM2837 interrupt
+ * controller and the AArch64 exception vector table (vectors_rpi3.S).
+ *
+ * IRQ NUMBERS (x86, legacy ISA assignment)
+ * ------------------------------------------
+ *   IRQ 0 : PIT channel 0 (system timer)     IRQ 8 : CMOS RTC
+ *   IRQ 1 : PS/2 keyboard                    IRQ 12: PS/2 mouse
+ *   IRQ 2 : cascade from the slave PIC       IRQ 14: primary ATA
+ *   IRQ 4 : COM1 serial port                 IRQ 15: secondary ATA
+ * The PIC lines arrive on vectors 32–47; vectors 48–63 belong to the
+ * CPU's local APIC (one-shot timer, spurious), see timer.c.
+ *
+ * IRQ NUMBERS (RPi3)
+ * -------------------
+ *   0–63  : "GPU" peripheral interrupts, e.g. 1 = system timer C1,
+ *           57 = PL011 UART
+ *   64–71 : ARM-local sources of core 0 (IRQ_LOCAL(n)), e.g.
+ *           IRQ_LOCAL(1) = generic timer CNTP, IRQ_LOCAL(4) = mailbox 0
+ */
+
+#ifndef IRQ_H
+#define IRQ_H
+
+#include <stdint.h>
+
+#ifdef PLATFORM_RPI3
+#  define IRQ_LOCAL(n) (64 + (n))
+#endif
+
+/* Handler for one hardware interrupt line.  Runs with interrupts
+ * disabled; acknowledging the device is the handler's job, the
+ * interrupt controller itself is handled by the dispatcher. */
+typedef void (*irq_handler_t)(void);
+
+/* irq_init() — Install the vector table and mask every IRQ line.
+ *   x86 : builds the IDT and remaps the PIC to vectors 32–47.
+ *   RPi3: points VBAR_EL1 at the vector table.
+ * Interrupts stay globally disabled until irq_enable() is called. */
+void irq_init(void);
+
+/* irq_register() — Install a handler for an IRQ line and unmask it. */
+void irq_register(unsigned irq, irq_handler_t handler);
+
+#if defined(PLATFORM_HOST)
+
+/* Host build (make PLATFORM=host): a user program has no interrupts to
+ * mask, and may not execute CLI. */
+typedef uint32_t irq_flags_t;
+
+static inline void irq_enable(void)  { }
+static inline void irq_disable(void) { }
+static inline irq_flags_t irq_save(void) { return 0; }
+static inline void irq_restore(irq_flags_t f) { (void)f; }
+static inline int irq_flags_enabled(irq_flags_t f) { (void)f; return 1; }
+
+#elif !defined(PLATFORM_RPI3)
+
+/* Saved interrupt state: EFLAGS on x86, DAIF on AArch64. */
+typedef uint32_t irq_flags_t;
+
+/* irq_enable() / irq_disable() — Set / clear the CPU interrupt flag. */
+static inline void irq_enable(void)  { __asm__ volatile ("sti" ::: "memory"); }
+static inline void irq_disable(void) { __asm__ volatile ("cli" ::: "memory"); }
+
+/* irq_save() — Disable interrupts, returning the previous state so that
+ * irq_restore() can put it back.  Safe to nest, unlike disable/enable. */
+static inline irq_flags_t irq_save(void) {
+    irq_flags_t f;
+    __asm__ volatile ("pushf; pop %0; cli" : "=r"(f) : : "memory");
+    return f;
+}
+
+static inline void irq_restore(irq_flags_t f) {
+    __asm__ volatile ("push %0; popf" : : "r"(f) : "memory", "cc");
+}
+
+/* irq_flags_enabled() — Were interrupts enabled when f was saved? */
+static inline int irq_flags_enabled(irq_flags_t f) {
+    return (f & (1 << 9)) != 0;     /* EFLAGS.IF */
+}
+
+/* irq_register_vector() — Install a handler for one of the local APIC
+ * vectors 48–63 (timer.c).  These do not come through the PIC: the
+ * handler sends the EOI to the local APIC itself. */
+void irq_register_vector(unsigned vector, irq_handler_t handler);
+
+#else   /* PLATFORM_RPI3 */
+
+typedef uint64_t irq_flags_t;
+
+/* DAIFClr / DAIFSet #2 clear / set only the I (IRQ) mask bit. */
+static inline void irq_enable(void)  { __asm__ volatile ("msr daifclr, #2" ::: "memory"); }
+static inline void irq_disable(void) { __asm__ volatile ("msr daifset, #2" ::: "memory"); }
+
+static inline irq_flags_t irq_save(void) {
+    irq_flags_t f;
+    __asm__ volatile ("mrs %0, daif; msr daifset, #2" : "=r"(f) : : "memory");
+    return f;
+}
+
+static inline void irq_restore(irq_flags_t f) {
+    __asm__ volatile ("msr daif, %0" : : "r"(f) : "memory");
+}
+
+static inline int irq_flags_enabled(irq_flags_t f) {
+    return (f & (1 << 7)) == 0;     /* DAIF.I clear = IRQs enabled */
+}
+
+#endif
+
+/*
+ * cpu_idle() — Sleep until the next interrupt (timer_queue.c).
+ *
+ * Call with interrupts DISABLED, after checking that there is nothing to
+ * do.  Returns with interrupts enabled, after the handler of whatever
+ * interrupt woke the CPU has run.  The wake-up can never be lost:
+ *   x86 : STI only takes effect after the following instruction, so no
+ *         interrupt can slip in between the check and the HLT.
+ *   RPi3: WFI wakes the core when an interrupt becomes PENDING, even
+ *         while PSTATE.I masks it; the IRQ is taken at the unmask after.
+ * While the caller waits, the other tasks run (task.h); the core halts
+ * only when none of them can.  Each halt is counted as a wake-up, and
+ * the time spent halted as idle residency (timer_stats()).
+ */
+void cpu_idle(void);
+
+/* cpu_halt() — The halt itself, same contract, no scheduling: for the
+ * scheduler, and for a caller holding sched_lock(). */
+void cpu_halt(void);
+
+#endif
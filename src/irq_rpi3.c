@@ -0,0 +1,164 @@
+/*
+ * irq_rpi3.c — BCM2837 interrupt controller and exception dispatch (RPi3)
+ *
+ * TWO LEVELS OF INTERRUPT CONTROLLER
+ * -----------------------------------
+ * The BCM2837 has no ARM GIC.  Interrupts reach a core through two
+ * Broadcom-specific blocks:
+ *
+ *   1. The "ARM local" block at 0x40000000 collects the per-core sources
+ *      (generic timers, inter-core mailboxes) and one line from the GPU
+ *      interrupt controller.  Register 0x40000060 (Core 0 IRQ source)
+ *      says which of them is pending:
+ *        bits 0–3 : CNTPS, CNTPNS, CNTHP, CNTV timers
+ *        bits 4–7 : mailboxes 0–3
+ *        bit  8   : GPU interrupt (look at the block below)
+ *
+ *   2. The peripheral ("GPU") interrupt controller at 0x3F00B200 handles
+ *      the 64 SoC peripheral lines (system timer, UART, DMA, …):
+ *        0x204 pending 1 (IRQ 0–31)     0x210 enable 1     0x21C disable 1
+ *        0x208 pending 2 (IRQ 32–63)    0x214 enable 2     0x220 disable 2
+ *      Writing a 1 bit to an enable/disable register changes only that
+ *      line; zero bits are ignored.  By default the GPU line is routed to
+ *      core 0, which is the core running the kernel.
+ *
+ * Unlike the 8259 there is no End Of Interrupt command: a line stays
+ * asserted until the handler clears the condition in the device itself
+ * (e.g. by reading the UART FIFO).
+ *
+ * EXCEPTION LEVELS
+ * -----------------
+ * boot_rpi3.S drops from EL2 (or EL3) to EL1 before calling kernel_main(),
+ * so exceptions are taken at EL1 and vectored through VBAR_EL1.
+ */
+
+#include "irq.h"
+#include "vga.h"
+#include "fpu.h"
+#include "task.h"
+#include "kprintf.h"
+#include "console.h"
+#include "qemu.h"
+#include <stdint.h>
+
+#define IRQ_PENDING1  ((volatile uint32_t *)0x3F00B204UL)
+#define IRQ_PENDING2  ((volatile uint32_t *)0x3F00B208UL)
+#define IRQ_ENABLE1   ((volatile uint32_t *)0x3F00B210UL)
+#define IRQ_ENABLE2   ((volatile uint32_t *)0x3F00B214UL)
+#define IRQ_BASIC_DIS ((volatile uint32_t *)0x3F00B224UL)
+#define IRQ_DISABLE1  ((volatile uint32_t *)0x3F00B21CUL)
+#define IRQ_DISABLE2  ((volatile uint32_t *)0x3F00B220UL)
+
+#define CORE0_TIMER_IRQCNTL ((volatile uint32_t *)0x40000040UL)
+#define CORE0_MBOX_IRQCNTL  ((volatile uint32_t *)0x40000050UL)
+#define CORE0_IRQ_SOURCE    ((volatile uint32_t *)0x40000060UL)
+
+#define SRC_GPU       (1u << 8)
+#define IRQ_COUNT     72        /* 64 GPU lines + 8 local sources */
+
+#define VEC_SYNC_EL1  4         /* vector index: sync, current EL, SP_ELx */
+#define VEC_IRQ_EL1   5         /* vector index: IRQ, current EL, SP_ELx */
+#define EC_UNKNOWN    0x00      /* ESR class: undefined instruction        */
+#define EC_FP_TRAP    0x07      /* ESR class: FP/SIMD trapped by CPACR_EL1 */
+
+/* Register snapshot built by vector_common in vectors_rpi3.S. */
+typedef struct {
+    uint64_t x[31];
+    uint64_t elr;
+    uint64_t spsr;
+    uint64_t pad;
+} irq_frame_t;
+
+extern char vectors[];          /* vectors_rpi3.S */
+
+static irq_handler_t handlers[IRQ_COUNT];
+static uint32_t      enabled[2];    /* GPU lines we have unmasked */
+
+void irq_init(void) {
+    *IRQ_DISABLE1  = 0xFFFFFFFFu;
+    *IRQ_DISABLE2  = 0xFFFFFFFFu;
+    *IRQ_BASIC_DIS = 0xFFFFFFFFu;
+    *CORE0_TIMER_IRQCNTL = 0;
+    *CORE0_MBOX_IRQCNTL  = 0;
+
+    __asm__ volatile ("msr vbar_el1, %0; isb" : : "r"(vectors) : "memory");
+}
+
+void irq_register(unsigned irq, irq_handler_t handler) {
+    if (irq >= IRQ_COUNT) return;
+    handlers[irq] = handler;
+
+    if (irq < 32) {
+        enabled[0] |= 1u << irq;
+        *IRQ_ENABLE1 = 1u << irq;
+    } else if (irq < 64) {
+        enabled[1] |= 1u << (irq - 32);
+        *IRQ_ENABLE2 = 1u << (irq - 32);
+    } else if (irq < IRQ_LOCAL(4)) {
+        *CORE0_TIMER_IRQCNTL |= 1u << (irq - IRQ_LOCAL(0));
+    } else {
+        *CORE0_MBOX_IRQCNTL  |= 1u << (irq - IRQ_LOCAL(4));
+    }
+}
+
+/* dispatch_bits() — Call the handler of every set bit, lowest first. */
+static void dispatch_bits(uint32_t bits, unsigned base) {
+    while (bits) {
+        unsigned n = (unsigned)__builtin_ctz(bits);
+        bits &= bits - 1;
+        if (handlers[base + n])
+            handlers[base + n]();
+    }
+}
+
+static void irq_dispatch(void) {
+    uint32_t src = *CORE0_IRQ_SOURCE;
+
+    dispatch_bits(src & 0xFF, IRQ_LOCAL(0));
+    if (src & SRC_GPU) {
+        dispatch_bits(*IRQ_PENDING1 & enabled[0], 0);
+        dispatch_bits(*IRQ_PENDING2 & enabled[1], 32);
+    }
+}
+
+/*
+ * cpu_exception() — Anything other than an IRQ means a kernel bug.
+ * ESR_EL1 (Exception Syndrome Register) bits [31:26] hold the exception
+ * class, e.g. 0x25 = data abort, 0x21 = instruction abort; FAR_EL1 holds
+ * the faulting address for aborts.
+ */
+static void cpu_exception(irq_frame_t *f, uint64_t index) {
+    uint64_t esr, far;
+    __asm__ volatile ("mrs %0, esr_el1" : "=r"(esr));
+    __asm__ volatile ("mrs %0, far_el1" : "=r"(far));
+
+    vga_set_color(VGA_COLOR_WHITE, VGA_COLOR_RED);
+    kprintf("\nCPU exception %u ESR 0x%016llX ELR 0x%016llX FAR 0x%016llX\n",
+            (unsigned)index, (unsigned long long)esr,
+            (unsigned long long)f->elr, (unsigned long long)far);
+    console_sync();
+    for (;;) __asm__ volatile ("wfe");
+}
+
+/*
+ * exception_dispatch() — Common C entry point, called by vector_common
+ * with the saved frame and the vector index (0–15).
+ */
+void exception_dispatch(irq_frame_t *f, uint64_t index) {
+    if (index == VEC_IRQ_EL1) {
+        irq_dispatch();
+        sched_irq_exit();           /* may switch tasks (task.h) */
+        return;
+    }
+    if (index == VEC_SYNC_EL1) {
+        uint64_t esr;
+        __asm__ volatile ("mrs %0, esr_el1" : "=r"(esr));
+        if ((esr >> 26) == EC_FP_TRAP && fpu_trap())
+            return;                 /* lazy FP switch: retry the insn */
+        if ((esr >> 26) == EC_UNKNOWN && f->elr == (uint64_t)qemu_semihost_call) {
+            f->elr += 4;            /* no semihosting: qemu_exit() returns */
+            return;
+        }
+    }
+    cpu_exception(f, index);
+}
@@ -0,0 +1,73 @@
+; =============================================================================
+; isr_x86.asm — Interrupt entry stubs for ExigeOS (x86 / i386)
+;
+; WHY ASSEMBLY STUBS?
+; --------------------
+; When an interrupt or exception occurs, the CPU pushes EFLAGS, CS and EIP
+; on the current stack and jumps to the address found in the IDT.  It does
+; NOT save any general-purpose register, and it does not tell the handler
+; which vector fired.  A C function cannot be used directly as a handler:
+; it would clobber registers and return with RET instead of IRET.
+;
+; Each stub below therefore:
+;   1. pushes a dummy error code (0) if the CPU did not push one, so the
+;      stack layout is the same for every vector;
+;   2. pushes its own vector number;
+;   3. jumps to isr_common, which saves all registers, calls the C
+;      dispatcher irq_dispatch(frame) and restores everything with IRET.
+;
+; Stack layout seen by irq_dispatch() (lowest address first):
+;
+;   EDI ESI EBP ESP EBX EDX ECX EAX   ← PUSHA
+;   vector  error                     ← stub
+;   EIP  CS  EFLAGS                   ← CPU
+;
+; Vectors 0–31 are CPU exceptions, 32–47 the remapped PIC lines and
+; 48–63 the local APIC's own interrupts (timer, spurious).
+;
+; EXCEPTIONS WITH AN ERROR CODE
+; ------------------------------
+; The CPU pushes an extra error code for vectors 8 (double fault), 10–14
+; (invalid TSS, segment not present, stack fault, general protection,
+; page fault), 17 (alignment check), 21, 29 and 30.
+; =============================================================================
+
+extern irq_dispatch     ; defined in irq.c
+
+section .text
+
+%assign i 0
+%rep 64
+isr%[i]:
+%if i == 8 || (i >= 10 && i <= 14) || i == 17 || i == 21 || i == 29 || i == 30
+    ; the CPU has already pushed an error code
+%else
+    push dword 0        ; dummy error code
+%endif
+    push dword i        ; vector number
+    jmp isr_common
+%assign i i+1
+%endrep
+
+isr_common:
+    pusha               ; save EAX, ECX, EDX, EBX, ESP, EBP, ESI, EDI
+    cld                 ; the C ABI expects the direction flag clear
+    mov ebx, esp        ; EBX = frame pointer (callee-saved, survives CALL)
+    and esp, -16        ; the interrupted code may have left ESP unaligned
+    sub esp, 12         ; keep ESP 16-byte aligned after the PUSH below
+    push ebx            ; argument: pointer to the saved frame
+    call irq_dispatch
+    mov esp, ebx        ; back to the frame
+    popa
+    add esp, 8          ; drop vector number and error code
+    iret
+
+; ── Stub address table, read by irq_init() to fill the IDT ───────────────────
+section .rodata
+global isr_stub_table
+isr_stub_table:
+%assign i 0
+%rep 64
+    dd isr%[i]
+%assign i i+1
+%endrep
@@ -3,29 +3,113 @@
  *
  * kernel_main() is called by the platform-specific boot stub after:
  *   x86 : the CPU is in 32-bit protected mode with a valid stack.
+ *         boot_magic / boot_info are the Multiboot EAX / EBX values.
  *   RPi3: core 0 is in AArch64 mode, BSS is zeroed, stack is ready.
+ *         Both arguments are 0.
  *
  * Initialisation order matters:
- *   1. vga_init()      — set up the display first so subsequent steps
- *                        can print error messages if needed.
- *   2. keyboard_init() — prepare input before the shell loop starts.
- *   3. shell_run()     — enter the interactive loop (never returns).
+ *   0. fpu_init()      — x86: enable the x87 and SSE (the RPi3 boot stub
+ *                        already enabled FP/NEON); kstring_init() then
+ *                        selects the memcpy/memset variants they allow.
+ *   1. irq_init()      — install the vector table (IDT / VBAR_EL1) with
+ *                        every IRQ line masked, so that drivers can
+ *                        register their handlers from here on.
+ *   2. uart_init() / console_init() / vga_init()
+ *                      — set up the outputs first so subsequent steps
+ *                        can print error messages if needed: the serial
+ *                        port (COM1 / PL011) and the screen become the
+ *                        sinks of the console that kprintf() writes to.
+ *   3. clock_init()    — calibrate the nanosecond clock (x86: TSC
+ *                        against PIT channel 2, by polling, so IRQs can
+ *                        stay off); rtc_init() reads the wall-clock
+ *                        time once (rtc.h); timer_init() then sets up the
+ *                        one-shot deadline timer on top of it, and
+ *                        sound_init() the audio output the note
+ *                        sequencer drives from timer events.
+ *   4. keyboard_init() — prepare input before the shell loop starts;
+ *                        on x86 this unmasks IRQ 1.
+ *   5. memmap_detect() / pmm_init()
+ *                      — find the RAM (Multiboot map / firmware mailbox)
+ *                        and hand it to the page allocator, all but the
+ *                        boot modules; slab_init() sets up the kmalloc()
+ *                        caches; initrd_init() checks the archive of the
+ *                        initial RAM disk (initrd.h), if there is one.
+ *   6. task_init()     — this code, and the shell after it, becomes
+ *                        task 0 of the scheduler (it needs the clock and
+ *                        the pmm for the other tasks' stacks);
+ *      irq_enable()    — only now may interrupts be delivered.
+ *   7. smp_init()      — RPi3: wake cores 1–3 as job workers (it waits
+ *                        for them with the timer, hence after 3 and 6).
+ *   8. shell_run()     — enter the interactive loop (never returns).
  *
- * There is no memory allocator, no scheduler, and no interrupt handling
- * beyond the PS/2 polling in keyboard.c.  Everything runs sequentially
- * in a single infinite loop at ring 0 (x86) / EL1 or EL2 (AArch64).
+ * Each group of steps is timed for `bootstats` (bootstats.h).
+ *
+ * There is no periodic tick.  Core 0 runs the shell and the background
+ * tasks it starts (`cmd &`), all at ring 0 (x86) / EL1 (AArch64), taking
+ * turns in 10 ms slices only while several of them can run (task.h); on
+ * RPi3 the other cores only execute jobs handed out through smp.h.
  */
 
 #include "vga.h"
+#include "uart.h"
+#include "console.h"
 #include "keyboard.h"
 #include "shell.h"
+#include "timer.h"
+#include "clock.h"
+#include "rtc.h"
+#include "sound.h"
+#include "irq.h"
+#include "smp.h"
+#include "task.h"
+#include "pmm.h"
+#include "slab.h"
+#include "initrd.h"
+#include "kstring.h"
+#include "fpu.h"
+#include "kprintf.h"
+#include "bootstats.h"
+#include <stdint.h>
+
+void kernel_main(uintptr_t boot_magic, uintptr_t boot_info) {
+    mem_region_t ram[MEMMAP_MAX], mod;
 
-void kernel_main(void) {
+    bootstats_end(BOOT_STUB);
+    fpu_init();
+    kstring_init();
+    bootstats_begin(BOOT_CONSOLE);
+    irq_init();
+    uart_init();
+    console_init();
     vga_init();
+    bootstats_end(BOOT_CONSOLE);
+    bootstats_begin(BOOT_CLOCK);
+    clock_init();
+    rtc_init();
+    bootstats_end(BOOT_CLOCK);
+    timer_init();
+    sound_init();
+    bootstats_begin(BOOT_KEYBOARD);
     keyboard_init();
+    bootstats_end(BOOT_KEYBOARD);
+    bootstats_begin(BOOT_MEMORY);
+    pmm_init(ram, memmap_detect(boot_magic, boot_info, ram, MEMMAP_MAX));
+    slab_init();
+    if (memmap_module(boot_magic, boot_info, &mod))
+        initrd_init((const void *)(uintptr_t)mod.base, (uint32_t)mod.len);
+    bootstats_end(BOOT_MEMORY);
+    task_init("shell");
+    irq_enable();
+    bootstats_begin(BOOT_SMP);
+    smp_init();
+    bootstats_end(BOOT_SMP);
 
-    vga_print("EXIGE OS [version 0.1]");
-    vga_newline();
+    kprintf("EXIGE OS [version 0.1]\n");
+    kprintf("Memory: %u MB free\n", pmm_free_pages() / (1024 * 1024 / PAGE_SIZE));
+    kprintf("Clock: %s, %u.%03u MHz\n", clock_source(),
+            clock_khz() / 1000, clock_khz() % 1000);
+    if (initrd_count())
+        kprintf("Initrd: %u files, %u bytes\n", initrd_count(), initrd_size());
 
     shell_run();    /* never returns */
 }
@@ -19,16 +19,43 @@
  *   - Make  codes: 0x01–0x58 (bit 7 = 0)
  *   - Break codes: 0x81–0xD8 (bit 7 = 1)
  *
- * We discard break codes (bit 7 set) so we only react to key presses.
- * This means we cannot track modifier keys (Shift, Ctrl, Alt) — a
- * known limitation of this minimal driver.
+ * We discard break codes (bit 7 set) so we only react to key presses,
+ * except for the Shift keys, whose state we need to track:
+ *   Left Shift  0x2A / 0xAA      Right Shift  0x36 / 0xB6
+ * Shift does not change the characters produced (no upper case yet); it
+ * only selects the scrollback keys below.
  *
- * POLLING vs INTERRUPTS
- * ----------------------
- * A production kernel uses IRQ 1 (the PS/2 interrupt line) to receive
- * keystrokes asynchronously.  Here we poll: we spin in keyboard_getchar()
- * checking port 0x64 bit 0 (Output Buffer Full) until data arrives.
- * Simple, but wastes CPU cycles while waiting.
+ * Keys added after the original XT keyboard (arrows, PgUp/PgDn, …) send
+ * a 0xE0 prefix byte before their code.  The only ones we act on are
+ *   Up (E0 48) / Down (E0 50) — KEY_UP / KEY_DOWN, for the line
+ *   editor's history (readline.c);
+ *   Shift+PgUp (E0 49) / Shift+PgDn (E0 51) — scroll the console
+ *   history by one screen (see vga_scrollback()).
+ * Other prefixed codes are ignored.  Without the prefix, 48 and 50 are
+ * 8 and 2 of the numeric keypad, which the table leaves unmapped.
+ *
+ * INTERRUPT-DRIVEN INPUT
+ * ------------------------
+ * The 8042 raises IRQ 1 as soon as a scan code is waiting in its output
+ * buffer.  kb_irq() reads that byte and pushes it into a ring buffer
+ * (see ring.h) — nothing else, so the handler is a few instructions long.
+ * keyboard_key() consumes from the ring and, when it is empty, halts
+ * the CPU until the next interrupt instead of spinning on port 0x64.
+ *
+ * Two benefits over polling:
+ *   - The CPU is idle (HLT) while the shell waits at its prompt.
+ *   - Keys typed while a command runs are queued in the ring (256 bytes)
+ *     instead of overflowing the controller's one-byte output buffer.
+ *
+ * SERIAL INPUT
+ * -------------
+ * Bytes received on COM1 (uart.c's RX ring) are read as well, so that
+ * a headless run — `make run-headless`, or `make bench` scripting the
+ * shell through QEMU's -serial stdio — can be typed at.  They come as
+ * ASCII already, and go through keyboard_serial() (readline.c) as on
+ * the Pi (keyboard_rpi3.c): Enter (CR, LF or CR LF), Backspace (BS or
+ * DEL) and the arrows' escape sequences become keys, other control
+ * bytes are dropped.
  *
  * AZERTY LAYOUT
  * --------------
@@ -39,11 +66,21 @@
 
 #include "keyboard.h"
 #include "vga.h"
+#include "irq.h"
+#include "ring.h"
 #include "io.h"
+#include "uart.h"
+#include "bootstats.h"
+#include "trace.h"
 #include <stdint.h>
 
 #define KB_DATA   0x60   /* PS/2 data port   */
 #define KB_STATUS 0x64   /* PS/2 status port */
+#define KB_IRQ    1
+
+/* Raw scan codes, produced by kb_irq() and consumed by keyboard_key(). */
+static uint8_t kb_storage[256];
+static ring_t  kb_ring = RING_INIT(kb_storage);
 
 /*
  * Scan code → ASCII table (Set 1, AZERTY).
@@ -68,40 +105,95 @@ static const char sc_azerty[128] = {
     0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,
 };
 
+/*
+ * kb_irq() — IRQ 1 handler.
+ * Reading port 0x60 both fetches the scan code and tells the controller
+ * it may deliver the next one.  If the ring is full the byte is dropped.
+ */
+static void kb_irq(void) {
+    ring_put(&kb_ring, inb(KB_DATA));
+}
+
 void keyboard_init(void) {
     /* Drain any stale bytes sitting in the PS/2 FIFO. */
+    bootstats_begin(BOOT_KBD_DRAIN);
     while (inb(KB_STATUS) & 0x01)
         inb(KB_DATA);
+    bootstats_end(BOOT_KBD_DRAIN);
+    irq_register(KB_IRQ, kb_irq);
 }
 
-char keyboard_getchar(void) {
-    uint8_t sc;
+/*
+ * kb_next() — Take the next scan code from the ring (returns 1) or the
+ * next byte from the serial line (returns 0).  When both are empty it
+ * returns -1 if wait is 0, and otherwise halts the CPU until one of them
+ * is not.  Interrupts are disabled around the emptiness check so that
+ * an IRQ arriving just before HLT cannot be missed (see cpu_idle() in
+ * irq.h).
+ */
+static int kb_next(uint8_t *sc, char *serial, int wait) {
     for (;;) {
-        while (!(inb(KB_STATUS) & 0x01));   /* poll: wait for data ready */
-        sc = inb(KB_DATA);
-        if (sc & 0x80) continue;    /* break code (key release) — skip */
-        if (sc >= 128)  continue;   /* out-of-range — skip             */
-        char c = sc_azerty[sc];
-        if (c) return c;
+        irq_disable();
+        if (ring_get(&kb_ring, sc)) {
+            irq_enable();
+            return 1;
+        }
+        if (uart_poll(serial)) {
+            irq_enable();
+            return 0;
+        }
+        if (!wait) {
+            irq_enable();
+            return -1;
+        }
+        TRACE(TRACE_KBD_WAIT, 0);
+        cpu_idle();
     }
 }
 
-int keyboard_readline(char *buf, int max) {
-    int len = 0;
+#define SC_EXTENDED  0xE0
+#define SC_LSHIFT    0x2A
+#define SC_RSHIFT    0x36
+#define SC_UP        0x48   /* after 0xE0 */
+#define SC_PGUP      0x49   /* after 0xE0 */
+#define SC_DOWN      0x50   /* after 0xE0 */
+#define SC_PGDN      0x51   /* after 0xE0 */
+
+int keyboard_key(int wait) {
+    static int shift;           /* bit 0 = left, bit 1 = right Shift held */
+    static int extended;        /* an E0 was the last byte, maybe in an
+                                   earlier call that did not wait          */
+    uint8_t sc;
+    char serial;
     for (;;) {
-        char c = keyboard_getchar();
-        if (c == '\n') {
-            buf[len] = '\0';
-            vga_putchar('\n');
-            return len;
-        } else if (c == '\b') {
-            if (len > 0) {
-                len--;
-                vga_putchar('\b');
-            }
-        } else if (len < max - 1) {
-            buf[len++] = c;
-            vga_putchar(c);
+        int got = kb_next(&sc, &serial, wait);
+        if (got < 0)
+            return KEY_NONE;
+        if (got == 0) {
+            int k = keyboard_serial(serial);
+            if (k != KEY_NONE) return k;
+            continue;
         }
+        if (sc == SC_EXTENDED) { extended = 1; continue; }
+
+        uint8_t key = sc & 0x7F;
+        int released = sc & 0x80;
+        if (!extended && (key == SC_LSHIFT || key == SC_RSHIFT)) {
+            int bit = key == SC_LSHIFT ? 1 : 2;
+            shift = released ? shift & ~bit : shift | bit;
+            continue;
+        }
+        if (released) { extended = 0; continue; }   /* key release — skip */
+
+        if (extended) {
+            extended = 0;
+            if (key == SC_UP)   return KEY_UP;
+            if (key == SC_DOWN) return KEY_DOWN;
+            if (shift && key == SC_PGUP) vga_scrollback(VGA_HEIGHT - 1);
+            if (shift && key == SC_PGDN) vga_scrollback(-(VGA_HEIGHT - 1));
+            continue;
+        }
+        char c = sc_azerty[key];
+        if (c) return c;
     }
 }
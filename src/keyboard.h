@@ -1,12 +1,14 @@
 /*
  * keyboard.h — Keyboard driver interface
  *
- * On x86 the driver reads PS/2 scan codes from port 0x60.
+ * On x86 the driver reads PS/2 scan codes from port 0x60, and the bytes
+ * received on COM1.
  * On Raspberry Pi 3 the driver reads bytes from the UART (serial
  * terminal), since there is no PS/2 controller on the board.
  *
- * Both implementations expose the same three functions so that
- * shell.c and kernel.c compile unchanged on either platform.
+ * Both drivers deliver KEYS through keyboard_key(); the line editor
+ * on top of them (readline.c: echo, history) is shared, so that shell.c
+ * and kernel.c compile unchanged on either platform.
  */
 
 #ifndef KEYBOARD_H
@@ -14,21 +16,35 @@
 
 #include <stdint.h>
 
+/* What keyboard_key() returns besides ASCII characters. */
+#define KEY_NONE  0                 /* wait = 0: nothing queued        */
+#define KEY_UP    0x100             /* arrow keys: history             */
+#define KEY_DOWN  0x101
+
 /* keyboard_init() — Initialise the keyboard hardware.
- *   x86 : flushes any stale bytes in the PS/2 FIFO.
+ *   x86 : flushes any stale bytes in the PS/2 FIFO and installs the
+ *         IRQ 1 handler (call after irq_init()).
  *   RPi3: UART already initialised by vga_init(); this is a no-op. */
 void keyboard_init(void);
 
-/* keyboard_getchar() — Blocking read of one character.
- * Spins until a printable keystroke (or Enter / Backspace) is
- * available, then returns its ASCII value. */
-char keyboard_getchar(void);
+/* keyboard_key() — The next key: a printable character, '\n' (Enter),
+ * '\b' (Backspace), KEY_UP or KEY_DOWN.  With wait = 0 it returns
+ * KEY_NONE at once when no complete key is queued; otherwise it waits:
+ *   x86 : halts the CPU between keyboard and COM1 interrupts.
+ *   RPi3: sleeps (WFI) between UART receive interrupts. */
+int keyboard_key(int wait);
+
+/* keyboard_serial() — For the drivers: decode one byte received on a
+ * serial line.  Returns the key it completes, or KEY_NONE (the byte was
+ * part of an escape sequence, or is ignored).  See readline.c. */
+int keyboard_serial(char c);
 
 /* keyboard_readline() — Read a line of text into buf.
  *   buf : destination buffer (null-terminated on return)
  *   max : size of buf in bytes (including the null terminator)
- * Echoes typed characters to the screen and handles backspace.
- * Returns the number of characters written (not counting '\0'). */
+ * Echoes what is typed, handles Backspace, and recalls earlier lines
+ * with the Up / Down arrows.  Returns the number of characters written
+ * (not counting '\0'). */
 int keyboard_readline(char *buf, int max);
 
 #endif
@@ -0,0 +1,202 @@
+/*
+ * kprintf.c — printf-style formatting (both platforms)
+ *
+ * ONE FORMATTER, TWO DESTINATIONS
+ * --------------------------------
+ * format() walks the format string once and appends every character it
+ * produces to an out_t buffer.  What happens when the buffer fills up is
+ * the only difference between the two entry points:
+ *   kprintf()   : `flush` is console_write(): the chunk goes to the console
+ *                 and the buffer is reused;
+ *   ksnprintf() : no flush: further characters are counted but dropped.
+ *
+ * 64-BIT NUMBERS ON x86
+ * ----------------------
+ * A 64-bit division on i386 compiles to a call to __udivdi3 in libgcc,
+ * which a -nostdlib kernel does not have.  div10() divides by 10 one
+ * 16-bit limb at a time instead, each step a 32-bit division; values
+ * that fit in 32 bits skip it.
+ */
+
+#include "kprintf.h"
+#include "console.h"
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define KPRINTF_BUF 128         /* stack buffer of kprintf() */
+
+typedef struct {
+    char    *buf;
+    size_t   size;              /* capacity, including room for a NUL */
+    size_t   len;               /* characters in buf                  */
+    size_t   total;             /* characters produced overall        */
+    void   (*flush)(const char *s, uint32_t len);
+} out_t;
+
+static void emit(out_t *o, char c) {
+    if (o->len + 1 >= o->size && o->flush) {
+        o->flush(o->buf, (uint32_t)o->len);
+        o->len = 0;
+    }
+    if (o->len + 1 < o->size)
+        o->buf[o->len++] = c;
+    o->total++;
+}
+
+static void emit_pad(out_t *o, char c, int n) {
+    while (n-- > 0)
+        emit(o, c);
+}
+
+/* div10() — *v /= 10, returning the remainder, without 64-bit division. */
+static unsigned div10(uint64_t *v) {
+    if (*v <= 0xFFFFFFFFu) {
+        uint32_t x = (uint32_t)*v;
+        *v = x / 10;
+        return x % 10;
+    }
+    uint64_t q = 0;
+    uint32_t rem = 0;
+    for (int shift = 48; shift >= 0; shift -= 16) {
+        uint32_t cur = (rem << 16) | (uint32_t)((*v >> shift) & 0xFFFF);
+        q |= (uint64_t)(cur / 10) << shift;
+        rem = cur % 10;
+    }
+    *v = q;
+    return rem;
+}
+
+typedef struct {
+    int width;
+    int left;                   /* '-' */
+    int zero;                   /* '0' */
+} spec_t;
+
+static void emit_num(out_t *o, uint64_t v, unsigned base, int upper,
+                     int neg, const spec_t *sp) {
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char tmp[20];               /* 2^64 has 20 decimal digits */
+    int n = 0;
+
+    do {
+        unsigned d = base == 16 ? (unsigned)(v & 0xF) : div10(&v);
+        if (base == 16) v >>= 4;
+        tmp[n++] = digits[d];
+    } while (v);
+
+    int pad = sp->width - n - neg;
+    if (!sp->left && !sp->zero) emit_pad(o, ' ', pad);
+    if (neg) emit(o, '-');
+    if (!sp->left && sp->zero) emit_pad(o, '0', pad);
+    while (n) emit(o, tmp[--n]);
+    if (sp->left) emit_pad(o, ' ', pad);
+}
+
+static void emit_str(out_t *o, const char *s, const spec_t *sp) {
+    int n = 0;
+    if (!s) s = "(null)";
+    for (const char *p = s; *p; p++) n++;
+    if (!sp->left) emit_pad(o, ' ', sp->width - n);
+    while (*s) emit(o, *s++);
+    if (sp->left) emit_pad(o, ' ', sp->width - n);
+}
+
+static void format(out_t *o, const char *fmt, va_list ap) {
+    for (; *fmt; fmt++) {
+        if (*fmt != '%') {
+            emit(o, *fmt);
+            continue;
+        }
+
+        spec_t sp = { 0, 0, 0 };
+        for (;; fmt++) {
+            if      (fmt[1] == '-') sp.left = 1;
+            else if (fmt[1] == '0') sp.zero = 1;
+            else break;
+        }
+        if (fmt[1] == '*') {
+            sp.width = va_arg(ap, int);
+            fmt++;
+        } else {
+            while (fmt[1] >= '0' && fmt[1] <= '9')
+                sp.width = sp.width * 10 + (*++fmt - '0');
+        }
+
+        int lng = 0;            /* 1 = long, 2 = long long, 3 = size_t */
+        if (fmt[1] == 'l') { lng = 1; fmt++; if (fmt[1] == 'l') { lng = 2; fmt++; } }
+        else if (fmt[1] == 'z') { lng = 3; fmt++; }
+
+        char conv = *++fmt;
+        uint64_t u;
+        int64_t  s;
+        switch (conv) {
+        case 'd':
+        case 'i':
+            if      (lng == 1) s = va_arg(ap, long);
+            else if (lng == 2) s = va_arg(ap, long long);
+            else if (lng == 3) s = (int64_t)va_arg(ap, size_t);
+            else               s = va_arg(ap, int);
+            emit_num(o, s < 0 ? -(uint64_t)s : (uint64_t)s, 10, 0, s < 0, &sp);
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+            if      (lng == 1) u = va_arg(ap, unsigned long);
+            else if (lng == 2) u = va_arg(ap, unsigned long long);
+            else if (lng == 3) u = va_arg(ap, size_t);
+            else               u = va_arg(ap, unsigned int);
+            emit_num(o, u, conv == 'u' ? 10 : 16, conv == 'X', 0, &sp);
+            break;
+        case 'p':
+            emit(o, '0');
+            emit(o, 'x');
+            emit_num(o, (uintptr_t)va_arg(ap, void *), 16, 0, 0, &sp);
+            break;
+        case 's':
+            emit_str(o, va_arg(ap, const char *), &sp);
+            break;
+        case 'c':
+            emit(o, (char)va_arg(ap, int));
+            break;
+        case '%':
+            emit(o, '%');
+            break;
+        case '\0':              /* lone % at the end */
+            return;
+        default:                /* unknown: print it as written */
+            emit(o, '%');
+            emit(o, conv);
+            break;
+        }
+    }
+}
+
+int kvsnprintf(char *buf, size_t size, const char *fmt, va_list ap) {
+    out_t o = { buf, size, 0, 0, 0 };
+    format(&o, fmt, ap);
+    if (size)
+        buf[o.len] = '\0';
+    return (int)o.total;
+}
+
+int ksnprintf(char *buf, size_t size, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = kvsnprintf(buf, size, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+int kprintf(const char *fmt, ...) {
+    char buf[KPRINTF_BUF];
+    out_t o = { buf, sizeof(buf), 0, 0, console_write };
+    va_list ap;
+
+    va_start(ap, fmt);
+    format(&o, fmt, ap);
+    va_end(ap);
+    if (o.len)
+        console_write(buf, (uint32_t)o.len);
+    return (int)o.total;
+}
@@ -0,0 +1,41 @@
+/*
+ * kprintf.h — Formatted output for the kernel
+ *
+ * kprintf() formats its arguments in ONE pass into a small buffer on the
+ * stack and hands the finished text to the console with console_write():
+ * one call per sink (on x86 one flush of video memory) for the whole
+ * line, instead of one per character or number.  Output longer than the
+ * buffer is written in buffer-sized chunks.
+ *
+ * ksnprintf() formats into a caller's buffer instead, with C99 snprintf()
+ * semantics: at most size-1 characters plus a NUL, and the return value
+ * is the length the full output WOULD have had.
+ *
+ * CONVERSIONS
+ * ------------
+ *   %d %i      signed decimal          %u        unsigned decimal
+ *   %x %X      hexadecimal             %p        pointer (0x + hex)
+ *   %s         string ("(null)")       %c        character
+ *   %%         a percent sign
+ *
+ * Between the % and the conversion, in this order:
+ *   flags   '-' left-align in the field, '0' pad numbers with zeros
+ *   width   minimum field width, digits or '*' (taken from an int arg)
+ *   length  'l' (long), 'll' (long long, 64-bit), 'z' (size_t)
+ *
+ * Examples:  "%02u:%02u"  →  "07:05"      "%-8s|" →  "help    |"
+ *            "%6u"        →  "    42"     "%08X"  →  "0000BEEF"
+ */
+
+#ifndef KPRINTF_H
+#define KPRINTF_H
+
+#include <stdarg.h>
+#include <stddef.h>
+
+int kprintf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+int ksnprintf(char *buf, size_t size, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+int kvsnprintf(char *buf, size_t size, const char *fmt, va_list ap);
+
+#endif
@@ -0,0 +1,182 @@
+/*
+ * kstring.c — memcpy / memset / memmove for x86
+ *
+ * STRING INSTRUCTIONS
+ * --------------------
+ * x86 has dedicated "string" instructions that loop in microcode:
+ *   REP MOVSD — copy ECX dwords from [ESI] to [EDI]
+ *   REP STOSD — store EAX into ECX dwords at [EDI]
+ *   (MOVSB is the byte version, for the 0–3 byte tail of a copy)
+ * One instruction replaces a whole loop, and the CPU is free to move
+ * whole cache lines internally.  The direction flag (DF) must be clear
+ * so the pointers move upwards; the System V ABI guarantees that on
+ * every function call, and isr_common clears it on interrupt entry.
+ *
+ * SSE2
+ * -----
+ * SSE2 registers (XMM0–7) are 16 bytes wide: MOVDQU loads or stores 16
+ * bytes at any alignment.  Copying 64 bytes per loop iteration with four
+ * registers keeps several loads in flight.  The SSE2 paths are only
+ * taken when:
+ *   - CPUID leaf 1 reports SSE2 (EDX bit 26), and
+ *   - CR4.OSFXSR (bit 9) is set, i.e. the kernel has enabled SSE — with
+ *     it clear, the first SSE instruction raises #UD (invalid opcode).
+ * The helpers carry __attribute__((target("sse2"))) so that the compiler
+ * accepts XMM registers in them while the rest of the kernel is built
+ * without SSE.
+ *
+ * They are not for interrupt handlers, whose XMM0–3 would be the
+ * interrupted task's (fpu.h, RULES), and memcpy() / memset() are called
+ * from everywhere — vga_flush() from a kprintf() in an exception
+ * handler, struct copies the compiler turns into calls.  So the SSE2
+ * paths are also only taken while interrupts are enabled (EFLAGS.IF,
+ * bit 9): the IDT's interrupt gates clear IF on entry, so every handler
+ * runs on the REP path, and so do cli / irq_save() sections.
+ *
+ * Copies and fills shorter than SSE_MIN bytes stay on the REP path,
+ * where the setup cost of the SIMD loop would not pay off.
+ */
+
+#include "kstring.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define SSE_MIN 128
+#define EFLAGS_IF (1u << 9)
+
+static int use_sse2;
+
+void kstring_init(void) {
+    uint32_t eax, ebx, ecx, edx, cr4;
+    __asm__ volatile ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(1));
+    __asm__ volatile ("mov %%cr4, %0" : "=r"(cr4));
+    use_sse2 = (edx & (1u << 26)) && (cr4 & (1u << 9));
+}
+
+const char *kstring_impl(void) {
+    return use_sse2 ? "sse2" : "rep movsd/stosd";
+}
+
+/* ── REP versions ─────────────────────────────────────────────────── */
+
+static void rep_copy(uint8_t *d, const uint8_t *s, size_t n) {
+    size_t dwords = n >> 2;
+    __asm__ volatile ("rep movsl" : "+D"(d), "+S"(s), "+c"(dwords) : : "memory");
+    n &= 3;
+    __asm__ volatile ("rep movsb" : "+D"(d), "+S"(s), "+c"(n) : : "memory");
+}
+
+static void rep_fill(uint8_t *d, uint32_t pattern, size_t n) {
+    size_t dwords = n >> 2;
+    __asm__ volatile ("rep stosl" : "+D"(d), "+c"(dwords) : "a"(pattern) : "memory");
+    /* 0–3 byte tail: continue the pattern byte by byte (for memset16()
+     * the two bytes of a cell differ, so STOSB of AL would be wrong). */
+    for (size_t i = 0; i < (n & 3); i++)
+        d[i] = (uint8_t)(pattern >> (8 * i));
+}
+
+/* ── SSE2 versions (whole 64-byte blocks; the tail goes to REP) ───── */
+
+/* sse2() — Take the SSE2 path for n bytes?  Not below SSE_MIN, and not
+ * with interrupts disabled (see SSE2 above). */
+static int sse2(size_t n) {
+    uint32_t flags;
+    if (!use_sse2 || n < SSE_MIN)
+        return 0;
+    __asm__ volatile ("pushf; pop %0" : "=r"(flags));
+    return (flags & EFLAGS_IF) != 0;
+}
+
+__attribute__((target("sse2")))
+static void sse2_copy(uint8_t *d, const uint8_t *s, size_t blocks) {
+    __asm__ volatile (
+        "1:\n"
+        "movdqu   (%1), %%xmm0\n"
+        "movdqu 16(%1), %%xmm1\n"
+        "movdqu 32(%1), %%xmm2\n"
+        "movdqu 48(%1), %%xmm3\n"
+        "movdqu %%xmm0,   (%0)\n"
+        "movdqu %%xmm1, 16(%0)\n"
+        "movdqu %%xmm2, 32(%0)\n"
+        "movdqu %%xmm3, 48(%0)\n"
+        "add $64, %0\n"
+        "add $64, %1\n"
+        "dec %2\n"
+        "jnz 1b\n"
+        : "+r"(d), "+r"(s), "+r"(blocks)
+        : : "xmm0", "xmm1", "xmm2", "xmm3", "memory", "cc");
+}
+
+__attribute__((target("sse2")))
+static void sse2_fill(uint8_t *d, uint32_t pattern, size_t blocks) {
+    __asm__ volatile (
+        "movd %2, %%xmm0\n"
+        "pshufd $0, %%xmm0, %%xmm0\n"   /* broadcast to all 4 dwords */
+        "1:\n"
+        "movdqu %%xmm0,   (%0)\n"
+        "movdqu %%xmm0, 16(%0)\n"
+        "movdqu %%xmm0, 32(%0)\n"
+        "movdqu %%xmm0, 48(%0)\n"
+        "add $64, %0\n"
+        "dec %1\n"
+        "jnz 1b\n"
+        : "+r"(d), "+r"(blocks)
+        : "r"(pattern)
+        : "xmm0", "memory", "cc");
+}
+
+/* ── Public API ───────────────────────────────────────────────────── */
+
+void *memcpy(void *dst, const void *src, size_t n) {
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+    if (sse2(n)) {
+        size_t bulk = n & ~(size_t)63;
+        sse2_copy(d, s, bulk >> 6);
+        d += bulk; s += bulk; n -= bulk;
+    }
+    rep_copy(d, s, n);
+    return dst;
+}
+
+static void fill(uint8_t *d, uint32_t pattern, size_t n) {
+    if (sse2(n)) {
+        size_t bulk = n & ~(size_t)63;
+        sse2_fill(d, pattern, bulk >> 6);
+        d += bulk; n -= bulk;
+    }
+    rep_fill(d, pattern, n);
+}
+
+void *memset(void *dst, int c, size_t n) {
+    fill(dst, 0x01010101u * (uint8_t)c, n);
+    return dst;
+}
+
+void memset16(uint16_t *dst, uint16_t v, size_t n) {
+    fill((uint8_t *)dst, ((uint32_t)v << 16) | v, n * 2);
+}
+
+/*
+ * memmove() — Like memcpy(), but the regions may overlap.  Copying
+ * upwards is only wrong when dst lies inside [src, src + n); then copy
+ * downwards, with the direction flag set for the duration.
+ */
+void *memmove(void *dst, const void *src, size_t n) {
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+    if (d <= s || d >= s + n)
+        return memcpy(dst, src, n);
+
+    d += n - 1;
+    s += n - 1;
+    __asm__ volatile ("std; rep movsb; cld" : "+D"(d), "+S"(s), "+c"(n) : : "memory");
+    return dst;
+}
+
+int memcmp(const void *a, const void *b, size_t n) {
+    const uint8_t *p = a, *q = b;
+    for (; n; n--, p++, q++)
+        if (*p != *q) return *p - *q;
+    return 0;
+}
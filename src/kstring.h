@@ -0,0 +1,55 @@
+/*
+ * kstring.h — Freestanding memory primitives
+ *
+ * -nostdlib leaves the kernel without memcpy() and friends, but it still
+ * needs them: for its own bulk copies, and because GCC may emit calls to
+ * memcpy / memset / memmove for large structure copies and
+ * initialisations even with -ffreestanding.  These are the kernel's own,
+ * with the usual C semantics.
+ *
+ * Each platform has a baseline version plus a SIMD version chosen once
+ * by kstring_init(), after checking that the CPU has the instructions
+ * AND that the kernel has enabled them (using SSE/NEON while disabled
+ * raises an exception):
+ *
+ *   x86  (kstring.c)      : REP MOVSD / REP STOSD, or SSE2 16-byte moves
+ *                           when CPUID reports SSE2 and CR4.OSFXSR is set
+ *   RPi3 (kstring_rpi3.c) : 16-byte LDP/STP, or NEON 32-byte moves when
+ *                           CPACR_EL1 enables FP/SIMD; large zero fills
+ *                           use DC ZVA (zero a whole cache block)
+ */
+
+#ifndef KSTRING_H
+#define KSTRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* kstring_init() — Pick the fastest variants this CPU allows.  Safe to
+ * call again after enabling FP/SIMD.  Until then the baseline runs. */
+void kstring_init(void);
+
+/* kstring_impl() — Name of the selected variant, e.g. "sse2". */
+const char *kstring_impl(void);
+
+void *memcpy(void *dst, const void *src, size_t n);
+void *memmove(void *dst, const void *src, size_t n);
+void *memset(void *dst, int c, size_t n);
+int   memcmp(const void *a, const void *b, size_t n);
+
+/* memset16() — Fill n 16-bit cells with v (e.g. VGA character cells). */
+void  memset16(uint16_t *dst, uint16_t v, size_t n);
+
+/* String functions: short strings only, no SIMD variant worth having. */
+static inline size_t strlen(const char *s) {
+    const char *p = s;
+    while (*p) p++;
+    return (size_t)(p - s);
+}
+
+static inline int strcmp(const char *a, const char *b) {
+    while (*a && *a == *b) { a++; b++; }
+    return (uint8_t)*a - (uint8_t)*b;
+}
+
+#endif
@@ -0,0 +1,189 @@
+/*
+ * kstring_rpi3.c — memcpy / memset / memmove for AArch64
+ *
+ * BASELINE: LDP / STP
+ * --------------------
+ * AArch64 has no string instructions like x86's REP MOVS.  The fastest
+ * plain-integer loop moves 16 bytes per instruction with LDP / STP (load
+ * / store a PAIR of 64-bit registers).  Unaligned accesses are allowed on
+ * Normal memory, i.e. once the MMU is on (mmu_rpi3.c) — boot_rpi3.S only
+ * calls memset() for the BSS after mmu_init().
+ *
+ * NEON
+ * -----
+ * The 128-bit NEON registers Q0–Q31 move 32 bytes per LDP / STP pair.
+ * They are only usable once CPACR_EL1.FPEN allows FP/SIMD at EL1;
+ * before that, any FP/SIMD instruction traps.  kstring_init() checks
+ * ID_AA64PFR0_EL1.AdvSIMD (bits [23:20], 0xF = not implemented) and
+ * FPEN (CPACR_EL1 bits [21:20] = 0b11).
+ *
+ * The kernel is compiled with -mgeneral-regs-only; neon_copy() and
+ * neon_fill() carry __attribute__((target("+simd"))) so that they alone
+ * may name the V registers.  They are not for interrupt handlers, whose
+ * Q0/Q1 would be the interrupted task's (fpu.h, RULES): memcpy() and
+ * memset() take them only while IRQs are unmasked (DAIF.I, bit 7,
+ * clear), which a handler never is.  With IRQs masked — a handler, an
+ * irq_save() section, the boot path, cores 1–3 — they use LDP / STP.
+ *
+ * DC ZVA
+ * -------
+ * "Data Cache Zero by VA" zeroes one whole block (64 bytes on the
+ * Cortex-A53) in the cache, without first reading it from RAM — ideal for
+ * clearing large buffers and the BSS.  DCZID_EL0 says whether it is
+ * allowed (bit 4 = DZP, 1 = prohibited) and the block size (bits [3:0] =
+ * log2 of the size in 4-byte words).  The address must be block-aligned,
+ * so the unaligned head and tail are done with ordinary stores.  It is
+ * only valid on Normal memory, which all RAM is once the MMU is on.
+ *
+ * The selection flags live in .data, not .bss: memset() clears the BSS,
+ * so it must not depend on BSS contents itself.
+ */
+
+#include "kstring.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define NEON_MIN 64
+#define DAIF_I   (1u << 7)
+
+static int      use_neon __attribute__((section(".data")));
+static uint32_t zva_size __attribute__((section(".data")));   /* 0 = none */
+
+void kstring_init(void) {
+    uint64_t pfr0, cpacr, dczid;
+    __asm__ volatile ("mrs %0, id_aa64pfr0_el1" : "=r"(pfr0));
+    __asm__ volatile ("mrs %0, cpacr_el1" : "=r"(cpacr));
+    __asm__ volatile ("mrs %0, dczid_el0" : "=r"(dczid));
+
+    use_neon = ((pfr0 >> 20) & 0xF) != 0xF && ((cpacr >> 20) & 3) == 3;
+    zva_size = (dczid & (1 << 4)) ? 0 : 4u << (dczid & 0xF);
+}
+
+const char *kstring_impl(void) {
+    if (use_neon) return zva_size ? "neon + dc zva" : "neon";
+    return zva_size ? "ldp/stp + dc zva" : "ldp/stp";
+}
+
+/* neon() — Take the NEON path for n bytes?  Not below NEON_MIN, and not
+ * with IRQs masked (see NEON above). */
+static int neon(size_t n) {
+    uint64_t daif;
+    if (!use_neon || n < NEON_MIN)
+        return 0;
+    __asm__ volatile ("mrs %0, daif" : "=r"(daif));
+    return !(daif & DAIF_I);
+}
+
+/* ── Copy ─────────────────────────────────────────────────────────── */
+
+__attribute__((target("+simd")))
+static void neon_copy(uint8_t *d, const uint8_t *s, size_t blocks) {
+    __asm__ volatile (
+        "1:\n"
+        "ldp q0, q1, [%1], #32\n"
+        "stp q0, q1, [%0], #32\n"
+        "subs %2, %2, #1\n"
+        "b.ne 1b\n"
+        : "+r"(d), "+r"(s), "+r"(blocks)
+        : : "v0", "v1", "memory", "cc");
+}
+
+void *memcpy(void *dst, const void *src, size_t n) {
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+
+    if (neon(n)) {
+        size_t bulk = n & ~(size_t)31;
+        neon_copy(d, s, bulk >> 5);
+        d += bulk; s += bulk; n -= bulk;
+    }
+    for (; n >= 16; n -= 16, d += 16, s += 16) {
+        uint64_t a, b;
+        __asm__ volatile ("ldp %0, %1, [%2]" : "=r"(a), "=r"(b) : "r"(s) : "memory");
+        __asm__ volatile ("stp %0, %1, [%2]" : : "r"(a), "r"(b), "r"(d) : "memory");
+    }
+    while (n--)
+        *d++ = *s++;
+    return dst;
+}
+
+/* memmove() — Overlapping regions: copy downwards when dst is inside
+ * [src, src + n), otherwise forwards like memcpy(). */
+void *memmove(void *dst, const void *src, size_t n) {
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+    if (d <= s || d >= s + n)
+        return memcpy(dst, src, n);
+
+    d += n;
+    s += n;
+    for (; n >= 8; n -= 8) {
+        d -= 8; s -= 8;
+        uint64_t v;
+        __asm__ volatile ("ldr %0, [%1]" : "=r"(v) : "r"(s) : "memory");
+        __asm__ volatile ("str %0, [%1]" : : "r"(v), "r"(d) : "memory");
+    }
+    while (n--)
+        *--d = *--s;
+    return dst;
+}
+
+/* ── Fill ─────────────────────────────────────────────────────────── */
+
+__attribute__((target("+simd")))
+static void neon_fill(uint8_t *d, uint64_t pattern, size_t blocks) {
+    __asm__ volatile (
+        "dup v0.2d, %2\n"
+        "1:\n"
+        "stp q0, q0, [%0], #32\n"
+        "subs %1, %1, #1\n"
+        "b.ne 1b\n"
+        : "+r"(d), "+r"(blocks)
+        : "r"(pattern)
+        : "v0", "memory", "cc");
+}
+
+/* fill() — Store the 8-byte pattern repeatedly; byte i of the region
+ * gets byte (i mod 8) of the pattern. */
+static void fill(uint8_t *d, uint64_t pattern, size_t n) {
+    if (neon(n)) {
+        size_t bulk = n & ~(size_t)31;
+        neon_fill(d, pattern, bulk >> 5);
+        d += bulk; n -= bulk;
+    }
+    for (; n >= 16; n -= 16, d += 16)
+        __asm__ volatile ("stp %0, %0, [%1]" : : "r"(pattern), "r"(d) : "memory");
+    for (size_t i = 0; i < n; i++)
+        d[i] = (uint8_t)(pattern >> (8 * (i & 7)));
+}
+
+/* zero_zva() — Zero [d, d + n) with DC ZVA for the aligned middle. */
+static void zero_zva(uint8_t *d, size_t n) {
+    uintptr_t mask = zva_size - 1;
+    size_t head = (zva_size - ((uintptr_t)d & mask)) & mask;
+
+    fill(d, 0, head);
+    d += head; n -= head;
+    for (; n >= zva_size; n -= zva_size, d += zva_size)
+        __asm__ volatile ("dc zva, %0" : : "r"(d) : "memory");
+    fill(d, 0, n);
+}
+
+void *memset(void *dst, int c, size_t n) {
+    if (c == 0 && zva_size && n >= 2 * (size_t)zva_size)
+        zero_zva(dst, n);
+    else
+        fill(dst, 0x0101010101010101ULL * (uint8_t)c, n);
+    return dst;
+}
+
+void memset16(uint16_t *dst, uint16_t v, size_t n) {
+    fill((uint8_t *)dst, 0x0001000100010001ULL * v, n * 2);
+}
+
+int memcmp(const void *a, const void *b, size_t n) {
+    const uint8_t *p = a, *q = b;
+    for (; n; n--, p++, q++)
+        if (*p != *q) return *p - *q;
+    return 0;
+}
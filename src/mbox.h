@@ -0,0 +1,47 @@
+/*
+ * mbox.h — VideoCore mailbox property interface (RPi3)
+ *
+ * On the Raspberry Pi the GPU firmware, not the ARM, owns much of the
+ * hardware: it knows how the RAM is split between ARM and GPU, sets up
+ * the HDMI framebuffer, controls clocks and power domains, and so on.
+ * The ARM asks for these services by passing a message to it through
+ * the mailbox (mbox_rpi3.c).
+ *
+ * A property message is an array of 32-bit words, 16-byte aligned:
+ *
+ *   [0]  total size in bytes
+ *   [1]  0 = request; the firmware replies 0x80000000 = success
+ *   [2…] tags: { tag id, value buffer size, request/response code,
+ *                value buffer … }
+ *   […]  0 = end tag
+ *
+ * The firmware writes its answers into the same buffer.
+ */
+
+#ifndef MBOX_H
+#define MBOX_H
+
+#include <stdint.h>
+
+#define MBOX_REQUEST          0x00000000
+#define MBOX_RESPONSE_OK      0x80000000
+#define MBOX_TAG_END          0x00000000
+#define MBOX_TAG_ARM_MEMORY   0x00010005  /* → base, size of ARM RAM */
+
+/* Framebuffer tags (fb_rpi3.c).  The "set" tags answer with the value
+ * the firmware actually chose, which may differ from the one asked. */
+#define MBOX_TAG_FB_ALLOC     0x00040001  /* alignment → bus address, size */
+#define MBOX_TAG_FB_PITCH     0x00040008  /* → bytes per pixel row         */
+#define MBOX_TAG_FB_PHYS_WH   0x00048003  /* width, height on the screen   */
+#define MBOX_TAG_FB_VIRT_WH   0x00048004  /* width, height in memory       */
+#define MBOX_TAG_FB_DEPTH     0x00048005  /* bits per pixel                */
+#define MBOX_TAG_FB_ORDER     0x00048006  /* 0 = BGR, 1 = RGB              */
+#define MBOX_TAG_FB_OFFSET    0x00048009  /* x, y of the screen in memory  */
+
+/* mbox_property() — Send a property message and wait for the reply.
+ * msg must be 16-byte aligned and should not share a 64-byte cache line
+ * with other data: cache maintenance on it writes back whole lines.
+ * Returns 1 if the firmware answered with MBOX_RESPONSE_OK, 0 otherwise. */
+int mbox_property(volatile uint32_t *msg);
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ * mbox_rpi3.c — VideoCore mailbox 0 (RPi3)
+ *
+ * Mailbox 0 registers (base 0x3F00B880):
+ *   0x00  READ    — next message from the GPU
+ *   0x18  STATUS  — bit 31 FULL (cannot write), bit 30 EMPTY (nothing to read)
+ *   0x20  WRITE   — message to the GPU
+ *
+ * A message is one 32-bit word: the buffer address with the channel
+ * number in its low 4 bits — hence the 16-byte alignment.  Channel 8 is
+ * the "property tags, ARM to VideoCore" channel.
+ *
+ * BUS ADDRESSES AND CACHES
+ * -------------------------
+ * The GPU sees the RAM through its own bus, where 0xC0000000 is an alias
+ * of physical address 0 that bypasses the GPU's L2 cache.  The ARM data
+ * cache is on (mmu_rpi3.c), and the GPU cannot see into it, so the
+ * buffer is cleaned to RAM before the request and invalidated again
+ * before the answer is read.
+ */
+
+#include "mbox.h"
+#include <stdint.h>
+
+#define MBOX_READ    ((volatile uint32_t *)0x3F00B880UL)
+#define MBOX_STATUS  ((volatile uint32_t *)0x3F00B898UL)
+#define MBOX_WRITE   ((volatile uint32_t *)0x3F00B8A0UL)
+
+#define MBOX_FULL    (1u << 31)
+#define MBOX_EMPTY   (1u << 30)
+#define MBOX_CH_PROP 8
+
+#define BUS_ALIAS    0xC0000000u
+#define CACHE_LINE   64
+
+/* dcache_flush() — Write back and invalidate [p, p + len). */
+static void dcache_flush(volatile void *p, uint32_t len) {
+    uintptr_t a   = (uintptr_t)p & ~(uintptr_t)(CACHE_LINE - 1);
+    uintptr_t end = (uintptr_t)p + len;
+    for (; a < end; a += CACHE_LINE)
+        __asm__ volatile ("dc civac, %0" : : "r"(a) : "memory");
+    __asm__ volatile ("dsb sy" ::: "memory");
+}
+
+int mbox_property(volatile uint32_t *msg) {
+    uint32_t word = ((uint32_t)(uintptr_t)msg | BUS_ALIAS) | MBOX_CH_PROP;
+
+    dcache_flush(msg, msg[0]);
+    while (*MBOX_STATUS & MBOX_FULL)
+        ;
+    *MBOX_WRITE = word;
+
+    for (;;) {
+        while (*MBOX_STATUS & MBOX_EMPTY)
+            ;
+        if (*MBOX_READ == word)     /* replies of other channels: skip */
+            break;
+    }
+    dcache_flush(msg, msg[0]);
+    return msg[1] == MBOX_RESPONSE_OK;
+}
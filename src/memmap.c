@@ -0,0 +1,159 @@
+/*
+ * memmap.c — RAM detection from the Multiboot information structure (x86)
+ *
+ * Because boot_x86.asm sets bit 1 (MEMORY_INFO) in the Multiboot header
+ * flags, the boot loader passes in EBX a pointer to an information
+ * structure describing the machine's memory.  The fields used here:
+ *
+ *   offset  field        valid if info flag …
+ *    0      flags        —
+ *    4      mem_lower    bit 0   KB of RAM below 1 MB
+ *    8      mem_upper    bit 0   KB of RAM from 1 MB to the first hole
+ *   20      mods_count   bit 3   number of boot modules
+ *   24      mods_addr    bit 3   address of the module list
+ *   44      mmap_length  bit 6   size of the memory map in bytes
+ *   48      mmap_addr    bit 6   address of the memory map
+ *
+ * The memory map (what the BIOS call INT 15h / E820 reports) is a list
+ * of variable-size entries:
+ *
+ *   uint32_t size;     size of the rest of this entry (usually 20)
+ *   uint64_t addr;     start of the range
+ *   uint64_t len;      length of the range
+ *   uint32_t type;     1 = available RAM, anything else = reserved
+ *
+ * The map may live anywhere in low memory, even in pages the allocator
+ * is about to use, so the entries are copied out before pmm_init().
+ *
+ * BOOT MODULES
+ * -------------
+ * Files given to the loader next to the kernel (QEMU -initrd, GRUB's
+ * `module`) are loaded into RAM the map still calls available, usually
+ * right after the kernel image.  The module list gives each one as
+ *
+ *   uint32_t mod_start, mod_end;   [start, end) in memory
+ *   uint32_t string;               its command line
+ *   uint32_t reserved;
+ *
+ * memmap_detect() cuts every module out of the RAM regions, so that the
+ * page allocator never hands their pages out; the first one is the
+ * initial RAM disk (initrd.h).
+ */
+
+#include "pmm.h"
+#include <stdint.h>
+
+#define MULTIBOOT_BOOTLOADER_MAGIC 0x2BADB002
+
+#define MBI_FLAG_MEM   (1u << 0)
+#define MBI_FLAG_MODS  (1u << 3)
+#define MBI_FLAG_MMAP  (1u << 6)
+
+typedef struct {
+    uint32_t flags;
+    uint32_t mem_lower;
+    uint32_t mem_upper;
+    uint32_t boot_device;
+    uint32_t cmdline;
+    uint32_t mods_count;
+    uint32_t mods_addr;
+    uint32_t syms[4];
+    uint32_t mmap_length;
+    uint32_t mmap_addr;
+} __attribute__((packed)) multiboot_info_t;
+
+typedef struct {
+    uint32_t mod_start;
+    uint32_t mod_end;
+    uint32_t string;
+    uint32_t reserved;
+} __attribute__((packed)) multiboot_mod_t;
+
+typedef struct {
+    uint32_t size;
+    uint64_t addr;
+    uint64_t len;
+    uint32_t type;
+} __attribute__((packed)) multiboot_mmap_t;
+
+/* mods() — The module list, or NULL; *count is set to its length. */
+static const multiboot_mod_t *mods(uintptr_t boot_magic, uintptr_t boot_info,
+                                   uint32_t *count) {
+    const multiboot_info_t *mbi = (const multiboot_info_t *)boot_info;
+
+    *count = 0;
+    if (boot_magic != MULTIBOOT_BOOTLOADER_MAGIC || !mbi ||
+        !(mbi->flags & MBI_FLAG_MODS) || !mbi->mods_addr)
+        return 0;
+    *count = mbi->mods_count;
+    return (const multiboot_mod_t *)(uintptr_t)mbi->mods_addr;
+}
+
+/* exclude() — Remove [lo, hi) from the n regions of ram[]; a region
+ * with the range in its middle becomes two.  Returns the new count. */
+static unsigned exclude(mem_region_t *ram, unsigned n, unsigned max,
+                        uint64_t lo, uint64_t hi) {
+    for (unsigned i = 0; i < n; i++) {
+        uint64_t start = ram[i].base, end = ram[i].base + ram[i].len;
+        if (hi <= start || lo >= end)
+            continue;
+        if (lo > start && hi < end && n < max) {
+            ram[n].base = hi;               /* the part above: new entry */
+            ram[n].len  = end - hi;
+            n++;
+            end = lo;
+        } else if (lo > start) {
+            end = lo;
+        } else {
+            start = hi < end ? hi : end;
+        }
+        ram[i].base = start;
+        ram[i].len  = end - start;
+    }
+    return n;
+}
+
+unsigned memmap_detect(uintptr_t boot_magic, uintptr_t boot_info,
+                       mem_region_t *ram, unsigned max) {
+    const multiboot_info_t *mbi = (const multiboot_info_t *)boot_info;
+    unsigned n = 0;
+
+    if (boot_magic != MULTIBOOT_BOOTLOADER_MAGIC || !mbi)
+        return 0;
+
+    if (mbi->flags & MBI_FLAG_MMAP) {
+        uintptr_t p   = mbi->mmap_addr;
+        uintptr_t end = p + mbi->mmap_length;
+        while (p < end && n < max) {
+            const multiboot_mmap_t *e = (const multiboot_mmap_t *)p;
+            if (e->type == 1 && e->len) {
+                ram[n].base = e->addr;
+                ram[n].len  = e->len;
+                n++;
+            }
+            p += e->size + sizeof(e->size);
+        }
+    } else if (mbi->flags & MBI_FLAG_MEM) {
+        /* No map: assume one block of mem_upper KB starting at 1 MB. */
+        ram[0].base = 0x100000;
+        ram[0].len  = (uint64_t)mbi->mem_upper * 1024;
+        n = 1;
+    }
+
+    uint32_t count;
+    const multiboot_mod_t *m = mods(boot_magic, boot_info, &count);
+    for (uint32_t i = 0; i < count; i++)
+        n = exclude(ram, n, max, m[i].mod_start, m[i].mod_end);
+    return n;
+}
+
+int memmap_module(uintptr_t boot_magic, uintptr_t boot_info, mem_region_t *mod) {
+    uint32_t count;
+    const multiboot_mod_t *m = mods(boot_magic, boot_info, &count);
+
+    if (!count || m[0].mod_end < m[0].mod_start)
+        return 0;
+    mod->base = m[0].mod_start;
+    mod->len  = m[0].mod_end - m[0].mod_start;
+    return 1;
+}
@@ -0,0 +1,58 @@
+/*
+ * memmap_rpi3.c — RAM detection through the VideoCore firmware (RPi3)
+ *
+ * The Pi 3 has 1 GB of SDRAM shared between the ARM and the GPU.  The
+ * split is set by gpu_mem= in config.txt, so the only reliable source is
+ * the firmware itself: the "get ARM memory" mailbox property returns the
+ * base and size of the part that belongs to the ARM (e.g. 0 and
+ * 0x3C000000 with the default 64 MB for the GPU).
+ *
+ * The firmware (or QEMU) also passes a device tree address in x0, which
+ * carries the same information; the mailbox needs no parser.
+ *
+ * There are no boot modules either: memmap_module() returns the initrd
+ * archive linked into the image (initrd_rpi3.S), which lies below
+ * __kernel_end and so is never in the pmm's way.
+ */
+
+#include "pmm.h"
+#include "mbox.h"
+#include <stdint.h>
+
+unsigned memmap_detect(uintptr_t boot_magic, uintptr_t boot_info,
+                       mem_region_t *ram, unsigned max) {
+    /* A whole cache line of its own: see mbox.h. */
+    static volatile uint32_t msg[16] __attribute__((aligned(64)));
+
+    (void)boot_magic;
+    (void)boot_info;
+    if (max == 0)
+        return 0;
+
+    msg[0] = 8 * sizeof(uint32_t);
+    msg[1] = MBOX_REQUEST;
+    msg[2] = MBOX_TAG_ARM_MEMORY;
+    msg[3] = 8;                     /* value buffer: 2 words */
+    msg[4] = 0;
+    msg[5] = 0;                     /* ← base */
+    msg[6] = 0;                     /* ← size */
+    msg[7] = MBOX_TAG_END;
+
+    if (!mbox_property(msg) || msg[6] == 0)
+        return 0;
+    ram[0].base = msg[5];
+    ram[0].len  = msg[6];
+    return 1;
+}
+
+extern const char __initrd_start[], __initrd_end[];     /* initrd_rpi3.S */
+
+int memmap_module(uintptr_t boot_magic, uintptr_t boot_info, mem_region_t *mod) {
+    (void)boot_magic;
+    (void)boot_info;
+    if (__initrd_end == __initrd_start)
+        return 0;
+    mod->base = (uintptr_t)__initrd_start;
+    mod->len  = (uintptr_t)(__initrd_end - __initrd_start);
+    return 1;
+}
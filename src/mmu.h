@@ -0,0 +1,28 @@
+/*
+ * mmu.h — AArch64 MMU and cache enable (RPi3)
+ *
+ * With the EL1 MMU off, every data access is treated as Device memory:
+ * nothing is cached, stores are not merged, and the exclusive
+ * load/store pairs behind __atomic operations are not guaranteed to work
+ * between cores.  mmu_rpi3.c identity-maps the address space (virtual
+ * address = physical address) so that the kernel does not need to be
+ * relinked, and turns on the data and instruction caches.
+ *
+ * x86 keeps paging off: in protected mode without paging, RAM is already
+ * cached write-back and the VGA window is uncached by the MTRRs.
+ */
+
+#ifndef MMU_H
+#define MMU_H
+
+/* mmu_init() — Build the page tables, then mmu_enable().  Called from
+ * boot_rpi3.S on core 0, BEFORE the BSS is zeroed: it must not rely on
+ * zero-initialised globals. */
+void mmu_init(void);
+
+/* mmu_enable() — Load the tables built by mmu_init() into this core
+ * and turn on the MMU and caches.  Cores 1–3 call it from
+ * secondary_entry before any shared data is touched. */
+void mmu_enable(void);
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ * mmu_rpi3.c — Identity-mapped page tables, MMU and caches (RPi3)
+ *
+ * WHY TURN ON THE MMU?
+ * ---------------------
+ * The MMU is not only about virtual memory.  On AArch64 memory TYPES come
+ * from the page tables: with the MMU off, all data accesses are Device
+ * accesses — uncached, in order, one bus transaction each.  Every load
+ * and store to RAM then pays the full DRAM latency.  Turning the MMU on
+ * with a plain identity map lets RAM be Normal, write-back cached memory
+ * while the peripherals stay Device memory.
+ *
+ * TRANSLATION SETUP
+ * ------------------
+ * 4 KB granule, 32-bit virtual addresses (TCR_EL1.T0SZ = 32), so the walk
+ * starts at level 1 where each entry covers 1 GB.  Only TTBR0 is used.
+ *
+ *   L1[0]  0x00000000–0x3FFFFFFF  → L2 table, 512 × 2 MB blocks:
+ *            0x00000000–0x3EFFFFFF  Normal, write-back, inner shareable
+ *            0x3F000000–0x3FFFFFFF  Device-nGnRE (BCM2837 peripherals)
+ *   L1[1]  0x40000000–0x7FFFFFFF  1 GB Device block (ARM local registers)
+ *   L1[2…] unmapped — an access there faults instead of hitting garbage
+ *
+ * 2 MB and 1 GB BLOCK descriptors map a whole region with a single entry,
+ * so two 4 KB tables cover everything and the TLB needs very few entries.
+ *
+ * MEMORY ATTRIBUTES (MAIR_EL1)
+ * -----------------------------
+ * A descriptor does not hold the memory type itself, only an index into
+ * MAIR_EL1, which holds eight 8-bit attribute encodings:
+ *   index 0 = 0x04  Device-nGnRE: no gathering, no reordering, early
+ *                   write acknowledgement — what MMIO registers need
+ *   index 1 = 0xFF  Normal memory, inner and outer write-back,
+ *                   read- and write-allocate
+ *
+ * "Inner shareable" RAM is kept coherent between the four cores by the
+ * hardware, which the SMP job queue (smp_rpi3.c) relies on.
+ *
+ * The page tables live in their own NOLOAD .pgtbl section, outside the
+ * BSS: mmu_init() runs before boot_rpi3.S zeroes the BSS, and that loop
+ * must not erase live tables.
+ */
+
+#include "mmu.h"
+#include <stdint.h>
+
+#define PERIPH_BASE   0x3F000000UL
+#define BLOCK_2M      0x200000UL
+
+/* Descriptor bits */
+#define DESC_BLOCK    0x1UL             /* level 1/2 block              */
+#define DESC_TABLE    0x3UL             /* next-level table             */
+#define ATTR_DEVICE   (0UL << 2)        /* AttrIndx = 0                 */
+#define ATTR_NORMAL   (1UL << 2)        /* AttrIndx = 1                 */
+#define SH_INNER      (3UL << 8)        /* inner shareable              */
+#define AF            (1UL << 10)       /* access flag: already accessed */
+#define PXN           (1UL << 53)       /* no execution at EL1          */
+#define UXN           (1UL << 54)       /* no execution at EL0          */
+
+#define NORMAL_BLOCK  (DESC_BLOCK | ATTR_NORMAL | SH_INNER | AF)
+#define DEVICE_BLOCK  (DESC_BLOCK | ATTR_DEVICE | AF | PXN | UXN)
+
+#define MAIR_VALUE    0xFF04UL          /* attr1 = 0xFF, attr0 = 0x04   */
+
+/* TCR_EL1: T0SZ = 32, walks cached (IRGN0/ORGN0 = write-back),
+ * SH0 = inner shareable, TG0 = 4 KB, EPD1 = 1 (no TTBR1 walks),
+ * IPS = 0 (32-bit physical addresses). */
+#define TCR_VALUE     (32UL | (1UL << 8) | (1UL << 10) | (3UL << 12) | (1UL << 23))
+
+#define SCTLR_M       (1UL << 0)        /* MMU enable                   */
+#define SCTLR_C       (1UL << 2)        /* data cache enable            */
+#define SCTLR_I       (1UL << 12)       /* instruction cache enable     */
+
+static uint64_t l1_table[512] __attribute__((aligned(4096), section(".pgtbl")));
+static uint64_t l2_table[512] __attribute__((aligned(4096), section(".pgtbl")));
+
+void mmu_init(void) {
+    for (uint64_t i = 0; i < 512; i++) {
+        uint64_t addr = i * BLOCK_2M;
+        l2_table[i] = addr | (addr < PERIPH_BASE ? NORMAL_BLOCK : DEVICE_BLOCK);
+    }
+
+    /* One loop for all of L1 (rather than a zeroing loop), so the
+     * compiler cannot turn it into a memset() call we do not have. */
+    for (int i = 0; i < 512; i++)
+        l1_table[i] = i == 0 ? (uint64_t)(uintptr_t)l2_table | DESC_TABLE
+                    : i == 1 ? 0x40000000UL | DEVICE_BLOCK
+                    : 0;
+
+    mmu_enable();
+}
+
+void mmu_enable(void) {
+    uint64_t sctlr;
+
+    __asm__ volatile (
+        "msr mair_el1, %0\n"
+        "msr tcr_el1, %1\n"
+        "msr ttbr0_el1, %2\n"
+        /* The tables were written with the caches off: make sure the
+         * stores are complete and no stale translation is cached. */
+        "dsb ish\n"
+        "tlbi vmalle1\n"
+        "dsb ish\n"
+        "isb\n"
+        : : "r"(MAIR_VALUE), "r"(TCR_VALUE), "r"((uint64_t)(uintptr_t)l1_table)
+        : "memory");
+
+    __asm__ volatile ("mrs %0, sctlr_el1" : "=r"(sctlr));
+    sctlr |= SCTLR_M | SCTLR_C | SCTLR_I;
+    __asm__ volatile ("msr sctlr_el1, %0; isb" : : "r"(sctlr) : "memory");
+}
@@ -0,0 +1,54 @@
+/*
+ * phash.h — String hash shared by the kernel and tools/mkhash.c
+ *
+ * PERFECT HASHING
+ * ----------------
+ * When every key is known in advance — the shell's command names, the
+ * colour names — a hash function can be chosen so that no two keys
+ * collide.  Looking a word up then costs one hash, one table read and
+ * one string comparison (to reject words that are not keys), whatever
+ * the number of keys.
+ *
+ * The function here is 32-bit FNV-1a, started from a SEED:
+ *
+ *     slot = fnv1a(seed, word) & (size - 1)
+ *
+ * At build time tools/mkhash.c tries seeds 0, 1, 2, … until all keys land
+ * in different slots of a power-of-two table at least twice as large as
+ * the key count, and writes the winning seed and size to the generated
+ * header shell_hash.h (see the Makefile).  This file is included by both
+ * sides so that they can never disagree.
+ *
+ * FNV-1a: for each byte, h ^= byte, then h *= 16777619 (the FNV prime).
+ * A multiplication only carries upwards, so the LOW bits of the result
+ * depend on the low bits of the input alone — and those are the ones the
+ * slot mask keeps.  The final shift-xor-multiply (the "fmix" step of
+ * MurmurHash3) folds the high bits back down.
+ */
+
+#ifndef PHASH_H
+#define PHASH_H
+
+#include <stdint.h>
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME  16777619u
+
+static inline uint32_t phash(uint32_t seed, const char *s) {
+    uint32_t h = FNV_OFFSET ^ (seed * FNV_PRIME);
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= FNV_PRIME;
+    }
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    return h;
+}
+
+/* phash_slot() — Table index of s; size must be a power of two. */
+static inline uint32_t phash_slot(uint32_t seed, uint32_t size, const char *s) {
+    return phash(seed, s) & (size - 1);
+}
+
+#endif
@@ -0,0 +1,216 @@
+/*
+ * pmm.c — Buddy page-frame allocator (both platforms)
+ *
+ * THE BUDDY SYSTEM
+ * -----------------
+ * Memory is managed in blocks of 2^order pages, each aligned to its own
+ * size.  Every block of order k has exactly one BUDDY: the other half of
+ * the order k+1 block it was split from.  Its page number differs in a
+ * single bit, so it is found with one XOR:
+ *
+ *     buddy = page ^ (1 << order)
+ *
+ *   order 2:  [ 0  1  2  3 ][ 4  5  6  7 ]     buddies: 0–3 and 4–7
+ *   order 1:  [ 0  1 ][ 2  3 ]                 buddies: 0–1 and 2–3
+ *
+ * One free list per order.  To allocate order k, take a block from the
+ * smallest non-empty list of order ≥ k and split it in halves, putting
+ * the upper half back on the list below each time, until it is of order
+ * k.  To free, check whether the buddy is free and of the same order; if
+ * so, unlink it and merge, then try again one order up.  Both loops run
+ * at most PMM_MAX_ORDER times: O(log n), with no searching.
+ *
+ * BOOKKEEPING
+ * ------------
+ * A free block stores its list links in its own first bytes, so free
+ * memory costs nothing.  One state byte per page says whether that page
+ * starts a free block, and of which order — that is how the buddy test
+ * is answered without walking any list.  The state array is placed right
+ * after the kernel image (__kernel_end, from the linker script): 1 byte
+ * per 4 KB, e.g. 32 KB for 128 MB of RAM — or, if a boot module lies
+ * there, in the first RAM above the kernel that has room for it.
+ *
+ * Page numbers are counted from `base`, the end of the kernel rounded
+ * DOWN to a 4 MB boundary, so that blocks are aligned to their size in
+ * physical memory too.  Pages in that span that are not RAM, or hold the
+ * kernel or the state array, are simply never freed.
+ */
+
+#include "pmm.h"
+#include "kstring.h"
+#include "irq.h"
+#include <stdint.h>
+
+#define MAX_BLOCK    (PAGE_SIZE << PMM_MAX_ORDER)
+
+#define STATE_FREE   0x80           /* page starts a free block         */
+#define STATE_ORDER  0x0F           /* ... of this order                */
+/* 0 = allocated, reserved or inside a larger free block */
+
+typedef struct free_block {
+    struct free_block *next;
+    struct free_block *prev;
+} free_block_t;
+
+extern char __kernel_end[];         /* linker script */
+
+static uintptr_t     base;          /* address of page 0                 */
+static uint32_t      npages;        /* pages in [base, end of RAM)       */
+static uint8_t      *state;         /* npages state bytes                */
+static free_block_t *free_list[PMM_MAX_ORDER + 1];
+static uint32_t      total_pages, free_pages;
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+static uint32_t page_of(const void *p) {
+    return (uint32_t)(((uintptr_t)p - base) / PAGE_SIZE);
+}
+
+static free_block_t *block_at(uint32_t page) {
+    return (free_block_t *)(base + (uintptr_t)page * PAGE_SIZE);
+}
+
+static void list_push(unsigned order, uint32_t page) {
+    free_block_t *b = block_at(page);
+    b->prev = 0;
+    b->next = free_list[order];
+    if (b->next) b->next->prev = b;
+    free_list[order] = b;
+    state[page] = STATE_FREE | order;
+}
+
+static void list_remove(unsigned order, free_block_t *b) {
+    if (b->prev) b->prev->next = b->next;
+    else         free_list[order] = b->next;
+    if (b->next) b->next->prev = b->prev;
+    state[page_of(b)] = 0;
+}
+
+/* ── Allocation ───────────────────────────────────────────────────── */
+
+/*
+ * The lists are shared by every task: a switch in the middle of a split
+ * or a merge would leave them broken, so both run with interrupts off.
+ */
+static void *alloc_locked(unsigned order) {
+    unsigned k = order;
+    while (k <= PMM_MAX_ORDER && !free_list[k])
+        k++;
+    if (k > PMM_MAX_ORDER)
+        return 0;
+
+    free_block_t *b = free_list[k];
+    list_remove(k, b);
+    uint32_t page = page_of(b);
+
+    /* Split: keep the lower half, free the upper half one order down. */
+    while (k > order) {
+        k--;
+        list_push(k, page + (1u << k));
+    }
+    free_pages -= 1u << order;
+    return b;
+}
+
+void *pmm_alloc(unsigned order) {
+    irq_flags_t f = irq_save();
+    void *b = alloc_locked(order);
+    irq_restore(f);
+    return b;
+}
+
+void pmm_free(void *block, unsigned order) {
+    irq_flags_t f = irq_save();
+    uint32_t page = page_of(block);
+    free_pages += 1u << order;
+
+    while (order < PMM_MAX_ORDER) {
+        uint32_t buddy = page ^ (1u << order);
+        if (buddy >= npages || state[buddy] != (STATE_FREE | order))
+            break;
+        list_remove(order, block_at(buddy));
+        page &= ~(1u << order);     /* merged block starts at the lower half */
+        order++;
+    }
+    list_push(order, page);
+    irq_restore(f);
+}
+
+/* ── Initialisation ───────────────────────────────────────────────── */
+
+/* free_range() — Free [start, end) as the largest aligned blocks. */
+static void free_range(uintptr_t start, uintptr_t end) {
+    uint32_t page = page_of((void *)start);
+    uint32_t last = page_of((void *)end);
+
+    while (page < last) {
+        unsigned order = PMM_MAX_ORDER;
+        while (order && ((page & ((1u << order) - 1)) || page + (1u << order) > last))
+            order--;
+        total_pages += 1u << order;
+        pmm_free(block_at(page), order);
+        page += 1u << order;
+    }
+}
+
+/* page_span() — The whole pages of region r between lo and hi; start
+ * is not below end. */
+static void page_span(const mem_region_t *r, uintptr_t lo, uint64_t hi,
+                      uint64_t *start, uint64_t *end) {
+    *start = (r->base + PAGE_SIZE - 1) & ~(uint64_t)(PAGE_SIZE - 1);
+    *end   = (r->base + r->len) & ~(uint64_t)(PAGE_SIZE - 1);
+    if (*start < lo) *start = lo;
+    if (*end > hi)   *end   = hi;
+    if (*end < *start) *end = *start;
+}
+
+void pmm_init(const mem_region_t *ram, unsigned count) {
+    uintptr_t kend = ((uintptr_t)__kernel_end + PAGE_SIZE - 1) & ~(uintptr_t)(PAGE_SIZE - 1);
+    uint64_t  top  = 0;
+
+    /* Highest RAM address, limited to what a pointer can reach. */
+    for (unsigned i = 0; i < count; i++)
+        if (ram[i].base + ram[i].len > top)
+            top = ram[i].base + ram[i].len;
+    if (top > (uintptr_t)-PAGE_SIZE)
+        top = (uintptr_t)-PAGE_SIZE;
+    top &= ~(uint64_t)(PAGE_SIZE - 1);
+    if (top <= kend)
+        return;                     /* no RAM above the kernel */
+
+    base   = kend & ~(uintptr_t)(MAX_BLOCK - 1);
+    npages = (uint32_t)((top - base) / PAGE_SIZE);
+
+    /* The state array goes in the lowest RAM above the kernel with room
+     * for it — right after the kernel, unless a boot module is there
+     * (memmap.c).  Every page starts out reserved. */
+    uint64_t at = top;
+    for (unsigned i = 0; i < count; i++) {
+        uint64_t start, end;
+        page_span(&ram[i], kend, top, &start, &end);
+        if (start < at && end - start >= npages)
+            at = start;
+    }
+    if (at == top)
+        return;
+    state = (uint8_t *)(uintptr_t)at;
+    memset(state, 0, npages);
+    uint64_t after = (at + npages + PAGE_SIZE - 1) & ~(uint64_t)(PAGE_SIZE - 1);
+
+    for (unsigned i = 0; i < count; i++) {
+        uint64_t start, end;
+        page_span(&ram[i], kend, top, &start, &end);
+        if (start < at)
+            free_range((uintptr_t)start, (uintptr_t)(end < at ? end : at));
+        if (end > after)
+            free_range((uintptr_t)(start > after ? start : after), (uintptr_t)end);
+    }
+}
+
+uint32_t pmm_total_pages(void) {
+    return total_pages;
+}
+
+uint32_t pmm_free_pages(void) {
+    return free_pages;
+}
@@ -0,0 +1,70 @@
+/*
+ * pmm.h — Physical memory manager (page-frame allocator)
+ *
+ * The kernel hands out physical memory in PAGES of 4 KB, in blocks of
+ * 2^order contiguous pages (order 0 = 4 KB … PMM_MAX_ORDER = 4 MB).  The
+ * allocator is a binary BUDDY system (pmm.c): allocation and freeing
+ * both take O(log n) steps, and freed blocks merge back into larger ones
+ * automatically.
+ *
+ * Both platforms identity-map memory (x86: paging off, RPi3: see
+ * mmu_rpi3.c), so a physical address is directly a usable pointer.
+ *
+ * WHERE THE RAM LIST COMES FROM
+ * ------------------------------
+ *   x86  (memmap.c)      : the Multiboot memory map (header flags bit 1),
+ *                          read from the info structure the bootloader
+ *                          passes in EBX.
+ *   RPi3 (memmap_rpi3.c) : the VideoCore firmware, via the mailbox
+ *                          property "get ARM memory" (mbox_rpi3.c).
+ *
+ * Not for use from interrupt handlers or SMP jobs.
+ */
+
+#ifndef PMM_H
+#define PMM_H
+
+#include <stdint.h>
+
+#define PAGE_SIZE      4096
+#define PMM_MAX_ORDER  10           /* largest block: 2^10 pages = 4 MB */
+#define MEMMAP_MAX     32           /* RAM regions kept from the firmware */
+
+typedef struct {
+    uint64_t base;                  /* physical start address */
+    uint64_t len;                   /* length in bytes        */
+} mem_region_t;
+
+/* memmap_detect() — Fill ram[] with the usable RAM regions reported by
+ * the boot loader / firmware and return how many there are.  boot_magic
+ * and boot_info are the two values the boot stub passed to kernel_main()
+ * (x86: Multiboot EAX and EBX; RPi3: unused). */
+unsigned memmap_detect(uintptr_t boot_magic, uintptr_t boot_info,
+                       mem_region_t *ram, unsigned max);
+
+/* memmap_module() — Where the initial RAM disk is (initrd.h): x86, the
+ * first Multiboot module, which memmap_detect() leaves out of ram[];
+ * RPi3, the archive linked into the kernel image.  Returns 0 if there
+ * is none. */
+int memmap_module(uintptr_t boot_magic, uintptr_t boot_info, mem_region_t *mod);
+
+/* pmm_init() — Hand the RAM regions to the allocator.  Everything below
+ * the end of the kernel image (__kernel_end) stays reserved, and so does
+ * whatever is not in ram[] (x86: boot modules). */
+void pmm_init(const mem_region_t *ram, unsigned count);
+
+/* pmm_alloc() — 2^order contiguous pages, aligned to their own size.
+ * Returns NULL when no block is large enough. */
+void *pmm_alloc(unsigned order);
+
+/* pmm_free() — Return a block; order must match the pmm_alloc() call. */
+void  pmm_free(void *block, unsigned order);
+
+static inline void *pmm_alloc_page(void)   { return pmm_alloc(0); }
+static inline void  pmm_free_page(void *p) { pmm_free(p, 0); }
+
+/* pmm_total_pages() / pmm_free_pages() — Managed / currently free pages. */
+uint32_t pmm_total_pages(void);
+uint32_t pmm_free_pages(void);
+
+#endif
@@ -0,0 +1,45 @@
+/*
+ * qemu.c — isa-debug-exit (x86) and semihosting SYS_EXIT (RPi3)
+ */
+
+#include "qemu.h"
+#ifndef PLATFORM_RPI3
+#  include "io.h"
+#endif
+#include <stdint.h>
+
+#ifndef PLATFORM_RPI3
+
+#define DEBUG_EXIT_PORT 0xF4
+
+void qemu_exit(uint8_t code) {
+    outb(DEBUG_EXIT_PORT, code);
+}
+
+#else
+
+#define SYS_EXIT                    0x18
+#define ADP_STOPPED_APPLICATIONEXIT 0x20026
+
+/*
+ * semihost() — One semihosting call: operation in X0, parameter block
+ * address in X1, result in X0.  The label marks the HLT for irq_rpi3.c,
+ * so the function must exist exactly once: noinline.
+ */
+__attribute__((noinline))
+static uint64_t semihost(uint64_t op, const void *param) {
+    register uint64_t x0 __asm__("x0") = op;
+    register uint64_t x1 __asm__("x1") = (uint64_t)param;
+    __asm__ volatile (".global qemu_semihost_call\n"
+                      "qemu_semihost_call:\n\t"
+                      "hlt #0xf000"
+                      : "+r"(x0) : "r"(x1) : "memory");
+    return x0;
+}
+
+void qemu_exit(uint8_t code) {
+    uint64_t block[2] = { ADP_STOPPED_APPLICATIONEXIT, code };
+    semihost(SYS_EXIT, block);
+}
+
+#endif
@@ -0,0 +1,34 @@
+/*
+ * qemu.h — Leaving QEMU from inside the kernel (both platforms)
+ *
+ * A scripted run (`make bench`, tools/qemu_bench.sh) must end by itself,
+ * with an exit status the script can check.  A real machine has nothing
+ * of the kind, so QEMU offers a way out on each platform:
+ *
+ *   x86 : the isa-debug-exit device (-device isa-debug-exit,iobase=0xf4,
+ *         iosize=0x04).  A write of v to port 0xF4 ends QEMU with status
+ *         2 × v + 1 — never 0, so that it cannot pass for a clean exit of
+ *         QEMU itself.
+ *   RPi3: semihosting (-semihosting): the HLT #0xF000 instruction hands
+ *         an operation to the emulator, here SYS_EXIT, and QEMU ends with
+ *         status v.
+ *
+ * Without them a port write to 0xF4 does nothing, and the HLT raises an
+ * undefined-instruction exception, which irq_rpi3.c recognises by its
+ * address and steps over; qemu_exit() then returns.
+ */
+
+#ifndef QEMU_H
+#define QEMU_H
+
+#include <stdint.h>
+
+/* qemu_exit() — End QEMU with code (0–255); returns if not possible. */
+void qemu_exit(uint8_t code);
+
+#ifdef PLATFORM_RPI3
+/* Address of the semihosting HLT, for the exception handler. */
+extern const char qemu_semihost_call[];
+#endif
+
+#endif
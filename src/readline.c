@@ -0,0 +1,204 @@
+/*
+ * readline.c — Line editor with history: keyboard_readline() (both platforms)
+ *
+ * The drivers turn scan codes (keyboard.c) and serial bytes (both) into
+ * keys; this layer turns keys into a line for the shell.  It is the same
+ * on both platforms, so is its handling of a serial terminal.
+ *
+ * ONE WRITE PER EDIT
+ * -------------------
+ * Echoing each key with its own console_putchar() costs one pass through
+ * every console sink, and one flush of the serial line, per character.
+ * The editor instead collects its echo — the typed characters, the '\b'
+ * of an erase, a whole recalled line — in echo[] and hands it to
+ * console_write() in one call, then flushes once before waiting for the
+ * next key.
+ *
+ * TYPEAHEAD AND PASTES
+ * ---------------------
+ * Keys typed while a command runs, or pasted into the terminal, queue up
+ * in the driver's rings (the scan code ring of keyboard.c, the UART RX
+ * rings of uart.c and uart_rpi3.c).  Each time the editor wakes up it
+ * takes every key that is already there — keyboard_key(0) — before it
+ * echoes anything, so a paste costs one console write, not one per
+ * byte, and the rings are emptied faster than a serial line fills them.
+ * A pasted line end ends the line; the rest stays queued for the next
+ * prompt.
+ *
+ * HISTORY
+ * --------
+ * The last HISTORY_MAX lines entered are kept in a ring of pointers to
+ * kmalloc() blocks (slab.h) the size of each line, so that a short
+ * command takes 16 bytes rather than a whole shell line; they show up
+ * in the kmalloc caches of `meminfo`.  Line n (counting from 0 since
+ * boot) is in slot n % HISTORY_MAX: storing the newest frees the
+ * oldest.  An empty line, or one equal to the previous line, is not
+ * stored, nor is a line when kmalloc() finds no memory.  Up shows the
+ * line before the one on screen, Down the one after; Down past the
+ * newest brings back the line that was being typed.  Recalling is
+ * erasing the characters on screen with '\b' and writing the other
+ * line — both in one write.  Like Backspace, the erasing stops at the
+ * start of a screen row: a line that has wrapped leaves its first row
+ * behind.
+ *
+ * SERIAL TERMINALS
+ * -----------------
+ * keyboard_serial() decodes the bytes of a serial line:
+ *   CR, LF, CR LF — Enter (a terminal sends CR; a paste may hold CR LF)
+ *   BS, DEL       — Backspace
+ *   ESC [ A, ESC O A / ESC [ B, ESC O B — Up / Down: the arrows of a
+ *                   VT100 terminal, in normal and in application mode
+ * Any other escape sequence (ESC [, parameter bytes, a final byte from
+ * '@' to '~') is swallowed whole, other control bytes dropped.
+ */
+
+#include "keyboard.h"
+#include "console.h"
+#include "slab.h"
+#include "kstring.h"
+#include <stdint.h>
+
+#define HISTORY_MAX  32
+#define HISTORY_LINE 128            /* the shell's line, NUL included */
+#define ECHO_MAX     512
+
+static char    *history[HISTORY_MAX];     /* kmalloc() blocks */
+static uint32_t history_n;          /* lines stored since boot */
+
+static char     echo[ECHO_MAX];
+static uint32_t echo_len;
+
+/* ── Serial bytes → keys ──────────────────────────────────────────── */
+
+int keyboard_serial(char c) {
+    static int esc;                 /* 1: after ESC, 2: in the sequence */
+    static int cr;                  /* the last byte was a CR           */
+    int after_cr = cr;
+
+    cr = 0;
+    if (esc == 2) {
+        if (c < 0x40 || c > 0x7E)
+            return KEY_NONE;        /* parameter byte */
+        esc = 0;
+        return c == 'A' ? KEY_UP : c == 'B' ? KEY_DOWN : KEY_NONE;
+    }
+    if (esc == 1) {
+        esc = (c == '[' || c == 'O') ? 2 : 0;
+        if (esc)
+            return KEY_NONE;        /* else: a lone ESC, c is a key */
+    }
+    if (c == 27) {
+        esc = 1;
+        return KEY_NONE;
+    }
+    if (c == '\r') {
+        cr = 1;
+        return '\n';
+    }
+    if (c == '\n')
+        return after_cr ? KEY_NONE : '\n';
+    if (c == '\b' || c == 127)
+        return '\b';
+    return c >= 32 && c < 127 ? c : KEY_NONE;
+}
+
+/* ── The editor ───────────────────────────────────────────────────── */
+
+static void emit(char c) {
+    if (echo_len == ECHO_MAX) {
+        console_write(echo, echo_len);
+        echo_len = 0;
+    }
+    echo[echo_len++] = c;
+}
+
+/* show() — Write out the echo, and the serial sink's buffer with it. */
+static void show(void) {
+    if (echo_len)
+        console_write(echo, echo_len);
+    echo_len = 0;
+    console_flush();
+}
+
+static const char *history_line(uint32_t n) {
+    return history[n % HISTORY_MAX];
+}
+
+/* history_add() — Store buf as line history_n, unless it repeats the
+ * previous one, in place of line history_n - HISTORY_MAX. */
+static void history_add(const char *buf) {
+    uint32_t len = 0;
+    while (buf[len] && len < HISTORY_LINE - 1)
+        len++;
+    if (!len || (history_n && strcmp(history_line(history_n - 1), buf) == 0))
+        return;
+
+    char *line = kmalloc(len + 1);
+    if (!line)
+        return;
+    memcpy(line, buf, len);
+    line[len] = '\0';
+
+    char **slot = &history[history_n % HISTORY_MAX];
+    kfree(*slot);
+    *slot = line;
+    history_n++;
+}
+
+/* replace() — Erase the len characters of buf on screen, and put s in
+ * their place, as much of it as fits.  Returns the new length. */
+static int replace(char *buf, int len, int max, const char *s) {
+    for (; len > 0; len--)
+        emit('\b');
+    for (; s[len] && len < max - 1; len++) {
+        buf[len] = s[len];
+        emit(s[len]);
+    }
+    return len;
+}
+
+int keyboard_readline(char *buf, int max) {
+    static char draft[HISTORY_LINE];        /* the line before Up */
+    uint32_t oldest = history_n > HISTORY_MAX ? history_n - HISTORY_MAX : 0;
+    uint32_t pos = history_n;               /* history_n: the new line */
+    int len = 0;
+
+    for (;;) {
+        show();
+        int k = keyboard_key(1);
+        do {
+            if (k == '\n') {
+                buf[len] = '\0';
+                emit('\n');
+                show();
+                history_add(buf);
+                return len;
+            } else if (k == '\b') {
+                if (len > 0) {
+                    len--;
+                    emit('\b');
+                }
+            } else if (k == KEY_UP) {
+                if (pos > oldest) {
+                    if (pos == history_n) {
+                        int i = 0;
+                        for (; i < len && i < HISTORY_LINE - 1; i++)
+                            draft[i] = buf[i];
+                        draft[i] = '\0';
+                    }
+                    pos--;
+                    len = replace(buf, len, max, history_line(pos));
+                }
+            } else if (k == KEY_DOWN) {
+                if (pos < history_n) {
+                    pos++;
+                    len = replace(buf, len, max,
+                                  pos == history_n ? draft : history_line(pos));
+                }
+            } else if (len < max - 1) {
+                buf[len++] = (char)k;
+                emit((char)k);
+            }
+        } while ((k = keyboard_key(0)) != KEY_NONE);
+    }
+}
@@ -0,0 +1,84 @@
+/*
+ * ring.h — Lock-free single-producer / single-consumer byte ring
+ *
+ * WHY A RING BUFFER?
+ * -------------------
+ * Interrupt handlers and the code they interrupt must share data without
+ * ever waiting for each other: an IRQ handler cannot block until the
+ * shell has consumed a keystroke, and the shell must not lose bytes that
+ * arrive while it is busy.  A ring (circular) buffer solves this with two
+ * indices and no lock at all, provided there is exactly ONE producer and
+ * ONE consumer:
+ *
+ *   head — written only by the producer (e.g. the IRQ handler)
+ *   tail — written only by the consumer (e.g. keyboard_key())
+ *
+ *      tail               head
+ *       v                  v
+ *   [ . | A | B | C | D | . | . | . ]     count = head - tail = 4
+ *
+ * The indices are free-running 32-bit counters: they are never wrapped
+ * back to zero, only masked when used as an array index.  This is why the
+ * capacity must be a power of two, and why "full" (head - tail == size)
+ * and "empty" (head == tail) can be told apart without wasting a slot.
+ * Unsigned subtraction stays correct even when the counters overflow.
+ *
+ * MEMORY ORDERING
+ * ----------------
+ * The producer must store the byte BEFORE it publishes the new head, and
+ * the consumer must read the byte BEFORE it publishes the new tail.  The
+ * __atomic acquire/release built-ins express exactly that.  On x86 they
+ * compile to plain MOVs (the hardware already orders stores); on AArch64
+ * they become LDAR/STLR, which are also correct across cores.
+ */
+
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint8_t  *buf;      /* storage, size = mask + 1 (power of two) */
+    uint32_t  mask;     /* size - 1, used to map a counter to an index */
+    uint32_t  head;     /* next slot to write (producer only)         */
+    uint32_t  tail;     /* next slot to read  (consumer only)         */
+} ring_t;
+
+/* RING_INIT() — Static initialiser over a uint8_t array whose size is
+ * a power of two, e.g.  static uint8_t st[256];
+ *                       static ring_t  r = RING_INIT(st);           */
+#define RING_INIT(storage) { (storage), sizeof(storage) - 1, 0, 0 }
+
+/* ring_count() — Number of bytes waiting to be read. */
+static inline uint32_t ring_count(ring_t *r) {
+    return __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+}
+
+static inline int ring_empty(ring_t *r) {
+    return ring_count(r) == 0;
+}
+
+/* ring_put() — Producer side.  Returns 1 on success, 0 if the ring is
+ * full (the byte is dropped; the caller decides whether that matters). */
+static inline int ring_put(ring_t *r, uint8_t b) {
+    uint32_t h = r->head;
+    if (h - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) > r->mask)
+        return 0;
+    r->buf[h & r->mask] = b;
+    __atomic_store_n(&r->head, h + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* ring_get() — Consumer side.  Returns 1 and stores the oldest byte in
+ * *b, or returns 0 if the ring is empty. */
+static inline int ring_get(ring_t *r, uint8_t *b) {
+    uint32_t t = r->tail;
+    if (t == __atomic_load_n(&r->head, __ATOMIC_ACQUIRE))
+        return 0;
+    *b = r->buf[t & r->mask];
+    __atomic_store_n(&r->tail, t + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+#endif
@@ -0,0 +1,205 @@
+/*
+ * rtc.c — Wall-clock time from one RTC read and clock_ns() (both platforms)
+ *
+ * The time is kept as a pair: base_s seconds since 1970 were reached at
+ * base_ns on the nanosecond clock.  rtc_seconds() adds the whole seconds
+ * elapsed since; only rtc_init() and, on x86, the IRQ 8 handler write the
+ * pair.  See rtc.h for the CMOS side.
+ *
+ * DATES
+ * ------
+ * Days from 1970 to a date, and back, use Howard Hinnant's civil-date
+ * algorithms: counting from 0000-03-01 puts the leap day at the end of
+ * the year, so that every 400-year era has the same 146 097 days and a
+ * month's first day is (153 × m + 2) / 5 days into its year.  Only
+ * 32-bit division: i386 has no instruction for more.
+ */
+
+#include "rtc.h"
+#include "clock.h"
+#include "irq.h"
+#include "timer.h"
+#include "kstring.h"
+#include <stdint.h>
+
+#ifndef RTC_EPOCH
+#define RTC_EPOCH 0                 /* RPi3: Unix time at build (Makefile) */
+#endif
+
+static uint32_t    base_s;
+static uint64_t    base_ns;
+static const char *source = "none";
+
+static void set_base(uint32_t s, uint64_t ns) {
+    irq_flags_t f = irq_save();
+    base_s  = s;
+    base_ns = ns;
+    irq_restore(f);
+}
+
+uint32_t rtc_seconds(void) {
+    irq_flags_t f = irq_save();
+    uint32_t s  = base_s;
+    uint64_t at = base_ns;
+    irq_restore(f);
+    return s + (uint32_t)div64_32(clock_ns() - at, 1000000000u);
+}
+
+const char *rtc_source(void) {
+    return source;
+}
+
+/* ── Civil dates ──────────────────────────────────────────────────── */
+
+/* days_from_civil() — Days from 1970-01-01 to y-m-d (y >= 1970). */
+static uint32_t days_from_civil(uint32_t y, uint32_t m, uint32_t d) {
+    y -= m <= 2;
+    uint32_t era = y / 400, yoe = y - era * 400;
+    uint32_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void rtc_civil(uint32_t s, rtc_time_t *t) {
+    uint32_t days = s / 86400, rem = s % 86400;
+    t->hour    = (uint8_t)(rem / 3600);
+    t->min     = (uint8_t)(rem / 60 % 60);
+    t->sec     = (uint8_t)(rem % 60);
+    t->weekday = (uint8_t)((days + 4) % 7);        /* 1970-01-01: Thursday */
+
+    uint32_t z   = days + 719468;
+    uint32_t era = z / 146097, doe = z - era * 146097;
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp  = (5 * doy + 2) / 153;
+    t->day   = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+    t->month = (uint8_t)(mp < 10 ? mp + 3 : mp - 9);
+    t->year  = (uint16_t)(era * 400 + yoe + (t->month <= 2));
+}
+
+void rtc_now(rtc_time_t *t) {
+    rtc_civil(rtc_seconds(), t);
+}
+
+#ifndef PLATFORM_RPI3
+
+/* ── CMOS RTC (x86) ───────────────────────────────────────────────── */
+
+#define RTC_IRQ    8
+#define REG_A      0x0A
+#define REG_B      0x0B
+#define REG_C      0x0C
+#define A_UIP      0x80             /* update in progress              */
+#define B_24H      0x02             /* hours 0–23, not 1–12 + PM bit   */
+#define B_BIN      0x04             /* binary values, not BCD          */
+#define B_UIE      0x10             /* update-ended interrupt enable   */
+#define C_UF       0x10             /* update-ended interrupt fired    */
+#define HOUR_PM    0x80
+#define UIP_SPINS  10000            /* an update lasts under 2 ms      */
+#define READ_TRIES 8
+
+/* The registers of one reading, in this order. */
+static const uint8_t regs[] = { 0x00, 0x02, 0x04, 0x07, 0x08, 0x09, 0x32 };
+enum { SEC, MIN, HOUR, DAY, MONTH, YEAR, CENTURY, REGS };
+
+static timer_event_t resync;
+
+static void read_regs(uint8_t r[REGS]) {
+    for (int i = 0; i < REGS; i++)
+        r[i] = cmos_read(regs[i]);
+}
+
+/* wait_uip() — Until no update is in progress.  A missing or stuck RTC
+ * is not waited for forever. */
+static void wait_uip(void) {
+    for (int i = 0; i < UIP_SPINS && (cmos_read(REG_A) & A_UIP); i++)
+        ;
+}
+
+static uint8_t field(uint8_t v, uint8_t b) {
+    return (b & B_BIN) ? v : bcd2dec(v);
+}
+
+/* decode() — Seconds since 1970 of one reading, in status B's format.
+ * Returns 0 if the reading is no date (no RTC, or a dead battery). */
+static uint32_t decode(const uint8_t r[REGS], uint8_t b) {
+    uint32_t sec  = field(r[SEC], b), min = field(r[MIN], b);
+    uint32_t hour = field(r[HOUR] & ~HOUR_PM, b);
+    uint32_t day  = field(r[DAY], b), month = field(r[MONTH], b);
+    uint32_t cent = field(r[CENTURY], b);
+
+    if (!(b & B_24H))
+        hour = hour % 12 + ((r[HOUR] & HOUR_PM) ? 12 : 0);
+    if (cent < 19 || cent > 21)     /* register not implemented */
+        cent = 20;
+    uint32_t year = cent * 100 + field(r[YEAR], b);
+
+    if (year < 1970 || month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour > 23 || min > 59 || sec > 59)
+        return 0;
+    return days_from_civil(year, month, day) * 86400 + hour * 3600 +
+           min * 60 + sec;
+}
+
+/* resync_arm() — Timer event: ask for the next update-ended interrupt.
+ * Reading status C drops a flag left from before, so that the next
+ * update raises a fresh interrupt. */
+static void resync_arm(void *arg) {
+    (void)arg;
+    cmos_write(REG_B, cmos_read(REG_B) | B_UIE);
+    cmos_read(REG_C);
+}
+
+/*
+ * rtc_irq() — An update has just ended: the registers hold a second that
+ * started a few microseconds ago and will not change for almost another.
+ * Pin it to now, turn the interrupt off again, and come back in an hour.
+ */
+static void rtc_irq(void) {
+    uint64_t now = clock_ns();
+    uint8_t  r[REGS];
+
+    if (!(cmos_read(REG_C) & C_UF))
+        return;
+    read_regs(r);
+    uint8_t b = cmos_read(REG_B);
+    cmos_write(REG_B, b & ~B_UIE);
+
+    uint32_t s = decode(r, b);
+    if (s) {
+        set_base(s, now);
+        source = "cmos, irq 8";
+    }
+    timer_at(&resync, now + RTC_RESYNC_S * 1000000000ull, resync_arm, 0);
+}
+
+void rtc_init(void) {
+    uint8_t a[REGS], b[REGS];
+
+    for (int i = 0; i < READ_TRIES; i++) {
+        wait_uip();
+        read_regs(a);
+        wait_uip();
+        read_regs(b);
+        if (!memcmp(a, b, REGS))
+            break;
+    }
+    uint32_t s = decode(b, cmos_read(REG_B));
+    set_base(s, clock_ns());
+    if (s)
+        source = "cmos";
+
+    irq_register(RTC_IRQ, rtc_irq);
+    resync_arm(0);
+}
+
+#else
+
+/* ── Build-time epoch (RPi3) ──────────────────────────────────────── */
+
+void rtc_init(void) {
+    set_base(RTC_EPOCH, clock_ns());
+    source = "build time";
+}
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * rtc.h — Wall-clock time: read once, then kept by clock_ns() (rtc.c)
+ *
+ * WHY NOT READ THE RTC EVERY TIME?
+ * ---------------------------------
+ * Every CMOS register read is three port accesses; a full date and time
+ * is seven registers, about twenty slow I/O cycles.  Worse, the RTC
+ * updates its registers once per second, one at a time: a read that
+ * straddles an update can return 09:59:59 as 10:59:59 or 09:00:00.
+ * rtc_init() reads the RTC once at boot, carefully, and converts the
+ * result to seconds since 1970-01-01 00:00 (the Unix epoch); rtc_now()
+ * then adds the time elapsed on the nanosecond clock — a memory read,
+ * no port access.
+ *
+ *   x86 : the CMOS RTC, read as described below.  Its "update ended"
+ *         interrupt (IRQ 8) then pins the second boundary to clock_ns(),
+ *         and again every RTC_RESYNC_S seconds, so that neither the
+ *         sub-second offset of the first read nor the drift of the TSC
+ *         calibration builds up.  Between two resyncs IRQ 8 is off: a
+ *         tickless kernel does not wake up once a second for it.
+ *   RPi3: there is no RTC.  The time starts from RTC_EPOCH, the Unix
+ *         time given at build time (`make PLATFORM=rpi3`: the build's
+ *         own date by default), and runs on the generic timer like
+ *         clock_ns().
+ *
+ * The RTC keeps local time, as the PC firmware set it, and so does
+ * rtc_now() on x86; `date +%s` at build time is UTC.
+ *
+ * THE CMOS RTC (x86)
+ * -------------------
+ * The CMOS chip contains a battery-backed real-time clock (RTC).  Its
+ * registers are accessed via an index/data port pair:
+ *
+ *   Port 0x70 (write): select register index (0x00–0x3F).
+ *   Port 0x71 (read):  read the selected register.
+ *
+ * io_wait() inserts a tiny delay between the index write and data read
+ * to give the CMOS chip time to respond (important on fast CPUs).
+ *
+ * The selected index is state shared by every user of the ports: an
+ * interrupt between the index write and the data access — IRQ 8's
+ * rtc_irq(), or the timer's resync_arm() — would select another
+ * register under the interrupted access.  cmos_read() and cmos_write()
+ * hold interrupts off across the pair.
+ *
+ * RTC register map (relevant subset):
+ *   0x00 = seconds    0x02 = minutes    0x04 = hours
+ *   0x07 = day        0x08 = month      0x09 = year (last two digits)
+ *   0x32 = century
+ *   0x0A = status A: bit 7 UIP, "update in progress"
+ *   0x0B = status B: bit 1 24-hour mode, bit 2 binary (not BCD),
+ *                    bit 4 update-ended interrupt enable
+ *   0x0C = status C: which interrupt fired; reading it acknowledges
+ *
+ * Values are normally stored in BCD (Binary Coded Decimal): each nibble
+ * holds one decimal digit.  bcd2dec() converts: (high_nibble × 10) +
+ * low_nibble.  In 12-hour mode bit 7 of the hours means PM.
+ *
+ * A CONSISTENT READ
+ * ------------------
+ * UIP rises 244 µs before an update and falls when it is over, so once
+ * it reads 0 there are at least 244 µs to read all seven registers.  An
+ * interrupt or a slow emulator may still stretch the reads past that:
+ * rtc_init() reads everything twice and starts again until both reads
+ * agree.  The IRQ 8 handler has it easier — "update ended" means the
+ * next update is almost a second away.
+ */
+
+#ifndef RTC_H
+#define RTC_H
+
+#include <stdint.h>
+
+#define RTC_RESYNC_S 3600           /* x86: seconds between IRQ 8 resyncs */
+
+typedef struct {
+    uint16_t year;
+    uint8_t  month, day;            /* 1–12, 1–31 */
+    uint8_t  hour, min, sec;
+    uint8_t  weekday;               /* 0 = Sunday */
+} rtc_time_t;
+
+/* rtc_init() — Read the RTC (x86) or take RTC_EPOCH (RPi3) as the time
+ * at this instant of clock_ns().  On x86 this also installs the IRQ 8
+ * handler, which arms timer events once interrupts are enabled.  Call
+ * after clock_init(). */
+void rtc_init(void);
+
+/* rtc_seconds() — Seconds since 1970-01-01 00:00, local time. */
+uint32_t rtc_seconds(void);
+
+/* rtc_now() — The current date and time, broken down. */
+void rtc_now(rtc_time_t *t);
+
+/* rtc_civil() — Break s seconds since 1970 down into a date and time. */
+void rtc_civil(uint32_t s, rtc_time_t *t);
+
+/* rtc_source() — "cmos", "cmos, irq 8", "build time" (RPi3), or "none"
+ * (x86: the RTC gave no valid date; the clock starts at 1970). */
+const char *rtc_source(void);
+
+#ifndef PLATFORM_RPI3
+
+#include "io.h"
+#include "irq.h"
+#include "trace.h"
+
+/* cmos_read() — Read one byte from the CMOS RTC. */
+static inline uint8_t cmos_read(uint8_t reg) {
+    TRACE(TRACE_CMOS_READ, reg);
+    irq_flags_t f = irq_save();
+    outb(0x70, reg);
+    io_wait();
+    uint8_t v = inb(0x71);
+    irq_restore(f);
+    return v;
+}
+
+/* cmos_write() — Write one byte to the CMOS RTC. */
+static inline void cmos_write(uint8_t reg, uint8_t val) {
+    irq_flags_t f = irq_save();
+    outb(0x70, reg);
+    io_wait();
+    outb(0x71, val);
+    irq_restore(f);
+}
+
+/*
+ * bcd2dec() — Convert a BCD byte to a binary integer.
+ *
+ * BCD packs two decimal digits into one byte:
+ *   high nibble (bits 7-4) = tens digit
+ *   low  nibble (bits 3-0) = units digit
+ * Example: 0x47 (BCD) → 47 (decimal).
+ */
+static inline uint8_t bcd2dec(uint8_t bcd) {
+    return ((bcd >> 4) * 10) + (bcd & 0x0F);
+}
+
+#endif
+
+#endif
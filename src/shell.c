@@ -11,6 +11,9 @@
  *   3. Parse the command name and optional argument.
  *   4. Dispatch to the appropriate handler function.
  *
+ * The commands themselves live in cmd_*.c and register with
+ * SHELL_COMMAND() (shell.h); only `help` is defined here.
+ *
  * COMMAND PARSING
  * ----------------
  * The input buffer holds at most BUF_SIZE characters.  split_arg() walks
@@ -21,65 +24,61 @@
  * Example:  buf = "note do re mi\0"
  *   After split_arg(): buf = "note\0", arg = "do re mi"
  *
- * PLATFORM GUARDS
- * ----------------
- * Some commands rely on x86-specific I/O ports (CMOS RTC, PS/2 reset).
- * They are compiled out on RPi3 using #ifndef PLATFORM_RPI3.
- *
- * CMOS REAL-TIME CLOCK (x86 only)
- * ---------------------------------
- * The CMOS chip contains a battery-backed real-time clock (RTC).  Its
- * registers are accessed via an index/data port pair:
+ * The command's parser then checks the argument; if it refuses it, the
+ * shell prints "Usage: " and the command's usage line instead of
+ * running it.
  *
- *   Port 0x70 (write): select register index (0x00–0x3F).
- *   Port 0x71 (read):  read the selected register.
- *
- * io_wait() inserts a tiny delay between the index write and data read
- * to give the CMOS chip time to respond (important on fast CPUs).
+ * DISPATCH
+ * ---------
+ * The linker collects every shell_cmd_t into .shell_cmds.  On start-up
+ * shell_run() files each one into slots[] at its perfect-hash position
+ * (phash.h; seed and size come from the generated shell_hash.h).  A
+ * lookup is then: hash the typed name, read one slot, compare one string.
+ * The comparison is still needed — an unknown word also hashes to some
+ * slot.
  *
- * RTC register map (relevant subset):
- *   0x00 = seconds    0x02 = minutes    0x04 = hours
- *   0x07 = day        0x08 = month      0x09 = year (last two digits)
- *   0x32 = century
+ * BACKGROUND JOBS
+ * ----------------
+ * A line ending in '&' runs in a task of its own (task.h) and the prompt
+ * comes back at once:
  *
- * Values are stored in BCD (Binary Coded Decimal): each nibble holds one
- * decimal digit.  bcd2dec() converts: (high_nibble × 10) + low_nibble.
+ *   Kernel# note do re mi fa sol &
+ *   [1] 3                               job number, task id
  *
- * SYSTEM RESET
- * -------------
- * x86: Write 0xFE to port 0x64 (PS/2 controller command port).
- *   This pulses the CPU RESET# line, causing an immediate hard reset.
- *   Equivalent to pressing the physical reset button.
+ * The line is copied into one of JOBS_MAX job slots, which also holds
+ * the job's own command arena: shell_alloc() picks the arena of the
+ * calling task.  Before each prompt the shell looks for jobs whose task
+ * has ended (or was killed with `kill`), reports them as Done and frees
+ * their slot.  A background command must not read the keyboard — the
+ * prompt owns it.
  *
- * RPi3: Write to the BCM2837 Power Management / Watchdog registers.
- *   PM_RSTC (0x3F10001C): reset control register.
- *   PM_WDOG (0x3F100024): watchdog timer (set to 32 ticks ≈ immediate).
- *   The magic password 0x5A000000 must be ORed into every write to
- *   protect against accidental resets.
+ * SCRIPTS
+ * --------
+ * shell_script() feeds the lines of a text to the same dispatcher as the
+ * prompt, without reading the keyboard: `run` (cmd_initrd.c) for a file
+ * of the initial RAM disk, and shell_run() itself for its "rc" at boot.
+ * Empty lines and lines starting with '#' are skipped.
  */
 
 #include "shell.h"
 #include "vga.h"
 #include "keyboard.h"
-#include "sound.h"
-#ifndef PLATFORM_RPI3
-#  include "io.h"
-#endif
+#include "arena.h"
+#include "kstring.h"
+#include "kprintf.h"
+#include "task.h"
+#include "bootstats.h"
+#include "trace.h"
+#include "initrd.h"
+#include "phash.h"
+#include "shell_hash.h"         /* generated: SHELL_HASH_SEED / _SIZE */
 #include <stdint.h>
 
-/* ── Utilities ───────────────────────────────────────────────────── */
+extern const shell_cmd_t __shell_cmds_start[], __shell_cmds_end[];
 
-/* Case-sensitive string equality (no libc available). */
-static int str_eq(const char *a, const char *b) {
-    while (*a && *b)
-        if (*a++ != *b++) return 0;
-    return *a == *b;
-}
+static const shell_cmd_t *slots[SHELL_HASH_SIZE];
 
-/* Wrapper: print a two-digit integer (delegates to vga_print_int2). */
-static void print_uint8_2digits(uint8_t n) {
-    vga_print_int2(n);
-}
+/* ── Utilities ───────────────────────────────────────────────────── */
 
 /*
  * split_arg() — In-place command/argument splitter.
@@ -99,230 +98,307 @@ static char *split_arg(char *buf) {
     return 0;
 }
 
-/* ── CMOS / RTC (x86 only) ───────────────────────────────────────── */
+/* ── Argument parsers ────────────────────────────────────────────── */
 
-#ifndef PLATFORM_RPI3
-/*
- * cmos_read() — Read one byte from the CMOS RTC.
- *
- * The CMOS chip requires: write index to 0x70, then read data from 0x71.
- * io_wait() (a few PORT 0x80 writes) creates a short delay to let the
- * slow CMOS chip settle before the data read.
- */
-static uint8_t cmos_read(uint8_t reg) {
-    outb(0x70, reg);
-    io_wait();
-    return inb(0x71);
+int shell_arg_string(const char *arg, shell_args_t *out) {
+    out->str = arg;
+    return arg && *arg;
 }
 
-/*
- * bcd2dec() — Convert a BCD byte to a binary integer.
- *
- * BCD packs two decimal digits into one byte:
- *   high nibble (bits 7-4) = tens digit
- *   low  nibble (bits 3-0) = units digit
- * Example: 0x47 (BCD) → 47 (decimal).
- */
-static uint8_t bcd2dec(uint8_t bcd) {
-    return ((bcd >> 4) * 10) + (bcd & 0x0F);
+/* shell_arg_uint() — Decimal string → unsigned integer.  Rejects a
+ * missing or empty argument, any non-digit, and a value above
+ * UINT32_MAX, which would otherwise wrap to a small one. */
+int shell_arg_uint(const char *arg, shell_args_t *out) {
+    uint32_t v = 0;
+    if (!arg || !*arg) return 0;
+    for (const char *s = arg; *s; s++) {
+        if (*s < '0' || *s > '9') return 0;
+        uint32_t d = (uint32_t)(*s - '0');
+        if (v > (UINT32_MAX - d) / 10) return 0;
+        v = v * 10 + d;
+    }
+    out->num = v;
+    return 1;
 }
-#endif
 
-/* ── Visual bell ─────────────────────────────────────────────────── */
+/* ── Command table ───────────────────────────────────────────────── */
 
 /*
- * cmd_beep() — Flash the screen as a visual bell.
- *
- * Called by the "beep" command.  vga_flash() inverts all cell colours
- * for a short delay, then restores them — a classic visual alert when
- * an audio beep is unavailable or unwanted.
+ * shell_index() — File every registered command into slots[].  Two
+ * commands in one slot can only mean that shell_hash.h is older than
+ * the command list (make normally regenerates it); say so, and let the
+ * first one win.
  */
-static void cmd_beep(void) {
-    vga_flash();
+static void shell_index(void) {
+    for (const shell_cmd_t *c = __shell_cmds_start; c < __shell_cmds_end; c++) {
+        uint32_t slot = phash_slot(SHELL_HASH_SEED, SHELL_HASH_SIZE, c->name);
+        if (slots[slot]) {
+            kprintf("shell: hash collision on '%s', rebuild shell_hash.h\n", c->name);
+            continue;
+        }
+        slots[slot] = c;
+    }
 }
 
-/* ── System reset ─────────────────────────────────────────────────── */
+static const shell_cmd_t *shell_find(const char *name) {
+    const shell_cmd_t *c = slots[phash_slot(SHELL_HASH_SEED, SHELL_HASH_SIZE, name)];
+    return c && strcmp(c->name, name) == 0 ? c : 0;
+}
 
 /*
- * cmd_reboot() — Perform a hard reset.
- *
- * x86: The PS/2 keyboard controller (Intel 8042) can assert the CPU's
- *   RESET# line by command 0xFE sent to its command port 0x64.  This is
- *   the standard software reboot mechanism on PC hardware.  The hlt loop
- *   is defensive; it should never execute after the reset fires.
- *
- * RPi3: BCM2837 provides a watchdog timer in the Power Management block.
- *   Setting PM_WDOG to a small tick count and PM_RSTC to the full-chip-
- *   reset mode triggers an immediate hardware reset.  Every write must
- *   include the password 0x5A000000 in the upper 24 bits, or the write
- *   is ignored by the hardware.
+ * cmd_help() — One line per registered command, in alphabetical order.
+ * The linker keeps no particular order within .shell_cmds (GCC may emit
+ * a file's commands in reverse), so each pass prints the smallest name
+ * above the previous one: O(n²), for a dozen commands typed by hand.
  */
-static void cmd_reboot(void) {
-#ifndef PLATFORM_RPI3
-    outb(0x64, 0xFE);                       /* PS/2: pulse CPU RESET# line */
-    for (;;) __asm__ volatile ("hlt");
-#else
-    volatile uint32_t *PM_WDOG = (volatile uint32_t *)0x3F100024UL;
-    volatile uint32_t *PM_RSTC = (volatile uint32_t *)0x3F10001CUL;
-    *PM_WDOG = 0x5A000020U;                 /* watchdog timeout: 32 ticks  */
-    *PM_RSTC = 0x5A000020U;                 /* full chip reset             */
-    for (;;) __asm__ volatile ("wfe");
-#endif
+static void cmd_help(const shell_args_t *args) {
+    (void)args;
+    kprintf("\nAvailable commands:\n\n");
+    for (const shell_cmd_t *prev = 0;;) {
+        const shell_cmd_t *next = 0;
+        for (const shell_cmd_t *c = __shell_cmds_start; c < __shell_cmds_end; c++)
+            if ((!prev || strcmp(c->name, prev->name) > 0) &&
+                (!next || strcmp(c->name, next->name) < 0))
+                next = c;
+        if (!next)
+            break;
+        kprintf("  %-8s: %s\n", next->name, next->help);
+        prev = next;
+    }
 }
 
-/* ── Text colour ─────────────────────────────────────────────────── */
+SHELL_COMMAND(help, cmd_help, 0, "help", "list available commands");
 
-/*
- * VGA colour attribute table.
- * Maps English colour names to 4-bit VGA foreground colour codes.
- * The 16 VGA colours are defined by the attribute byte format:
- *   bits 3-0: foreground (0-15)  bits 6-4: background (0-7)  bit 7: blink
- */
-typedef struct { const char *name; uint8_t code; } color_entry_t;
-
-static const color_entry_t color_table[] = {
-    { "black",        0  },
-    { "blue",         1  },
-    { "green",        2  },
-    { "cyan",         3  },
-    { "red",          4  },
-    { "magenta",      5  },
-    { "brown",        6  },
-    { "grey",         7  },
-    { "darkgrey",     8  },
-    { "lightblue",    9  },
-    { "lightgreen",   10 },
-    { "lightcyan",    11 },
-    { "lightred",     12 },
-    { "lightmagenta", 13 },
-    { "yellow",       14 },
-    { "white",        15 },
-    { 0, 0 }
+/* ── Main shell loop ─────────────────────────────────────────────── */
+
+#define BUF_SIZE 128   /* max characters per input line (including NUL) */
+#define ARENA_ORDER 2  /* command arena: 2^2 pages = 16 KB */
+#define JOBS_MAX 4
+#define SCRIPT_DEPTH 4 /* `run` inside a script inside a script ... */
+
+typedef struct {
+    int                task;            /* task id; 0: slot free   */
+    arena_t            arena;           /* base 0: not backed yet  */
+    char               line[BUF_SIZE];
+    const shell_cmd_t *cmd;
+    shell_args_t       args;
+} job_t;
+
+static arena_t cmd_arena;
+static job_t   jobs[JOBS_MAX];
+
+static const char *const job_names[JOBS_MAX] = {
+    "shell-job1", "shell-job2", "shell-job3", "shell-job4",
 };
 
-static void cmd_color(const char *name) {
-    if (!name) {
-        vga_newline();
-        vga_print("Usage: color <name>  (e.g. color white)");
-        vga_newline();
+/* own_arena() — The command arena of the calling task; NULL for a job
+ * whose arena could not be backed. */
+static arena_t *own_arena(void) {
+    int self = task_self();
+    for (int i = 0; self && i < JOBS_MAX; i++)
+        if (jobs[i].task == self)
+            return jobs[i].arena.base ? &jobs[i].arena : 0;
+    return &cmd_arena;
+}
+
+void *shell_alloc(uint32_t size) {
+    arena_t *a = own_arena();
+    return a ? arena_alloc(a, size) : 0;
+}
+
+/* background() — Strip a trailing '&' (and the spaces around it) from
+ * buf; returns 1 if there was one. */
+static int background(char *buf) {
+    uint32_t n = (uint32_t)strlen(buf);
+    while (n && buf[n - 1] == ' ') n--;
+    if (!n || buf[n - 1] != '&') return 0;
+    n--;
+    while (n && buf[n - 1] == ' ') n--;
+    buf[n] = '\0';
+    return 1;
+}
+
+static void job_main(void *arg) {
+    job_t *j = arg;
+    TRACE(TRACE_CMD_START, j->cmd - __shell_cmds_start);
+    j->cmd->run(&j->args);
+    TRACE(TRACE_CMD_END, j->cmd - __shell_cmds_start);
+}
+
+/*
+ * job_start() — Run the command in buf as a background job.  The line
+ * is parsed in the job's own copy, so the argument stays valid after the
+ * prompt has reused buf.
+ */
+static void job_start(const char *buf) {
+    int n = 0;
+    while (n < JOBS_MAX && jobs[n].task)
+        n++;
+    if (n == JOBS_MAX) {
+        kprintf("\nToo many jobs (%u).\n", JOBS_MAX);
         return;
     }
-    for (int i = 0; color_table[i].name; i++) {
-        if (str_eq(name, color_table[i].name)) {
-            vga_set_color(color_table[i].code, 0);
-            return;
-        }
-    }
-    vga_newline();
-    vga_print("Unknown color name.");
-    vga_newline();
-}
+    job_t *j = &jobs[n];
+    if (!j->arena.base)
+        arena_init(&j->arena, job_names[n], ARENA_ORDER);
+
+    uint32_t i = 0;
+    for (; buf[i] && i < BUF_SIZE - 1; i++)
+        j->line[i] = buf[i];
+    j->line[i] = '\0';
 
-/* ── Built-in commands ───────────────────────────────────────────── */
+    char *arg = split_arg(j->line);
+    j->cmd  = shell_find(j->line);
+    j->args = (shell_args_t){ arg, 0 };
 
-static void cmd_cls(void) {
-    vga_clear();
+    if (!j->cmd) {
+        if (j->line[0] != '\0')
+            kprintf("\nUnknown command. Type 'help' to list commands.\n");
+        return;
+    }
+    if (j->cmd->parse && !j->cmd->parse(arg, &j->args)) {
+        kprintf("\nUsage: %s\n", j->cmd->usage);
+        return;
+    }
+    /* The new task may not run before j->task names it: own_arena()
+     * would hand it cmd_arena, and jobs_reap() would not see it. */
+    sched_lock();
+    int id = task_spawn(j->cmd->name, job_main, j);
+    if (id > 0)
+        j->task = id;
+    sched_unlock();
+    if (id < 0) {
+        kprintf("\nCannot start a task (%u at most).\n", TASK_MAX);
+        return;
+    }
+    kprintf("\n[%d] %d\n", n + 1, id);
 }
 
-static void cmd_help(void) {
-    vga_newline();
-    vga_print("Available commands:"); vga_newline();
-    vga_newline();
-    vga_print("  reboot  : restart the computer");              vga_newline();
-    vga_print("  cls     : clear the screen");                  vga_newline();
-    vga_print("  beep    : visual flash (screen bell)");        vga_newline();
-    vga_print("  note    : play notes (do re mi fa sol la si)"); vga_newline();
-    vga_print("  color   : change text foreground color");      vga_newline();
-    vga_print("  date    : display current date");              vga_newline();
-    vga_print("  time    : display current time");              vga_newline();
-    vga_print("  help    : list available commands");           vga_newline();
+/* jobs_reap() — Report and free the jobs whose task has ended. */
+static void jobs_reap(void) {
+    for (int n = 0; n < JOBS_MAX; n++) {
+        job_t *j = &jobs[n];
+        if (!j->task || task_alive(j->task))
+            continue;
+        kprintf("\n[%d] Done    %s%s%s", n + 1, j->line,
+                j->args.str ? " " : "", j->args.str ? j->args.str : "");
+        arena_reset(&j->arena);
+        j->task = 0;
+    }
 }
 
 /*
- * cmd_date() — Read and display the current date from the CMOS RTC.
- *
- * Registers: day (0x07), month (0x08), year (0x09), century (0x32).
- * All values are BCD-encoded and must be decoded before display.
- * Output format: DD/MM/YYYY
+ * exec() — Run one command line, in place: a trailing '&' hands it to
+ * job_start(), otherwise split_arg() separates the command from its
+ * argument, shell_find() looks the name up, and its parser checks the
+ * argument before its handler runs.
  */
-static void cmd_date(void) {
-#ifndef PLATFORM_RPI3
-    uint8_t day   = bcd2dec(cmos_read(0x07));
-    uint8_t month = bcd2dec(cmos_read(0x08));
-    uint8_t year  = bcd2dec(cmos_read(0x09));
-    uint8_t cent  = bcd2dec(cmos_read(0x32));
-    vga_newline();
-    print_uint8_2digits(day);   vga_putchar('/');
-    print_uint8_2digits(month); vga_putchar('/');
-    vga_print_int2(cent);
-    vga_print_int2(year);
-    vga_newline();
-#else
-    vga_newline();
-    vga_print("Not available on RPi3 (no RTC)");
-    vga_newline();
-#endif
+static void exec(char *buf) {
+    if (background(buf)) {
+        job_start(buf);
+        return;
+    }
+
+    char *arg = split_arg(buf);
+    const shell_cmd_t *cmd = shell_find(buf);
+    shell_args_t args = { arg, 0 };
+
+    if (cmd && (!cmd->parse || cmd->parse(arg, &args))) {
+        TRACE(TRACE_CMD_START, cmd - __shell_cmds_start);
+        cmd->run(&args);
+        TRACE(TRACE_CMD_END, cmd - __shell_cmds_start);
+    } else if (cmd) {
+        kprintf("\nUsage: %s\n", cmd->usage);
+    } else if (buf[0] != '\0') {
+        kprintf("\nUnknown command. Type 'help' to list commands.\n");
+    }
 }
 
 /*
- * cmd_time() — Read and display the current time from the CMOS RTC.
+ * shell_script() — Run a script line by line: each line is copied out of
+ * the read-only text into a buffer on the stack, printed once after
+ * "+ ", and handed to exec() as if it had been typed.  With every
+ * character already there, there is no keystroke to wait for and no
+ * echo; the cost per command is one console write plus the command.
  *
- * Registers: hours (0x04), minutes (0x02), seconds (0x00).
- * All values are BCD-encoded.  Output format: HH:MM:SS
+ * The scratch memory a line's command took is released after it, as at
+ * the prompt; the script's own caller keeps its allocations.
  */
-static void cmd_time(void) {
-#ifndef PLATFORM_RPI3
-    uint8_t h = bcd2dec(cmos_read(0x04));
-    uint8_t m = bcd2dec(cmos_read(0x02));
-    uint8_t s = bcd2dec(cmos_read(0x00));
-    vga_newline();
-    print_uint8_2digits(h); vga_putchar(':');
-    print_uint8_2digits(m); vga_putchar(':');
-    print_uint8_2digits(s);
-    vga_newline();
-#else
-    vga_newline();
-    vga_print("Not available on RPi3 (no RTC)");
-    vga_newline();
-#endif
-}
+void shell_script(const char *name, const char *text, uint32_t len) {
+    static int depth;
+    uint32_t at = 0, lineno = 0;
 
-/* ── Main shell loop ─────────────────────────────────────────────── */
+    if (depth >= SCRIPT_DEPTH) {
+        kprintf("\n%s: scripts nested too deep (%u).\n", name, SCRIPT_DEPTH);
+        return;
+    }
+    depth++;
 
-#define BUF_SIZE 128   /* max characters per input line (including NUL) */
+    while (at < len) {
+        char buf[BUF_SIZE];
+        uint32_t n = 0;
+
+        lineno++;
+        for (; at < len && text[at] != '\n'; at++)
+            if (n < BUF_SIZE)
+                buf[n++] = text[at];
+        at++;                               /* the '\n' */
+        if (n && buf[n - 1] == '\r')
+            n--;                            /* CRLF line ends */
+        if (n == BUF_SIZE) {
+            kprintf("\n%s:%u: line too long (%u characters at most).\n",
+                    name, lineno, BUF_SIZE - 1);
+            continue;
+        }
+        buf[n] = '\0';
+        if (n == 0 || buf[0] == '#')
+            continue;
+
+        arena_t *a = own_arena();
+        uint32_t mark = a ? a->used : 0;
+        kprintf("\n+ %s", buf);
+        exec(buf);
+        if (a)
+            a->used = mark;
+    }
+    depth--;
+}
 
 /*
  * shell_run() — Enter the interactive command loop (never returns).
  *
- * Each iteration:
- *   1. Print the prompt.
+ * If the initial RAM disk has a script called "rc", it runs first,
+ * right after the boot time to the first prompt has been taken.  Then
+ * each iteration:
+ *   1. Report finished background jobs, print the prompt.
  *   2. keyboard_readline() blocks until the user presses Enter,
  *      then returns the typed line in buf (NUL-terminated, no newline).
- *   3. split_arg() separates the command from its argument in-place.
- *   4. str_eq() dispatches to the correct handler.
+ *      buf comes from the command arena.
+ *   3. exec() runs the line.
+ *   4. The arena is reset: the line and whatever the command took with
+ *      shell_alloc() are released together.
  */
 void shell_run(void) {
-    char buf[BUF_SIZE];
+    static char fallback[BUF_SIZE];     /* if the pmm had no 16 KB block */
+    initrd_file_t rc;
+
+    arena_init(&cmd_arena, "shell-cmd", ARENA_ORDER);
+    shell_index();
+    bootstats_prompt();
+
+    if (initrd_open("rc", &rc)) {
+        shell_script(rc.name, rc.data, rc.size);
+        arena_reset(&cmd_arena);
+    }
 
     for (;;) {
-        vga_newline();
-        vga_print("Kernel# ");
-        keyboard_readline(buf, BUF_SIZE);
+        char *buf = shell_alloc(BUF_SIZE);
+        if (!buf) buf = fallback;
 
-        char *arg = split_arg(buf);
-
-        if      (str_eq(buf, "reboot")) { cmd_reboot(); }
-        else if (str_eq(buf, "cls"))    { cmd_cls(); }
-        else if (str_eq(buf, "help"))   { cmd_help(); }
-        else if (str_eq(buf, "beep"))   { cmd_beep(); }
-        else if (str_eq(buf, "note"))   { if (arg) sound_play_sequence(arg); }
-        else if (str_eq(buf, "color"))  { cmd_color(arg); }
-        else if (str_eq(buf, "date"))   { cmd_date(); }
-        else if (str_eq(buf, "time"))   { cmd_time(); }
-        else if (buf[0] != '\0') {
-            vga_newline();
-            vga_print("Unknown command. Type 'help' to list commands.");
-            vga_newline();
-        }
+        jobs_reap();
+        kprintf("\nKernel# ");
+        keyboard_readline(buf, BUF_SIZE);
+        exec(buf);
+        arena_reset(&cmd_arena);
     }
 }
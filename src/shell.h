@@ -6,15 +6,78 @@
  * parse the command name and optional argument, dispatch to the
  * appropriate handler, and repeat forever.
  *
- * There is no process model, no file system, and no memory
- * allocation — every command runs directly in kernel context.
+ * There is no process model and no file system beyond the read-only
+ * initial RAM disk (initrd.h) — every command runs directly in kernel
+ * context, in the shell's task or, with a trailing '&', in a task of its
+ * own (task.h).
+ *
+ * ADDING A COMMAND
+ * -----------------
+ * Commands live in their own cmd_*.c files and register themselves:
+ *
+ *     static void cmd_echo(const shell_args_t *a) { kprintf("%s", a->str); }
+ *     SHELL_COMMAND(echo, cmd_echo, shell_arg_string,
+ *                   "echo <text>", "print its argument");
+ *
+ * SHELL_COMMAND() places a shell_cmd_t in the .shell_cmds section; the
+ * linker scripts gather all of them into one array between
+ * __shell_cmds_start and __shell_cmds_end.  No central list to edit:
+ * adding the file to the Makefile is enough.  `help` prints the array.
+ *
+ * For dispatch, the Makefile extracts the names from the SHELL_COMMAND()
+ * lines and tools/mkhash.c computes a perfect hash for them (phash.h), so
+ * finding a command takes one hash and one string comparison.  For the
+ * extraction to work, a SHELL_COMMAND( line must start at column 0 with
+ * the name as its first argument.
  */
 
 #ifndef SHELL_H
 #define SHELL_H
 
+#include <stdint.h>
+
+/* The argument of a command, as filled in by its parser. */
+typedef struct {
+    const char *str;        /* text after the name, NULL if there is none */
+    uint32_t    num;        /* shell_arg_uint: the value                  */
+} shell_args_t;
+
+/* Argument parser: check arg (NULL if none) and fill in *out.  Returns 0
+ * to reject it, and the shell then prints the command's usage line. */
+typedef int  (*shell_parse_t)(const char *arg, shell_args_t *out);
+typedef void (*shell_handler_t)(const shell_args_t *args);
+
+typedef struct {
+    const char     *name;
+    shell_handler_t run;
+    shell_parse_t   parse;      /* NULL: any argument is ignored        */
+    const char     *usage;      /* e.g. "primes <N>"                    */
+    const char     *help;       /* one line for `help`                  */
+} shell_cmd_t;
+
+#define SHELL_COMMAND(name_, run_, parse_, usage_, help_)                     \
+    static const shell_cmd_t shell_cmd_##name_                               \
+    __attribute__((used, section(".shell_cmds"), aligned(sizeof(void *)))) = \
+        { #name_, run_, parse_, usage_, help_ }
+
+/* Standard parsers. */
+int shell_arg_string(const char *arg, shell_args_t *out);  /* required */
+int shell_arg_uint(const char *arg, shell_args_t *out);    /* decimal  */
+
 /* shell_run() — Enter the interactive shell loop.
  * Never returns: the loop runs until the machine is rebooted. */
 void shell_run(void);
 
+/* shell_script() — Run text (len bytes, not NUL-terminated) line by
+ * line as if each line had been typed at the prompt; name is for error
+ * messages.  Lines longer than the prompt's 127 characters are skipped
+ * with an error. */
+void shell_script(const char *name, const char *text, uint32_t len);
+
+/* shell_alloc() — Scratch memory for the running command, 8-byte
+ * aligned.  Released all at once when the command returns: never free
+ * it, never keep a pointer to it.  Returns NULL when the 16 KB command
+ * arena is exhausted.  A background job has an arena of its own. */
+void *shell_alloc(uint32_t size);
+
 #endif
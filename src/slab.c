@@ -0,0 +1,124 @@
+/*
+ * slab.c — Slab object caches (both platforms)
+ *
+ * SLAB LAYOUT
+ * ------------
+ * Each slab is one page from the pmm.  A small header at the start of the
+ * page records which cache it belongs to; the rest is cut into slots:
+ *
+ *   page:  [ header | slot 0 | slot 1 | … | slot n-1 | unused tail ]
+ *
+ * A free slot holds a pointer to the next free slot, so the free list
+ * needs no memory of its own.  The header is what lets kfree() work from
+ * the pointer alone: rounding any object address down to the page
+ * boundary finds the header and thus the cache.
+ *
+ * Slabs are never given back to the pmm: caches serve long-lived,
+ * recycled objects, and keeping the pages avoids refilling them on the
+ * next burst.  meminfo shows how many each cache holds.
+ *
+ * Tasks share the caches, so allocating and freeing run with interrupts
+ * off: no task switch can fall between reading c->free and updating it.
+ */
+
+#include "slab.h"
+#include "pmm.h"
+#include "irq.h"
+#include <stdint.h>
+
+#define SLAB_HEADER 16              /* keeps slots 16-byte aligned */
+#define KMALLOC_MIN 16
+#define KMALLOC_MAX 2048
+#define KMALLOC_CLASSES 8           /* 16, 32, … 2048 */
+
+typedef struct {
+    kmem_cache_t *cache;
+} slab_header_t;
+
+static kmem_cache_t *caches;        /* registry, in creation order */
+static kmem_cache_t  kmalloc_caches[KMALLOC_CLASSES];
+
+static const char *const kmalloc_names[KMALLOC_CLASSES] = {
+    "kmalloc-16", "kmalloc-32", "kmalloc-64", "kmalloc-128",
+    "kmalloc-256", "kmalloc-512", "kmalloc-1024", "kmalloc-2048",
+};
+
+void kmem_cache_init(kmem_cache_t *c, const char *name, uint32_t size) {
+    if (size < sizeof(void *)) size = sizeof(void *);
+    c->name       = name;
+    c->obj_size   = (size + 7) & ~7u;
+    c->per_slab   = (PAGE_SIZE - SLAB_HEADER) / c->obj_size;
+    c->free       = 0;
+    c->slabs      = 0;
+    c->in_use     = 0;
+    c->high_water = 0;
+    c->next       = 0;
+
+    kmem_cache_t **link = &caches;
+    while (*link) link = &(*link)->next;
+    *link = c;
+}
+
+/* cache_grow() — Take a page from the pmm and thread its slots. */
+static int cache_grow(kmem_cache_t *c) {
+    uint8_t *page = pmm_alloc_page();
+    if (!page) return 0;
+
+    ((slab_header_t *)page)->cache = c;
+    uint8_t *slot = page + SLAB_HEADER;
+    for (uint32_t i = 0; i < c->per_slab; i++, slot += c->obj_size) {
+        *(void **)slot = c->free;
+        c->free = slot;
+    }
+    c->slabs++;
+    return 1;
+}
+
+void *kmem_cache_alloc(kmem_cache_t *c) {
+    irq_flags_t f = irq_save();
+    if (!c->free && !cache_grow(c)) {
+        irq_restore(f);
+        return 0;
+    }
+    void *obj = c->free;
+    c->free = *(void **)obj;
+    if (++c->in_use > c->high_water)
+        c->high_water = c->in_use;
+    irq_restore(f);
+    return obj;
+}
+
+void kmem_cache_free(kmem_cache_t *c, void *obj) {
+    irq_flags_t f = irq_save();
+    *(void **)obj = c->free;
+    c->free = obj;
+    c->in_use--;
+    irq_restore(f);
+}
+
+/* ── kmalloc size classes ─────────────────────────────────────────── */
+
+void slab_init(void) {
+    uint32_t size = KMALLOC_MIN;
+    for (int i = 0; i < KMALLOC_CLASSES; i++, size <<= 1)
+        kmem_cache_init(&kmalloc_caches[i], kmalloc_names[i], size);
+}
+
+void *kmalloc(uint32_t size) {
+    if (size == 0 || size > KMALLOC_MAX)
+        return 0;
+    int i = 0;
+    while ((uint32_t)KMALLOC_MIN << i < size)
+        i++;
+    return kmem_cache_alloc(&kmalloc_caches[i]);
+}
+
+void kfree(void *p) {
+    if (!p) return;
+    slab_header_t *h = (slab_header_t *)((uintptr_t)p & ~(uintptr_t)(PAGE_SIZE - 1));
+    kmem_cache_free(h->cache, p);
+}
+
+const kmem_cache_t *kmem_cache_list(void) {
+    return caches;
+}
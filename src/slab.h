@@ -0,0 +1,63 @@
+/*
+ * slab.h — Object caches and small-block allocation on top of the pmm
+ *
+ * The page allocator (pmm.h) deals in 4 KB pages.  Most kernel objects —
+ * a history entry, a trace record, a sequencer event — are a few dozen
+ * bytes.  A SLAB CACHE serves objects of ONE fixed size: it takes a page
+ * from the pmm (a "slab"), cuts it into equal slots, and threads the free
+ * slots into a list.  Allocation pops the list head, freeing pushes the
+ * object back: O(1), and since every slot of a cache has the same size,
+ * the cache can never fragment.
+ *
+ *     kmem_cache_t ev_cache;
+ *     kmem_cache_init(&ev_cache, "seq-event", sizeof(event_t));
+ *     event_t *e = kmem_cache_alloc(&ev_cache);
+ *     ...
+ *     kmem_cache_free(&ev_cache, e);
+ *
+ * kmalloc() / kfree() sit on a set of built-in caches of power-of-two
+ * sizes (16 … 2048 bytes) for objects without a cache of their own.
+ *
+ * Not for use from interrupt handlers or SMP jobs (like pmm.h).
+ */
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stdint.h>
+
+typedef struct kmem_cache {
+    const char         *name;
+    uint32_t            obj_size;   /* slot size (rounded up to 8)  */
+    uint32_t            per_slab;   /* slots per page               */
+    void               *free;       /* free slots, linked list      */
+    uint32_t            slabs;      /* pages taken from the pmm     */
+    uint32_t            in_use;     /* objects currently allocated  */
+    uint32_t            high_water; /* maximum of in_use so far     */
+    struct kmem_cache  *next;       /* all caches, for meminfo      */
+} kmem_cache_t;
+
+/* slab_init() — Set up the kmalloc() size classes.  After pmm_init(). */
+void slab_init(void);
+
+/* kmem_cache_init() — Prepare a cache of size-byte objects in caller-
+ * provided (usually static) storage.  size must be at most 2048. */
+void kmem_cache_init(kmem_cache_t *c, const char *name, uint32_t size);
+
+/* kmem_cache_alloc() — One object, or NULL when memory is exhausted.
+ * The contents are NOT cleared. */
+void *kmem_cache_alloc(kmem_cache_t *c);
+
+/* kmem_cache_free() — Return an object to the cache it came from. */
+void  kmem_cache_free(kmem_cache_t *c, void *obj);
+
+/* kmalloc() — size bytes (1 … 2048), 8-byte aligned, or NULL. */
+void *kmalloc(uint32_t size);
+
+/* kfree() — Free a kmalloc() block (NULL is ignored). */
+void  kfree(void *p);
+
+/* kmem_cache_list() — First registered cache; follow ->next. */
+const kmem_cache_t *kmem_cache_list(void);
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ * smp.h — Multi-core work queue
+ *
+ * WHY?
+ * -----
+ * The BCM2837 has four Cortex-A53 cores, but only core 0 runs the kernel:
+ * it owns the UART console, the timer and every interrupt.  Cores 1–3 are
+ * woken by smp_init() and become WORKERS.  They never touch a device;
+ * they only run jobs that core 0 (or another worker) hands them, e.g. the
+ * chunks of a benchmark or of a long computation.
+ *
+ * JOBS AND GROUPS
+ * ----------------
+ * A job is a function pointer plus an argument, in storage owned by the
+ * caller (there is no allocator).  Jobs belong to a GROUP, which counts
+ * the jobs still outstanding:
+ *
+ *     smp_group_t g = SMP_GROUP_INIT;
+ *     smp_job_t   jobs[8];
+ *     for (i = 0; i < 8; i++) {
+ *         jobs[i].fn  = work;
+ *         jobs[i].arg = &chunk[i];
+ *         smp_run(&g, &jobs[i]);
+ *     }
+ *     smp_wait(&g);            // all 8 have run, on whichever core
+ *
+ * A job must not print or use any driver: those are single-core code.
+ * It reports through its argument instead.
+ *
+ * Implementations:
+ *   RPi3 (smp_rpi3.c) : per-core work-stealing deques, 4 cores.
+ *   x86  (smp_stub.c) : one core — smp_run() runs the job immediately.
+ */
+
+#ifndef SMP_H
+#define SMP_H
+
+#include <stdint.h>
+
+#define SMP_MAX_CORES 4
+
+typedef struct {
+    volatile uint32_t pending;  /* jobs queued or running */
+    uint32_t          held;     /* RPi3: core 0 task kept alive (task.h) */
+} smp_group_t;
+
+#define SMP_GROUP_INIT { 0, 0 }
+
+typedef struct smp_job {
+    void        (*fn)(void *arg);
+    void         *arg;
+    smp_group_t  *group;        /* set by smp_run() */
+} smp_job_t;
+
+/* smp_init() — Release the secondary cores and wait (briefly) until they
+ * report in.  Call on core 0 after timer_init() and irq_enable(). */
+void smp_init(void);
+
+/* smp_cpu_id() — Index of the calling core (0 = boot core). */
+unsigned smp_cpu_id(void);
+
+/* smp_cores_online() — Number of cores running, including core 0. */
+unsigned smp_cores_online(void);
+
+/* smp_jobs_done() — Jobs executed by a core since boot. */
+uint32_t smp_jobs_done(unsigned cpu);
+
+/* smp_run() — Queue job as part of group.  If the queue is full the job
+ * runs immediately on the calling core. */
+void smp_run(smp_group_t *group, smp_job_t *job);
+
+/* smp_wait() — Return once every job of group has finished.  The caller
+ * executes queued jobs itself while it waits. */
+void smp_wait(smp_group_t *group);
+
+#endif
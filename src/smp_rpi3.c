@@ -0,0 +1,264 @@
+/*
+ * smp_rpi3.c — Secondary core bring-up and work-stealing job queue (RPi3)
+ *
+ * WAKING THE SECONDARY CORES
+ * ---------------------------
+ * The firmware (and QEMU's raspi3b boot stub) leaves cores 1–3 spinning
+ * in a tiny loop before our kernel starts.  Each one watches a 64-bit
+ * "spin table" slot in low memory:
+ *
+ *   0xE0  core 1        0xE8  core 2        0xF0  core 3
+ *
+ * sleeping in WFE while its slot is zero.  To start a core we write the
+ * address it should jump to into its slot and execute SEV (Send Event),
+ * which wakes every core sleeping in WFE.
+ *
+ * Older firmware instead starts all four cores at 0x80000; boot_rpi3.S
+ * then parks cores 1–3 in its own loop, polling smp_release.  smp_init()
+ * writes both mechanisms, so the cores come up either way.
+ *
+ * Either path ends in secondary_entry (boot_rpi3.S), which drops the core
+ * to EL1, gives it its own 16 KB stack (from the .stacks section of the
+ * linker script) and calls smp_secondary_main().
+ *
+ * Core 0 runs with its data cache on (mmu_rpi3.c), but a waiting core
+ * still has its MMU off, and reads memory around the caches.  So every
+ * release word is cleaned from the cache to RAM (DC CVAC) and a DSB
+ * waits for that to complete before SEV.  Once a secondary core has
+ * enabled its MMU with the same tables, the hardware keeps the caches
+ * of all cores coherent.
+ *
+ * WORK-STEALING DEQUES
+ * ---------------------
+ * Every core owns a deque (double-ended queue) of job pointers.  The
+ * OWNER pushes and pops at the BOTTOM end, like a stack — the most
+ * recently queued job is still hot in its cache.  Other cores STEAL from
+ * the TOP end, taking the oldest job.  An idle worker first empties its
+ * own deque, then steals from the others in turn.
+ *
+ *        top (thieves)                   bottom (owner)
+ *          v                                v
+ *   [ . | J1 | J2 | J3 | J4 | . | . | . ]       size = bottom - top
+ *
+ * This is the Chase-Lev algorithm, here with a fixed capacity.  Owner
+ * operations are plain loads and stores on `bottom`; only when owner and
+ * thief compete for the very last job, or thieves compete with each
+ * other, is a compare-and-swap on `top` needed to decide who wins.
+ * Compared with one shared queue behind a lock, the common case costs no
+ * atomic read-modify-write and no cache line bouncing between cores.
+ *
+ * SLEEPING
+ * ---------
+ * A worker with nothing to do executes WFE.  smp_run() does SEV after
+ * every push, and a finishing job does SEV so that smp_wait() notices.
+ * WFE cannot miss a wake-up: a SEV sent between the emptiness check and
+ * the WFE sets the core's event register, and WFE then returns at once.
+ * On core 0 an interrupt also ends WFE, so the UART keeps being served
+ * while smp_wait() runs.
+ *
+ * TASKS ON CORE 0
+ * ----------------
+ * Several tasks may queue jobs on core 0 (task.h), but a deque has one
+ * owner: a switch in the middle of a push or a pop, and another task
+ * pushing, would break the algorithm.  Core 0's owner operations run
+ * with interrupts off.  A waiting task with no job left to run itself
+ * lets the other tasks run rather than WFE, and since the group and its
+ * jobs usually live on its stack, it cannot be killed from its first
+ * smp_run() until smp_wait() returns.
+ */
+
+#include "smp.h"
+#include "timer.h"
+#include "task.h"
+#include "irq.h"
+#include <stdint.h>
+
+#define SPIN_TABLE        ((volatile uint64_t *)0xD8UL)  /* [core] */
+#define SMP_START_TIMEOUT 100                            /* ms */
+
+#define DEQUE_SIZE 64                       /* must be a power of two */
+#define DEQUE_MASK (DEQUE_SIZE - 1)
+
+typedef struct {
+    int64_t     top;                /* next job to steal   (thieves) */
+    int64_t     bottom;             /* next free slot      (owner)   */
+    smp_job_t  *slot[DEQUE_SIZE];
+} __attribute__((aligned(64))) deque_t;    /* one cache line of indices */
+
+static deque_t  deques[SMP_MAX_CORES];
+static uint32_t jobs_done[SMP_MAX_CORES];
+static uint32_t online = 1;                 /* core 0 */
+
+extern char secondary_entry[];              /* boot_rpi3.S */
+extern char vectors[];                      /* vectors_rpi3.S */
+
+/* Release word polled by cores that boot_rpi3.S parked itself.  In .data,
+ * not .bss: the parked cores read it while core 0 is zeroing the BSS. */
+volatile uint64_t smp_release __attribute__((section(".data")));
+
+static inline void sev(void) { __asm__ volatile ("dsb sy; sev" ::: "memory"); }
+static inline void wfe(void) { __asm__ volatile ("wfe" ::: "memory"); }
+
+/* clean_to_ram() — Write the cache line holding p back to RAM. */
+static inline void clean_to_ram(volatile void *p) {
+    __asm__ volatile ("dc cvac, %0" : : "r"(p) : "memory");
+}
+
+/* ── Deque (Chase-Lev) ────────────────────────────────────────────── */
+
+/* deque_push() — Owner only.  Returns 0 if the deque is full. */
+static int deque_push(deque_t *d, smp_job_t *job) {
+    int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED);
+    int64_t t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    if (b - t >= DEQUE_SIZE)
+        return 0;
+    __atomic_store_n(&d->slot[b & DEQUE_MASK], job, __ATOMIC_RELAXED);
+    /* The job must be visible before a thief can see the new bottom. */
+    __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* deque_pop() — Owner only.  Takes the newest job, or returns 0. */
+static smp_job_t *deque_pop(deque_t *d) {
+    int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&d->bottom, b, __ATOMIC_RELAXED);
+    /* Claim slot b BEFORE looking at top: a thief reading bottom after
+     * this point will not take it. */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t t = __atomic_load_n(&d->top, __ATOMIC_RELAXED);
+
+    if (t > b) {                            /* empty */
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    smp_job_t *job = __atomic_load_n(&d->slot[b & DEQUE_MASK], __ATOMIC_RELAXED);
+    if (t == b) {
+        /* Last job: race the thieves for it by advancing top ourselves. */
+        if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, 0,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+            job = 0;                        /* a thief got it */
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+    return job;
+}
+
+/* deque_steal() — Any other core.  Takes the oldest job, or returns 0
+ * (empty, or another core won the race for it). */
+static smp_job_t *deque_steal(deque_t *d) {
+    int64_t t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE);
+    if (t >= b)
+        return 0;
+    smp_job_t *job = __atomic_load_n(&d->slot[t & DEQUE_MASK], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, 0,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        return 0;
+    return job;
+}
+
+/* ── Running jobs ─────────────────────────────────────────────────── */
+
+unsigned smp_cpu_id(void) {
+    uint64_t mpidr;
+    __asm__ volatile ("mrs %0, mpidr_el1" : "=r"(mpidr));
+    return (unsigned)(mpidr & 3);
+}
+
+unsigned smp_cores_online(void) {
+    return __atomic_load_n(&online, __ATOMIC_ACQUIRE);
+}
+
+uint32_t smp_jobs_done(unsigned cpu) {
+    return cpu < SMP_MAX_CORES ? __atomic_load_n(&jobs_done[cpu], __ATOMIC_RELAXED) : 0;
+}
+
+static void run_job(unsigned cpu, smp_job_t *job) {
+    smp_group_t *g = job->group;
+    job->fn(job->arg);
+    __atomic_store_n(&jobs_done[cpu], jobs_done[cpu] + 1, __ATOMIC_RELAXED);
+    __atomic_fetch_sub(&g->pending, 1, __ATOMIC_RELEASE);
+    sev();
+}
+
+/* find_job() — Own deque first, then steal from the others in turn. */
+static smp_job_t *find_job(unsigned cpu) {
+    smp_job_t *job = deque_pop(&deques[cpu]);
+    for (unsigned i = 1; !job && i < SMP_MAX_CORES; i++)
+        job = deque_steal(&deques[(cpu + i) % SMP_MAX_CORES]);
+    return job;
+}
+
+void smp_run(smp_group_t *group, smp_job_t *job) {
+    unsigned cpu = smp_cpu_id();
+    job->group = group;
+    __atomic_fetch_add(&group->pending, 1, __ATOMIC_RELAXED);
+    if (cpu == 0 && !group->held) {
+        group->held = 1;
+        task_nokill_begin();
+    }
+    irq_flags_t f = irq_save();
+    int queued = deque_push(&deques[cpu], job);
+    irq_restore(f);
+    if (queued)
+        sev();
+    else
+        run_job(cpu, job);
+}
+
+void smp_wait(smp_group_t *group) {
+    unsigned cpu = smp_cpu_id();
+    while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE)) {
+        irq_flags_t f = irq_save();
+        smp_job_t *job = find_job(cpu);
+        irq_restore(f);
+        if (job)
+            run_job(cpu, job);
+        else if (cpu != 0 || !task_yield())
+            wfe();
+    }
+    if (group->held) {
+        group->held = 0;
+        task_nokill_end();
+    }
+}
+
+/* ── Bring-up ─────────────────────────────────────────────────────── */
+
+/*
+ * smp_secondary_main() — C entry point of cores 1–3, called by
+ * secondary_entry in boot_rpi3.S at EL1 on the core's own stack.
+ * Interrupts stay masked: workers only run jobs.
+ */
+void smp_secondary_main(unsigned cpu) {
+    /* Faults on this core are reported like on core 0. */
+    __asm__ volatile ("msr vbar_el1, %0; isb" : : "r"(vectors) : "memory");
+
+    __atomic_fetch_add(&online, 1, __ATOMIC_RELEASE);
+    sev();
+
+    for (;;) {
+        smp_job_t *job = find_job(cpu);
+        if (job)
+            run_job(cpu, job);
+        else
+            wfe();
+    }
+}
+
+void smp_init(void) {
+    uint64_t entry = (uint64_t)(uintptr_t)secondary_entry;
+
+    for (unsigned cpu = 1; cpu < SMP_MAX_CORES; cpu++) {
+        SPIN_TABLE[cpu] = entry;            /* firmware spin table */
+        clean_to_ram(&SPIN_TABLE[cpu]);
+    }
+    smp_release = entry;                    /* cores parked by boot_rpi3.S */
+    clean_to_ram(&smp_release);
+    sev();
+
+    uint32_t start = timer_ticks();
+    while (smp_cores_online() < SMP_MAX_CORES &&
+           timer_ticks() - start < SMP_START_TIMEOUT)
+        ;
+}
@@ -0,0 +1,38 @@
+/*
+ * smp_stub.c — Single-core implementation of smp.h (x86)
+ *
+ * The x86 port runs on the boot processor only: starting the other CPUs
+ * would need the local APIC and an INIT/SIPI sequence through real-mode
+ * trampoline code.  Jobs therefore run immediately, on the caller's
+ * stack, and smp_wait() has nothing left to wait for.  Callers work the
+ * same on both platforms.
+ */
+
+#include "smp.h"
+#include <stdint.h>
+
+static uint32_t jobs_done;
+
+void smp_init(void) {}
+
+unsigned smp_cpu_id(void) {
+    return 0;
+}
+
+unsigned smp_cores_online(void) {
+    return 1;
+}
+
+uint32_t smp_jobs_done(unsigned cpu) {
+    return cpu == 0 ? jobs_done : 0;
+}
+
+void smp_run(smp_group_t *group, smp_job_t *job) {
+    job->group = group;
+    job->fn(job->arg);
+    jobs_done++;
+}
+
+void smp_wait(smp_group_t *group) {
+    (void)group;
+}
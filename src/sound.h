@@ -1,11 +1,13 @@
 /*
- * sound.h — PC speaker / audio driver interface
+ * sound.h — Note sequencer and audio back-end interface
  *
- * On x86, sound is produced through the PC speaker, driven by
- * channel 2 of the Intel 8253/8254 Programmable Interval Timer (PIT).
+ * The sequencer (sound_seq.c) is shared by both platforms; only the
+ * square-wave generator behind it differs:
  *
- * On Raspberry Pi 3, there is no PC speaker and the functions are
- * compiled as no-ops (see sound_stub.c).
+ *   x86 : the PC speaker, driven by channel 2 of the Intel 8253/8254
+ *         Programmable Interval Timer (PIT) — sound.c
+ *   RPi3: the PWM outputs wired to the headphone jack (GPIO 40/45), fed
+ *         by a looping DMA control-block chain — sound_rpi3.c
  */
 
 #ifndef SOUND_H
@@ -13,23 +15,44 @@
 
 #include <stdint.h>
 
+/* sound_init() — Prepare the audio output (silent).  Call after
+ * timer_init(). */
+void sound_init(void);
+
 /* sound_play() — Play a tone at freq_hz for duration_ms milliseconds.
  *   freq_hz    : frequency in Hz (0 = silence / rest)
  *   duration_ms: duration in milliseconds
- * The function blocks until the tone is finished. */
+ * The function blocks until the tone is finished.  It stops any
+ * sequence that is playing. */
 void sound_play(uint32_t freq_hz, uint32_t duration_ms);
 
-/* sound_stop() — Immediately silence the PC speaker. */
+/* sound_stop() — Stop the sequence, if any, and silence the speaker. */
 void sound_stop(void);
 
-/* sound_note() — Play a single named note for a fixed duration.
- *   name: one of "do" "re" "mi" "fa" "sol" "la" "si"
- * Unknown names are silently ignored. */
-void sound_note(const char *name);
+/* sound_sequence() — Start playing space-separated tokens and return at
+ * once; the timer interrupt plays the notes in the background.
+ *   str: e.g. "t90 o5 sol sol sol mi si sol mi si sol"
+ *     do re mi fa sol la si   one beat each
+ *     -                       a one-beat rest
+ *     t<bpm>                  tempo, 20 to 600 (default 120)
+ *     o<n>                    octave, 1 to 8 (default 4)
+ * A sequence that is already playing is replaced.  Returns 0, and
+ * plays nothing, if a token is not understood or the text is too long
+ * (64 notes at most). */
+int sound_sequence(const char *str);
+
+/* sound_playing() — 1 while a sequence is still running. */
+int sound_playing(void);
+
+/* ── Back-end interface (sound.c / sound_rpi3.c ↔ sound_seq.c) ── */
+
+/* sound_hw_tone() — Output a square wave of `period` units of
+ * NOTE_CLOCK_HZ (set per platform in the Makefile; note_table.h holds
+ * the period of every note), until the next call.  May be called from
+ * the timer interrupt. */
+void sound_hw_tone(uint16_t period);
 
-/* sound_play_sequence() — Play multiple space-separated note names.
- *   str: e.g. "sol sol sol mi si sol mi si sol"
- * A short silence is inserted between each note for articulation. */
-void sound_play_sequence(const char *str);
+/* sound_hw_off() — Silence the output. */
+void sound_hw_off(void);
 
 #endif
@@ -0,0 +1,244 @@
+/*
+ * sound_rpi3.c — PWM + DMA audio back-end of the note sequencer (RPi3)
+ *
+ * THE HEADPHONE JACK
+ * -------------------
+ * The Pi 3's 3.5 mm jack is not driven by a DAC: it is the two outputs
+ * of the BCM2837 PWM controller, on GPIO 40 (PWM0, right) and GPIO 45
+ * (PWM1, left) in their ALT0 function, followed by an RC low-pass
+ * filter.  Each PWM channel repeats a period of RNG clock cycles and
+ * holds its output high for the first DAT of them; the filter turns
+ * that into a voltage of DAT / RNG.  A stream of DAT values is a stream
+ * of audio samples.
+ *
+ * Clocks and rates used here:
+ *   PWM clock   19.2 MHz crystal / 2 (Clock Manager, CM_PWMDIV) = 9.6 MHz
+ *   RNG = 50    → 192,000 samples per second and per channel
+ * so a tone of f Hz is HALF = 96,000 / f samples high, then HALF low.
+ * NOTE_CLOCK_HZ is 96000 on this platform and note_table.h holds HALF
+ * for every note (from 2935 for do1 down to 12 for si8).
+ *
+ * Registers (offsets from 0x3F20C000):
+ *   0x00  CTL   PWENn enable, RPTLn repeat the last word when the FIFO
+ *               is empty, USEFn take the samples from the FIFO
+ *   0x08  DMAC  bit 31 ENAB: request DMA when the FIFO runs low
+ *   0x10  RNG1 / 0x20 RNG2
+ *   0x18  FIF1  FIFO shared by both channels, which take words from it
+ *               in turn: channel 1, channel 2, channel 1, …
+ *
+ * FEEDING THE FIFO WITHOUT THE CPU
+ * ---------------------------------
+ * 384,000 words a second is too much for an interrupt per sample.  The
+ * DMA controller copies them instead, driven by the PWM's DREQ line
+ * (peripheral 5): it only moves a word when the FIFO has room.  A DMA
+ * channel executes a chain of 32-byte CONTROL BLOCKS, each one "copy
+ * TXFR_LEN bytes from SOURCE to DEST, then load the block at NEXTCONBK".
+ *
+ * A square wave needs no sample buffer at all.  Two control blocks
+ * point at each other, so the chain never ends:
+ *
+ *     cb[0]: HALF × 2 words of `high`  ──►  cb[1]: HALF × 2 words of `low`
+ *        ▲                                                   │
+ *        └───────────────────────────────────────────────────┘
+ *
+ * Neither increments its source address (SRC_INC = 0): each re-reads
+ * one 32-bit level word.  Once started, the DMA plays the tone forever.
+ * Changing the note is just writing the two TXFR_LEN fields; the DMA
+ * reads a whole control block each time it moves to it, so the new
+ * length applies from the next half period.  Silence pauses the channel
+ * (CS.ACTIVE = 0); RPTL keeps the outputs at their last level.
+ *
+ * COHERENCE
+ * ----------
+ * The DMA is a bus master that reads RAM through the 0xC0000000 bus
+ * alias and knows nothing of the ARM data cache (mmu_rpi3.c turns it on),
+ * so every write to a control block is cleaned to RAM (DC CVAC) before
+ * the DMA may read it.  The DMA only reads, so the cache never has to
+ * be invalidated.
+ *
+ * WHICH DMA CHANNEL?
+ * -------------------
+ * The GPU firmware uses some of the sixteen channels for itself.  The
+ * mailbox tag 0x00060001 returns a mask of those the ARM may use; the
+ * lowest free full channel (0–6; 7–14 are "lite" channels) is taken.
+ *
+ * QEMU's raspi3b has no PWM controller, and its DMA model runs a chain
+ * to the end at once, ignoring DREQ — an endless chain would hang the
+ * emulator.  sound_init() reads RNG1 back: on a machine where it does
+ * not hold the value written, the back-end stays off and the sequencer
+ * runs silently.
+ */
+
+#include "sound.h"
+#include "mbox.h"
+#include <stdint.h>
+
+#define GPFSEL4       ((volatile uint32_t *)0x3F200010UL)
+
+#define CM_PWMCTL     ((volatile uint32_t *)0x3F1010A0UL)
+#define CM_PWMDIV     ((volatile uint32_t *)0x3F1010A4UL)
+#define CM_PASSWD     (0x5Au << 24)
+#define CM_SRC_OSC    1u            /* 19.2 MHz crystal */
+#define CM_ENAB       (1u << 4)
+#define CM_BUSY       (1u << 7)
+
+#define PWM_BASE      ((volatile uint32_t *)0x3F20C000UL)
+#define PWM_CTL       (PWM_BASE + 0x00/4)
+#define PWM_DMAC      (PWM_BASE + 0x08/4)
+#define PWM_RNG1      (PWM_BASE + 0x10/4)
+#define PWM_RNG2      (PWM_BASE + 0x20/4)
+#define PWM_FIF1_BUS  0x7E20C018u   /* FIF1 as the DMA sees it */
+
+#define CTL_PWEN1     (1u << 0)
+#define CTL_RPTL1     (1u << 2)
+#define CTL_USEF1     (1u << 5)
+#define CTL_CLRF1     (1u << 6)
+#define CTL_PWEN2     (1u << 8)
+#define CTL_RPTL2     (1u << 10)
+#define CTL_USEF2     (1u << 13)
+#define DMAC_ENAB     (1u << 31)
+#define DMAC_LEVELS   ((7u << 8) | 7u)  /* PANIC and DREQ thresholds */
+
+#define PWM_RANGE     50
+#define LEVEL_HIGH    38                /* ±13 around the middle */
+#define LEVEL_LOW     12
+
+#define DMA_BASE      0x3F007000UL
+#define DMA_ENABLE    ((volatile uint32_t *)0x3F007FF0UL)
+#define DMA_CS(ch)    ((volatile uint32_t *)(DMA_BASE + 0x100 * (ch)))
+#define DMA_CONBLK(ch) ((volatile uint32_t *)(DMA_BASE + 0x100 * (ch) + 0x04))
+
+#define CS_ACTIVE     (1u << 0)
+#define CS_PRIORITY   (8u << 16)
+#define CS_PANIC_PRIO (8u << 20)
+#define CS_WAIT_WR    (1u << 28)
+#define CS_RESET      (1u << 31)
+
+#define TI_WAIT_RESP  (1u << 3)
+#define TI_DEST_DREQ  (1u << 6)
+#define TI_PERMAP_PWM (5u << 16)
+#define TI_NO_WIDE    (1u << 26)
+
+#define TAG_DMA_CHANNELS 0x00060001
+#define BUS_ALIAS     0xC0000000u
+
+typedef struct {
+    uint32_t ti, source, dest, len, stride, next, pad[2];
+} dma_cb_t;
+
+/* The two control blocks: 32-byte aligned, one cache line. */
+static struct {
+    dma_cb_t cb[2];
+} __attribute__((aligned(64))) chain;
+static uint32_t levels[2] __attribute__((aligned(64)));     /* high, low */
+
+static uint32_t dma_ch;
+static int      ready;
+
+static uint32_t bus(const volatile void *p) {
+    return (uint32_t)(uintptr_t)p | BUS_ALIAS;
+}
+
+/* clean_to_ram() — Write [p, p + len) back from the data cache. */
+static void clean_to_ram(const volatile void *p, uint32_t len) {
+    uintptr_t a = (uintptr_t)p & ~(uintptr_t)63;
+    for (; a < (uintptr_t)p + len; a += 64)
+        __asm__ volatile ("dc cvac, %0" : : "r"(a) : "memory");
+    __asm__ volatile ("dsb sy" ::: "memory");
+}
+
+static void delay_cycles(uint32_t n) {
+    while (n--)
+        __asm__ volatile ("nop");
+}
+
+/* dma_channel() — Lowest full channel the firmware leaves to the ARM. */
+static uint32_t dma_channel(void) {
+    static volatile uint32_t __attribute__((aligned(64))) msg[16];
+    uint32_t mask = 0x7F35;             /* stock firmware's answer */
+
+    msg[0] = 7 * 4;
+    msg[1] = MBOX_REQUEST;
+    msg[2] = TAG_DMA_CHANNELS;
+    msg[3] = 4;
+    msg[4] = 0;
+    msg[5] = 0;
+    msg[6] = MBOX_TAG_END;
+    if (mbox_property(msg))
+        mask = msg[5];
+    for (uint32_t ch = 0; ch < 7; ch++)
+        if (mask & (1u << ch))
+            return ch;
+    return 5;
+}
+
+/*
+ * pwm_clock() — 9.6 MHz from the crystal.  The Clock Manager must be
+ * stopped, and no longer BUSY, before its divider may change.
+ */
+static void pwm_clock(void) {
+    *CM_PWMCTL = CM_PASSWD | CM_SRC_OSC;
+    while (*CM_PWMCTL & CM_BUSY)
+        ;
+    *CM_PWMDIV = CM_PASSWD | (2u << 12);
+    *CM_PWMCTL = CM_PASSWD | CM_SRC_OSC;
+    *CM_PWMCTL = CM_PASSWD | CM_SRC_OSC | CM_ENAB;
+}
+
+void sound_init(void) {
+    /* GPIO 40 and 45 → ALT0 (PWM0, PWM1): FSEL fields 0 and 5 of GPFSEL4 */
+    uint32_t sel = *GPFSEL4;
+    sel &= ~((7u << 0) | (7u << 15));
+    sel |= (4u << 0) | (4u << 15);
+    *GPFSEL4 = sel;
+
+    *PWM_CTL = 0;
+    delay_cycles(1000);
+    pwm_clock();
+    *PWM_RNG1 = PWM_RANGE;
+    *PWM_RNG2 = PWM_RANGE;
+    if (*PWM_RNG1 != PWM_RANGE)
+        return;                         /* no PWM (QEMU): stay silent */
+    *PWM_DMAC = DMAC_ENAB | DMAC_LEVELS;
+    *PWM_CTL  = CTL_CLRF1;
+    delay_cycles(1000);
+    *PWM_CTL  = CTL_PWEN1 | CTL_RPTL1 | CTL_USEF1 |
+                CTL_PWEN2 | CTL_RPTL2 | CTL_USEF2;
+
+    levels[0] = LEVEL_HIGH;
+    levels[1] = LEVEL_LOW;
+    for (int i = 0; i < 2; i++) {
+        dma_cb_t *cb = &chain.cb[i];
+        cb->ti     = TI_NO_WIDE | TI_PERMAP_PWM | TI_DEST_DREQ | TI_WAIT_RESP;
+        cb->source = bus(&levels[i]);
+        cb->dest   = PWM_FIF1_BUS;
+        cb->len    = 8;
+        cb->stride = 0;
+        cb->next   = bus(&chain.cb[!i]);
+    }
+    clean_to_ram(&chain, sizeof(chain));
+    clean_to_ram(levels, sizeof(levels));
+
+    dma_ch = dma_channel();
+    *DMA_ENABLE |= 1u << dma_ch;
+    *DMA_CS(dma_ch) = CS_RESET;
+    delay_cycles(1000);
+    *DMA_CONBLK(dma_ch) = bus(&chain.cb[0]);
+    ready = 1;
+}
+
+/* sound_hw_tone() — period = samples per half period: two words each
+ * (left and right). */
+void sound_hw_tone(uint16_t period) {
+    if (!ready)
+        return;
+    chain.cb[0].len = (uint32_t)period * 8;
+    chain.cb[1].len = (uint32_t)period * 8;
+    clean_to_ram(&chain, sizeof(chain));
+    *DMA_CS(dma_ch) = CS_WAIT_WR | CS_PANIC_PRIO | CS_PRIORITY | CS_ACTIVE;
+}
+
+void sound_hw_off(void) {
+    if (ready)
+        *DMA_CS(dma_ch) = CS_WAIT_WR | CS_PANIC_PRIO | CS_PRIORITY;
+}
@@ -0,0 +1,241 @@
+/*
+ * sound_seq.c — Note sequencer: parsing and playback from timer events
+ *               (both platforms)
+ *
+ * TIMING: WHY NOT USE A BUSY-WAIT LOOP?
+ * ---------------------------------------
+ * A naive busy-wait (for(volatile i=0; i<N; i++)) runs at the actual CPU
+ * execution speed, which QEMU does not emulate at real time.  Loops that
+ * would take 1 second on real hardware complete in microseconds in QEMU.
+ * Note durations therefore come from the kernel timebase (timer.h).
+ *
+ * THE SEQUENCER
+ * --------------
+ * Waiting for each note in turn would hold the shell for the whole tune.
+ * Instead, sound_sequence() turns the text into a list of events —
+ * (tone period, duration), period 0 meaning silence — and returns at
+ * once.  A single timer event walks the list: at each boundary its
+ * callback, running in the timer interrupt, hands the next period to the
+ * platform back-end and re-arms itself for the end of the event:
+ *
+ *   x86 : sound.c reprograms PIT channel 2 and the port 0x61 gate
+ *   RPi3: sound_rpi3.c rewrites the length of two DMA control blocks
+ *         that keep feeding the PWM (the headphone jack) on their own
+ *
+ * Deadlines are absolute (start + sum of the durations), so an
+ * interrupt that arrives a little late does not push the rest of the
+ * tune back.  Starting a new sequence or sound_stop() cancels the event.
+ *
+ * Each note lasts one beat: 7/8 of it sounding, then a short silence to
+ * separate ("articulate") it from the next one.  At the default tempo of
+ * 120 beats per minute that is 438 ms of tone and 62 ms of gap.
+ *
+ * MUSICAL NOTES (equal temperament)
+ * ----------------------------------
+ * Equal temperament divides one octave (2× frequency) into 12 equal
+ * semitones.  The reference pitch is A4 = 440 Hz (international standard
+ * ISO 16).  The solfège names correspond to:
+ *   do=C4=262 Hz,  re=D4=294 Hz,  mi=E4=330 Hz,  fa=F4=349 Hz,
+ *   sol=G4=392 Hz, la=A4=440 Hz,  si=B4=494 Hz
+ * A '#' raises a note by a semitone (do# = C#), a 'b' lowers it (sib =
+ * B♭), and a digit picks the octave (la4 = 440 Hz, do#5 = 554 Hz).
+ *
+ * None of this is computed here: tools/mknotes.c writes the generated
+ * header note_table.h with the period of every semitone of octaves 1 to
+ * 8, NOTE_CLOCK_HZ / f in the back-end's unit (the Makefile sets it per
+ * platform) — below octave 1 the PIT divisor no longer fits in 16 bits
+ * — and the note names already placed at their perfect-hash slot
+ * (phash.h).  Reading a token costs one hash and one string comparison;
+ * playing an event, a few register writes.
+ */
+
+#include "sound.h"
+#include "timer.h"
+#include "clock.h"
+#include "irq.h"
+#include "kstring.h"
+#include "phash.h"
+#include <stdint.h>
+#include "note_table.h"
+
+/* ── Note names ─────────────────────────────────────────────────── */
+
+/*
+ * note_find() — Semitone number of a note token (index into
+ * note_period[]), or -1.  A token without an octave digit is in
+ * `octave`.
+ */
+static int note_find(const char *tok, uint32_t octave) {
+    char     name[8];
+    uint32_t len = 0;
+
+    while (tok[len] && len < sizeof(name) - 1) {
+        name[len] = tok[len];
+        len++;
+    }
+    if (len > 1 && name[len - 1] >= '0' && name[len - 1] <= '9')
+        octave = (uint32_t)(name[--len] - '0');
+    name[len] = '\0';
+    if (octave < NOTE_OCTAVE_FIRST || octave > NOTE_OCTAVE_LAST)
+        return -1;
+
+    const note_name_t *e = &note_names[phash_slot(NOTE_HASH_SEED, NOTE_HASH_SIZE, name)];
+    if (!e->name || strcmp(e->name, name) != 0)
+        return -1;
+    int n = 12 * (int)(octave - NOTE_OCTAVE_FIRST) + e->semitone;
+    return n >= 0 && n < NOTE_COUNT ? n : -1;
+}
+
+/* ── Sequencer ───────────────────────────────────────────────────── */
+
+#define SEQ_EVENTS     128      /* two per note: tone, then gap */
+#define TEMPO_DEFAULT  120      /* beats per minute             */
+#define OCTAVE_DEFAULT 4
+
+typedef struct {
+    uint16_t period;            /* 0: silence */
+    uint16_t ms;
+} seq_event_t;
+
+static seq_event_t   seq[SEQ_EVENTS];
+static uint32_t      seq_len, seq_pos;
+static uint64_t      seq_next;      /* clock_ns() end of the current event */
+static timer_event_t seq_timer;
+
+/*
+ * seq_step() — Timer callback: start the next event, or fall silent at
+ * the end of the list.
+ */
+static void seq_step(void *arg) {
+    (void)arg;
+    if (seq_pos == seq_len) {
+        sound_hw_off();
+        return;
+    }
+    const seq_event_t *e = &seq[seq_pos++];
+    if (e->period)
+        sound_hw_tone(e->period);
+    else
+        sound_hw_off();
+    seq_next += (uint64_t)e->ms * 1000000u;
+    timer_at(&seq_timer, seq_next, seq_step, 0);
+}
+
+static int seq_add(uint32_t *n, uint16_t period, uint32_t ms) {
+    if (*n == SEQ_EVENTS)
+        return 0;
+    seq[*n].period  = period;
+    seq[*n].ms      = (uint16_t)ms;
+    (*n)++;
+    return 1;
+}
+
+/* parse_num() — Decimal digits of s into *v; 0 if s is not a number. */
+static int parse_num(const char *s, uint32_t *v) {
+    if (!*s)
+        return 0;
+    *v = 0;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9' || *v > 1000)
+            return 0;
+        *v = *v * 10 + (uint32_t)(*s - '0');
+    }
+    return 1;
+}
+
+/*
+ * parse_token() — Append the events of one token.  Tempo and octave
+ * apply to the notes that follow them.
+ */
+static int parse_token(const char *tok, uint32_t *n, uint32_t *beat,
+                       uint32_t *octave) {
+    uint32_t v;
+
+    if (tok[0] == 't') {
+        if (!parse_num(tok + 1, &v) || v < 20 || v > 600)
+            return 0;
+        *beat = 60000u / v;
+        return 1;
+    }
+    if (tok[0] == 'o') {
+        if (!parse_num(tok + 1, &v) || v < NOTE_OCTAVE_FIRST || v > NOTE_OCTAVE_LAST)
+            return 0;
+        *octave = v;
+        return 1;
+    }
+    if (tok[0] == '-' && tok[1] == '\0')
+        return seq_add(n, 0, *beat);
+
+    int note = note_find(tok, *octave);
+    if (note < 0)
+        return 0;
+    uint32_t gap = *beat / 8;
+    return seq_add(n, note_period[note], *beat - gap) && seq_add(n, 0, gap);
+}
+
+/*
+ * sound_sequence() — Parse the whole text first, so that an invalid
+ * token plays nothing, then hand the list to the timer interrupt.
+ *
+ * Tokens are split on ASCII space ' '.  Maximum token length is 7
+ * characters (enough for "sol#5\0" with room to spare); longer tokens
+ * are rejected.
+ */
+int sound_sequence(const char *str) {
+    uint32_t n = 0, beat = 60000u / TEMPO_DEFAULT, octave = OCTAVE_DEFAULT;
+    char     token[8];
+    int      ti = 0;
+
+    sound_stop();               /* seq[] is ours until the next start */
+    while (1) {
+        char c = *str;
+        if (c == ' ' || c == '\0') {
+            if (ti > 0) {
+                token[ti] = '\0';
+                if (!parse_token(token, &n, &beat, &octave))
+                    return 0;
+                ti = 0;
+            }
+            if (c == '\0') break;
+        } else if (ti < 7) {
+            token[ti++] = c;
+        } else {
+            return 0;
+        }
+        str++;
+    }
+
+    irq_flags_t f = irq_save();
+    seq_len  = n;
+    seq_pos  = 0;
+    seq_next = clock_ns();
+    seq_step(0);
+    irq_restore(f);
+    return 1;
+}
+
+/* sound_stop() — Cancel the sequence; the output goes silent at once. */
+void sound_stop(void) {
+    irq_flags_t f = irq_save();
+    timer_cancel(&seq_timer);
+    seq_len = seq_pos = 0;
+    sound_hw_off();
+    irq_restore(f);
+}
+
+int sound_playing(void) {
+    return seq_timer.pos != 0;
+}
+
+/*
+ * sound_play() — Play a tone at freq_hz for duration_ms milliseconds,
+ * waiting for the end.  If freq_hz is 0, we produce silence (useful for
+ * rests between notes).
+ */
+void sound_play(uint32_t freq_hz, uint32_t duration_ms) {
+    sound_stop();
+    if (freq_hz != 0)
+        sound_hw_tone((uint16_t)(NOTE_CLOCK_HZ / freq_hz));
+    timer_sleep_ms(duration_ms);
+    sound_hw_off();
+}
@@ -0,0 +1,45 @@
+; =============================================================================
+; switch_x86.asm — Task context switch for ExigeOS (x86 / i386)
+;
+; void context_switch(uintptr_t *save_sp, uintptr_t next_sp);   (task.h)
+;
+; WHAT MUST BE SAVED?
+; --------------------
+; context_switch() is an ordinary C function call as far as the compiler
+; of its caller knows.  The cdecl convention already lets it destroy EAX,
+; ECX and EDX, so the caller does not expect them back: only the
+; CALLEE-SAVED registers EBX, ESI, EDI and EBP, and ESP itself, must be
+; the same when the call returns.  Those are pushed on the old task's
+; stack; ESP — which now points at them, just below the return address —
+; is the whole saved context:
+;
+;   old stack:  … return address, EBP, EBX, ESI, EDI   ← *save_sp
+;
+; Loading next_sp into ESP and popping the same four registers restores
+; the other task exactly as it was when IT called context_switch(), and
+; RET returns into its caller, schedule() (task.c).  A task preempted by
+; an interrupt called schedule() from the interrupt handler: the rest of
+; its registers are in the isr_common frame further up its stack, and its
+; IRET runs once it is back on the way out.
+;
+; EFLAGS is not switched: context_switch() is always called with
+; interrupts disabled, and each path re-enables them its own way.
+; =============================================================================
+
+section .text
+
+global context_switch
+context_switch:
+    mov eax, [esp + 4]  ; save_sp
+    mov edx, [esp + 8]  ; next_sp
+    push ebp
+    push ebx
+    push esi
+    push edi
+    mov [eax], esp      ; old task: stopped here
+    mov esp, edx        ; new task's stack from now on
+    pop edi
+    pop esi
+    pop ebx
+    pop ebp
+    ret
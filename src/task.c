@@ -0,0 +1,342 @@
+/*
+ * task.c — Task table, round-robin scheduler (both platforms)
+ *
+ * THE TABLE
+ * ----------
+ * TASK_MAX slots, task 0 in slot 0.  A slot stays DEAD after its task
+ * has ended — task_exit() is still running on that stack — until the
+ * next task_spawn() frees the stack and reuses the slot.  Ids are never
+ * reused, so a stale id is simply "not alive".
+ *
+ * SCHEDULE()
+ * -----------
+ * Always entered with interrupts disabled and the current task already
+ * moved out of RUNNING (to READY, WAITING or DEAD).  It looks for the
+ * next READY slot after the current one — the current one itself last,
+ * which is round robin — and, if there is none, halts the core until an
+ * interrupt wakes a WAITING task.  Then:
+ *
+ *   1. charges the time since the last switch to the outgoing task;
+ *   2. arms the 10 ms slice if someone else is READY too, or cancels it;
+ *   3. fpu_switch() to the incoming task's FP/SIMD state;
+ *   4. context_switch(): the outgoing task stops inside this call, and
+ *      resumes from it, with interrupts still disabled, when it is picked
+ *      again.
+ *
+ * Interrupts wake tasks and preempt from sched_irq_exit(), on the way
+ * out of the dispatcher; the interrupted task's registers are in its
+ * interrupt frame, and its IRET / ERET runs when it is picked again.
+ *
+ * A NEW STACK
+ * ------------
+ * task_spawn() builds the stack that context_switch() expects to find:
+ * zeros for the callee-saved registers and task_entry() as the return
+ * address.  The first switch to the task "returns" into task_entry(),
+ * which turns interrupts on and calls the task's function.
+ *
+ *   x86 (top)   0 (fake return address of task_entry), task_entry,
+ *               EBP EBX ESI EDI                          ← sp
+ *   AArch64     X19 … X28, X29 (frame pointer), X30 = task_entry ← sp
+ */
+
+#include "task.h"
+#include "timer.h"
+#include "clock.h"
+#include "fpu.h"
+#include "irq.h"
+#include "pmm.h"
+#include <stdint.h>
+
+#define STACK_ORDER  2                  /* 4 pages: 16 KB, as the boot stack */
+#define STACK_SIZE   (PAGE_SIZE << STACK_ORDER)
+#define SLICE_NS     10000000u          /* 10 ms */
+
+typedef struct {
+    int           id;
+    volatile task_state_t state;
+    char          name[TASK_NAME_LEN];
+    uintptr_t     sp;                   /* saved by context_switch() */
+    void         *stack;                /* 0 for task 0              */
+    task_fn_t     fn;
+    void         *arg;
+    fpu_state_t  *fpu;                  /* &fpu_own, or the boot state */
+    volatile int  killed;
+    int           nokill;               /* task_nokill_begin() depth */
+    uint64_t      run_ns;
+    fpu_state_t   fpu_own;
+} task_t;
+
+static task_t tasks[TASK_MAX];
+static int    cur;                      /* slot of the running task */
+static int    next_id = 1;
+static int    started;
+
+static volatile int      need_resched;
+static volatile unsigned lock_depth;
+static timer_event_t     slice;
+static uint64_t          switched_at;
+
+static void copy_name(char *dst, const char *src) {
+    int i = 0;
+    for (; src && src[i] && i < TASK_NAME_LEN - 1; i++)
+        dst[i] = src[i];
+    dst[i] = 0;
+}
+
+static task_t *find(int id) {
+    for (int i = 0; i < TASK_MAX; i++)
+        if (tasks[i].state != TASK_FREE && tasks[i].id == id)
+            return &tasks[i];
+    return 0;
+}
+
+/* Mark t finished; its slot is reclaimed by a later task_spawn(). */
+static void bury(task_t *t) {
+    t->state = TASK_DEAD;
+    fpu_release(t->fpu);
+}
+
+static int others_ready(void) {
+    for (int i = 0; i < TASK_MAX; i++)
+        if (i != cur && tasks[i].state == TASK_READY)
+            return 1;
+    return 0;
+}
+
+static void slice_end(void *arg) {
+    (void)arg;
+    need_resched = 1;
+}
+
+/* pick() — Next READY slot after cur, cur itself last; -1 if none.
+ * A killed task met on the way is buried instead. */
+static int pick(void) {
+    for (int i = 1; i <= TASK_MAX; i++) {
+        int j = (cur + i) % TASK_MAX;
+        task_t *t = &tasks[j];
+        if (t->state != TASK_READY)
+            continue;
+        if (t->killed && !t->nokill) {
+            bury(t);
+            continue;
+        }
+        return j;
+    }
+    return -1;
+}
+
+static void schedule(void) {
+    task_t  *prev = &tasks[cur];
+    uint64_t now  = clock_ns();
+    int      next;
+
+    prev->run_ns += now - switched_at;
+    while ((next = pick()) < 0) {
+        cpu_halt();                     /* returns with IRQs on */
+        irq_disable();
+    }
+    switched_at  = clock_ns();
+    need_resched = 0;
+
+    task_t *t = &tasks[next];
+    t->state = TASK_RUNNING;
+    if (next == cur)
+        return;
+    cur = next;
+    if (others_ready())
+        timer_at(&slice, switched_at + SLICE_NS, slice_end, 0);
+    else
+        timer_cancel(&slice);
+    fpu_switch(t->fpu);
+    context_switch(&prev->sp, t->sp);
+}
+
+static void task_entry(void) {
+    task_t *t = &tasks[cur];
+    irq_enable();
+    t->fn(t->arg);
+    task_exit();
+}
+
+/* ── Public interface ─────────────────────────────────────────────── */
+
+void task_init(const char *name) {
+    task_t *t = &tasks[0];
+    t->id    = 0;
+    t->state = TASK_RUNNING;
+    t->fpu   = fpu_current();
+    copy_name(t->name, name);
+    cur         = 0;
+    switched_at = clock_ns();
+    started     = 1;
+}
+
+int task_spawn(const char *name, task_fn_t fn, void *arg) {
+    irq_flags_t f = irq_save();
+    task_t *t = 0;
+
+    for (int i = 1; i < TASK_MAX; i++) {
+        if (tasks[i].state == TASK_DEAD && i != cur) {
+            pmm_free(tasks[i].stack, STACK_ORDER);
+            tasks[i].state = TASK_FREE;
+        }
+        if (!t && tasks[i].state == TASK_FREE)
+            t = &tasks[i];
+    }
+    void *stack = t ? pmm_alloc(STACK_ORDER) : 0;
+    if (!stack) {
+        irq_restore(f);
+        return -1;
+    }
+
+    t->id     = next_id++;
+    t->stack  = stack;
+    t->fn     = fn;
+    t->arg    = arg;
+    t->fpu    = &t->fpu_own;
+    t->killed = 0;
+    t->nokill = 0;
+    t->run_ns = 0;
+    copy_name(t->name, name);
+    fpu_state_init(&t->fpu_own);
+
+    uintptr_t *sp = (uintptr_t *)((uint8_t *)stack + STACK_SIZE);
+#ifndef PLATFORM_RPI3
+    *--sp = 0;                          /* task_entry's return address */
+    *--sp = (uintptr_t)task_entry;
+    for (int i = 0; i < 4; i++)         /* EBP EBX ESI EDI */
+        *--sp = 0;
+#else
+    *--sp = (uintptr_t)task_entry;      /* X30 */
+    for (int i = 0; i < 11; i++)        /* X29 … X19 */
+        *--sp = 0;
+#endif
+    t->sp    = (uintptr_t)sp;
+    t->state = TASK_READY;
+
+    if (!slice.pos)                     /* two runnable tasks now */
+        timer_at(&slice, clock_ns() + SLICE_NS, slice_end, 0);
+    irq_restore(f);
+    return t->id;
+}
+
+void task_exit(void) {
+    irq_disable();
+    bury(&tasks[cur]);
+    schedule();
+    for (;;)
+        ;                               /* never picked again */
+}
+
+int task_kill(int id) {
+    irq_flags_t f = irq_save();
+    task_t *t = find(id);
+    int ok = t && id != 0 && t != &tasks[cur] && t->state != TASK_DEAD;
+    if (ok) {
+        t->killed = 1;
+        if (!t->nokill)
+            bury(t);
+    }
+    irq_restore(f);
+    return ok;
+}
+
+int task_self(void) {
+    return tasks[cur].id;
+}
+
+int task_alive(int id) {
+    task_t *t = find(id);
+    return t && t->state != TASK_DEAD;
+}
+
+int task_yield(void) {
+    irq_flags_t f = irq_save();
+    int other = started && !lock_depth && others_ready();
+    if (other) {
+        tasks[cur].state = TASK_READY;
+        schedule();
+    }
+    irq_restore(f);
+    return other;
+}
+
+unsigned task_list(task_info_t *out, unsigned max) {
+    irq_flags_t f = irq_save();
+    uint64_t now = clock_ns();
+    unsigned n = 0;
+    for (int i = 0; i < TASK_MAX && n < max; i++) {
+        task_t *t = &tasks[i];
+        if (t->state == TASK_FREE || t->state == TASK_DEAD)
+            continue;
+        out[n].id     = t->id;
+        out[n].state  = t->state;
+        out[n].run_ns = t->run_ns + (i == cur ? now - switched_at : 0);
+        copy_name(out[n].name, t->name);
+        n++;
+    }
+    irq_restore(f);
+    return n;
+}
+
+const char *task_state_name(task_state_t s) {
+    switch (s) {
+    case TASK_READY:   return "ready";
+    case TASK_RUNNING: return "run";
+    case TASK_WAITING: return "wait";
+    case TASK_DEAD:    return "dead";
+    default:           return "free";
+    }
+}
+
+void task_nokill_begin(void) {
+    tasks[cur].nokill++;
+}
+
+void task_nokill_end(void) {
+    task_t *t = &tasks[cur];
+    if (--t->nokill == 0 && t->killed)
+        task_exit();
+}
+
+void sched_lock(void) {
+    lock_depth++;
+}
+
+void sched_unlock(void) {
+    if (--lock_depth == 0 && need_resched)
+        task_yield();
+}
+
+/* ── Hooks ────────────────────────────────────────────────────────── */
+
+int sched_wait(void) {
+    if (!started || lock_depth)
+        return 0;
+    tasks[cur].state = TASK_WAITING;
+    schedule();
+    return 1;
+}
+
+void sched_irq_exit(void) {
+    if (!started)
+        return;
+    int woke = 0;
+    for (int i = 0; i < TASK_MAX; i++)
+        if (tasks[i].state == TASK_WAITING) {
+            tasks[i].state = TASK_READY;
+            woke = 1;
+        }
+
+    task_t *t = &tasks[cur];
+    if (t->state != TASK_RUNNING)
+        return;                         /* inside schedule(): it picks */
+    if (lock_depth) {
+        need_resched |= woke;
+        return;
+    }
+    if (woke || need_resched) {
+        t->state = TASK_READY;
+        schedule();
+    }
+}
@@ -0,0 +1,152 @@
+/*
+ * task.h — Kernel tasks and the core 0 scheduler (both platforms)
+ *
+ * TASKS
+ * ------
+ * A task is a kernel thread: its own 16 KB stack, its own saved
+ * registers, its own FP/SIMD state (fpu.h), all in kernel mode.  The
+ * code that kernel_main() runs — in the end, the shell — becomes task 0
+ * when task_init() adopts it, on the boot stack.  task_spawn() creates
+ * the others; the shell uses it to run `cmd &` in the background.
+ *
+ * Every task runs on core 0.  On RPi3 cores 1–3 stay job workers
+ * (smp.h): a task may hand them jobs like the shell always did.
+ *
+ * SCHEDULING
+ * -----------
+ * Round robin between the READY tasks, PREEMPTIVE: while more than one
+ * task can run, a 10 ms slice timer (a timer_event_t, timer.h) asks for
+ * a switch, which happens when the interrupt returns.  With a single
+ * runnable task no slice timer is armed at all, so an idle system stays
+ * tickless.
+ *
+ * A task that waits — for a key, for the end of timer_sleep_ms(), for
+ * room in the UART ring — does so by calling cpu_idle() in a loop, as
+ * before.  cpu_idle() now first offers the CPU to the other tasks: the
+ * waiter becomes WAITING, and EVERY interrupt makes all WAITING tasks
+ * READY again, just as it would end a HLT / WFI, so that each re-checks
+ * what it waits for.  A task woken like this also preempts a running
+ * one at once: the shell answers a keystroke straight away, however
+ * busy the background tasks are.  Only when nobody can run does the
+ * core really halt.
+ *
+ *   RUNNING ──slice / wake-up──► READY ──picked──► RUNNING
+ *      │ cpu_idle()                                   ▲
+ *      ▼                                              │
+ *   WAITING ──any interrupt──► READY ─────────────────┘
+ *
+ * The switch itself (context_switch(), switch_x86.asm / switch_rpi3.S)
+ * saves the callee-saved registers on the old stack, stores its stack
+ * pointer, loads the new one and returns on the new stack.  Everything
+ * else is already on the stack: the caller-saved registers of a task
+ * preempted in an interrupt are in its interrupt frame.
+ *
+ * SHARED STATE
+ * -------------
+ * A switch can happen at the end of any interrupt that arrives while
+ * interrupts are enabled, so code that several tasks use must keep it
+ * out of its critical sections: irq_save() / irq_restore() for short
+ * ones (pmm, slab), sched_lock() / sched_unlock() for long ones that
+ * still need interrupts (the console, which may wait for the UART).
+ *
+ * KILLING
+ * --------
+ * task_kill() marks the task; it is removed the next time the scheduler
+ * would run it.  A task that has handed out pointers into its own stack
+ * — a timer_event_t in timer_sleep_ms(), SMP jobs in flight — brackets
+ * that with task_nokill_begin() / task_nokill_end(), and dies only at
+ * the end of the bracket.
+ *
+ * Killing frees the task's stack and nothing else: no code of the task
+ * runs, so pages it allocated stay allocated and settings it changed
+ * stay changed.  A task that holds such resources — `bench` with its
+ * buffers and, on the RPi3, uart_set_drop(0) — keeps the bracket open
+ * until it has given them back.
+ */
+
+#ifndef TASK_H
+#define TASK_H
+
+#include <stdint.h>
+
+#define TASK_MAX      8
+#define TASK_NAME_LEN 24
+
+typedef void (*task_fn_t)(void *arg);
+
+typedef enum {
+    TASK_FREE,
+    TASK_READY,
+    TASK_RUNNING,
+    TASK_WAITING,
+    TASK_DEAD,
+} task_state_t;
+
+/* One line of task_list(). */
+typedef struct {
+    int          id;
+    task_state_t state;
+    uint64_t     run_ns;        /* time on the CPU so far */
+    char         name[TASK_NAME_LEN];
+} task_info_t;
+
+/* task_init() — Make the caller task 0, `name`, and start scheduling.
+ * Call once, after timer_init() and pmm_init(). */
+void task_init(const char *name);
+
+/* task_spawn() — Start fn(arg) in a new task.  Returns its id (> 0), or
+ * -1 if the task table is full or there is no memory for a stack.  The
+ * task ends when fn returns. */
+int task_spawn(const char *name, task_fn_t fn, void *arg);
+
+/* task_exit() — End the calling task (not task 0). */
+void task_exit(void) __attribute__((noreturn));
+
+/* task_kill() — End task id (see KILLING).  Returns 0 for task 0, the
+ * caller itself, or an id that is not running. */
+int task_kill(int id);
+
+/* task_self() — Id of the calling task. */
+int task_self(void);
+
+/* task_alive() — 1 until task id has ended. */
+int task_alive(int id);
+
+/* task_yield() — Let the other READY tasks run first.  Returns 0 at
+ * once if there are none. */
+int task_yield(void);
+
+/* task_list() — Snapshot of the live tasks; returns how many. */
+unsigned task_list(task_info_t *out, unsigned max);
+
+/* task_state_name() — "run", "ready", "wait", … */
+const char *task_state_name(task_state_t s);
+
+void task_nokill_begin(void);
+void task_nokill_end(void);
+
+/* sched_lock() / sched_unlock() — No task switch in between (they
+ * nest); interrupts keep being served.  A switch that came due is made
+ * at the outermost unlock. */
+void sched_lock(void);
+void sched_unlock(void);
+
+/* ── Hooks ── */
+
+/* sched_wait() — cpu_idle(): with IRQs disabled, let another task run
+ * while the caller waits for an interrupt.  Returns 1 if one did (an
+ * interrupt has happened since: re-check and call again), 0 if the core
+ * must halt (cpu_halt()). */
+int sched_wait(void);
+
+/* sched_irq_exit() — End of every device interrupt (irq.c /
+ * irq_rpi3.c), after the EOI: wakes the WAITING tasks and switches if
+ * the slice has expired or a waiter was woken. */
+void sched_irq_exit(void);
+
+/* context_switch() — Save the callee-saved registers on the current
+ * stack, store the stack pointer in *save_sp, and resume the task whose
+ * stack pointer is next_sp.  Interrupts must be disabled. */
+void context_switch(uintptr_t *save_sp, uintptr_t next_sp);
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * timer.c — One-shot local APIC timer, PIT tick fallback (x86)
+ *
+ * THE LOCAL APIC TIMER
+ * ---------------------
+ * Every x86 CPU since the Pentium has a local APIC (Advanced
+ * Programmable Interrupt Controller), memory-mapped at 0xFEE00000 by
+ * default.  Besides routing interrupts it contains a 32-bit down-counter
+ * driven by the bus clock through a divider, which raises an interrupt
+ * when it reaches zero.  In ONE-SHOT mode it then simply stops: writing
+ * the initial-count register starts exactly one countdown, so the CPU is
+ * woken once, when the next deadline is due, and never in between.
+ *
+ * Registers used (offsets from the APIC base, 32-bit, 16-byte aligned):
+ *   0x0B0  EOI             — write 0 at the end of an APIC interrupt
+ *   0x0F0  Spurious vector — bit 8: software enable; bits 7–0: vector
+ *   0x320  LVT Timer       — bits 7–0: vector, bit 16: mask,
+ *                            bits 18–17: 00 = one-shot
+ *   0x350  LVT LINT0       — how the LINT0 pin is delivered
+ *   0x380  Initial count   — writing it starts the countdown
+ *   0x390  Current count
+ *   0x3E0  Divide config   — 0x3 = divide the bus clock by 16
+ *
+ * The 8259 PIC stays in charge of the devices: its output reaches the
+ * CPU through the APIC's LINT0 pin, which is programmed as ExtINT
+ * ("virtual wire"), so IRQ 1, IRQ 4, … work exactly as before.
+ *
+ * CALIBRATION
+ * ------------
+ * The bus clock rate is not reported anywhere either.  timer_init()
+ * lets the counter run from 0xFFFFFFFF for 10 ms of clock_ns() (TSC)
+ * time and keeps the count per nanosecond as a 32.32 fixed-point
+ * factor, so that timer_hw_arm() converts a delay with one multiply.
+ * One countdown lasts at most APIC_MAX_NS (4.3 s); a deadline further
+ * away is reached in several steps, each of which finds nothing due.
+ *
+ * THE PIT FALLBACK
+ * -----------------
+ * Without an APIC or a TSC, PIT channel 0 keeps its periodic role: a
+ * 1 kHz rate generator on IRQ 0 (1,193,180 Hz / 1193 ≈ 1000.15 Hz,
+ * control word 0x34 = channel 0, low/high byte, mode 2, binary) whose
+ * handler counts milliseconds and looks at the deadline heap on every
+ * tick.
+ */
+
+#include "timer.h"
+#include "clock.h"
+#include "irq.h"
+#include "io.h"
+#include <stdint.h>
+
+#define PIT_BASE_FREQ 1193180UL
+#define PIT_CH0       0x40
+#define PIT_CMD       0x43
+#define TIMER_IRQ     0
+
+#define MSR_APIC_BASE   0x1B
+#define APIC_BASE_EN    (1u << 11)
+#define CPUID_APIC      (1u << 9)
+#define CPUID_TSC       (1u << 4)
+
+#define APIC_EOI        0x0B0
+#define APIC_SVR        0x0F0
+#define APIC_LVT_TIMER  0x320
+#define APIC_LVT_LINT0  0x350
+#define APIC_TIMER_INIT 0x380
+#define APIC_TIMER_CUR  0x390
+#define APIC_TIMER_DIV  0x3E0
+
+#define APIC_SVR_ENABLE (1u << 8)
+#define APIC_LVT_MASK   (1u << 16)
+#define APIC_EXTINT     (7u << 8)
+
+#define VEC_APIC_TIMER  48
+#define VEC_APIC_SPUR   63          /* low 4 bits must be 1111 on P6 */
+
+#define CALIBRATE_NS    10000000u   /* 10 ms */
+#define APIC_MAX_NS     0xFFFFFFFFu /* ns per countdown, ≈ 4.3 s */
+
+static volatile uint32_t *apic;
+static uint32_t           apic_mult;    /* counts per ns, 32.32 */
+
+/* Incremented by the IRQ 0 handler in PIT mode. */
+static volatile uint32_t ticks;
+
+static uint32_t apic_read(uint32_t reg)              { return apic[reg / 4]; }
+static void     apic_write(uint32_t reg, uint32_t v) { apic[reg / 4] = v; }
+
+static void apic_timer_irq(void) {
+    apic_write(APIC_EOI, 0);
+    timer_expire();
+}
+
+static void apic_spurious_irq(void) {}  /* no EOI for spurious vectors */
+
+/* apic_init() — Enable the local APIC and calibrate its timer.  The
+ * APIC page is used as is: x86 runs without paging. */
+static int apic_init(void) {
+    uint32_t eax, ebx, ecx, edx, lo, hi;
+    __asm__ volatile ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(1));
+    if (!(edx & CPUID_APIC) || !(edx & CPUID_TSC) || !clock_mult)
+        return 0;
+
+    __asm__ volatile ("rdmsr" : "=a"(lo), "=d"(hi) : "c"(MSR_APIC_BASE));
+    if (!(lo & APIC_BASE_EN)) {
+        lo |= APIC_BASE_EN;
+        __asm__ volatile ("wrmsr" : : "a"(lo), "d"(hi), "c"(MSR_APIC_BASE));
+    }
+    apic = (volatile uint32_t *)(uintptr_t)(lo & 0xFFFFF000u);
+
+    irq_register_vector(VEC_APIC_TIMER, apic_timer_irq);
+    irq_register_vector(VEC_APIC_SPUR, apic_spurious_irq);
+    apic_write(APIC_LVT_LINT0, APIC_EXTINT);        /* PIC: virtual wire */
+    apic_write(APIC_SVR, APIC_SVR_ENABLE | VEC_APIC_SPUR);
+
+    apic_write(APIC_TIMER_DIV, 0x3);
+    apic_write(APIC_LVT_TIMER, APIC_LVT_MASK | VEC_APIC_TIMER);
+    apic_write(APIC_TIMER_INIT, 0xFFFFFFFFu);
+    uint64_t start = clock_ns();
+    uint64_t ns;
+    while ((ns = clock_ns() - start) < CALIBRATE_NS)
+        ;
+    uint32_t counted = 0xFFFFFFFFu - apic_read(APIC_TIMER_CUR);
+    apic_write(APIC_TIMER_INIT, 0);
+
+    /* counts per ns < 1, i.e. an APIC clock below 1 GHz after the /16 */
+    if (!counted || counted >= (uint32_t)ns) {
+        apic = 0;
+        return 0;
+    }
+    apic_mult = (uint32_t)div64_32((uint64_t)counted << 32, (uint32_t)ns);
+    apic_write(APIC_LVT_TIMER, VEC_APIC_TIMER);     /* one-shot, unmasked */
+    return 1;
+}
+
+static void pit_irq(void) {
+    ticks++;
+    timer_expire();
+}
+
+static void pit_init(void) {
+    uint16_t divisor = (uint16_t)((PIT_BASE_FREQ + TIMER_HZ / 2) / TIMER_HZ);
+    outb(PIT_CMD, 0x34);                        /* channel 0, mode 2 */
+    outb(PIT_CH0, (uint8_t)(divisor & 0xFF));   /* low byte  */
+    outb(PIT_CH0, (uint8_t)(divisor >> 8));     /* high byte */
+    irq_register(TIMER_IRQ, pit_irq);
+}
+
+/* With the APIC, IRQ 0 stays masked: the PIT left running by the BIOS
+ * at 18.2 Hz never wakes the CPU. */
+void timer_init(void) {
+    if (!apic_init())
+        pit_init();
+}
+
+void timer_hw_arm(uint64_t when) {
+    if (!apic)
+        return;                     /* PIT: the tick checks every 1 ms */
+    uint64_t now   = clock_ns();
+    uint64_t delta = when > now ? when - now : 0;
+    if (delta > APIC_MAX_NS)
+        delta = APIC_MAX_NS;
+    /* +1: rounding down would fire just before the deadline */
+    uint32_t n = (uint32_t)(((uint64_t)(uint32_t)delta * apic_mult) >> 32);
+    apic_write(APIC_TIMER_INIT, n + 1);
+}
+
+void timer_hw_stop(void) {
+    if (apic)
+        apic_write(APIC_TIMER_INIT, 0);
+}
+
+/* timer_ticks() — ns / 10^6 with a 32-bit result that wraps like the
+ * tick counter did. */
+uint32_t timer_ticks(void) {
+    if (!apic)
+        return ticks;
+    return (uint32_t)div64_32(clock_ns(), 1000000u);
+}
+
+const char *timer_mode(void) {
+    return apic ? "lapic one-shot" : "pit 1 kHz";
+}
@@ -0,0 +1,98 @@
+/*
+ * timer.h — Kernel timebase: milliseconds, deadlines and idle statistics
+ *
+ * TICKLESS
+ * ---------
+ * A periodic tick wakes the CPU a thousand times a second whether or not
+ * anything is due.  Instead, pending work is a min-heap of DEADLINES on
+ * the nanosecond clock (clock.h), and the hardware timer is programmed
+ * in one-shot mode for the earliest of them only.  With nothing
+ * scheduled the CPU stays halted until a device needs it.
+ *
+ *   x86 : the local APIC timer, one-shot, calibrated against the TSC
+ *         (timer.c).  A CPU without an APIC or a TSC keeps the old PIT
+ *         channel 0 tick at 1 kHz, which checks the heap every
+ *         millisecond.
+ *   RPi3: the core's EL1 physical timer, CNTP_CVAL_EL0 set to the
+ *         deadline's counter value (timer_rpi3.c).
+ *
+ * The heap itself, timer_sleep_ms() and cpu_idle() are shared by both
+ * platforms (timer_queue.c).
+ *
+ * TIMER EVENTS
+ * -------------
+ * A timer_event_t belongs to its caller (static, or on the stack while it
+ * is armed) and starts out zero-initialised.  Its function runs IN THE
+ * TIMER INTERRUPT, with interrupts disabled: it must be short, must not
+ * sleep and must not use FP/SIMD.  It may re-arm its own event, which is
+ * how periodic work is written.
+ */
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+#define TIMER_HZ 1000   /* timer_ticks() unit: one per millisecond */
+
+typedef void (*timer_fn_t)(void *arg);
+
+typedef struct {
+    uint64_t   when;            /* deadline, clock_ns() time       */
+    timer_fn_t fn;
+    void      *arg;
+    uint32_t   pos;             /* 1 + heap index; 0: not armed    */
+} timer_event_t;
+
+/* Idle accounting since timer_init(). */
+typedef struct {
+    uint64_t uptime_ns;
+    uint64_t idle_ns;           /* time spent halted in cpu_idle()  */
+    uint32_t wakeups;           /* cpu_idle() calls that returned   */
+    uint32_t timer_irqs;        /* hardware timer interrupts        */
+} timer_stats_t;
+
+/* timer_init() — Start the timebase.
+ *   x86 : sets up the local APIC timer (or the PIT tick) and installs
+ *         its handler; interrupts start once irq_enable() runs.
+ *   RPi3: installs the CNTP handler on core 0.
+ * Call after irq_init() and clock_init(). */
+void timer_init(void);
+
+/* timer_ticks() — Milliseconds elapsed since boot.
+ * Wraps after ~49 days; compare values by unsigned subtraction. */
+uint32_t timer_ticks(void);
+
+/* timer_sleep_ms() — Wait for at least ms milliseconds.
+ * The CPU halts (HLT / WFI) until the deadline instead of polling. */
+void timer_sleep_ms(uint32_t ms);
+
+/* timer_at() — Run fn(arg) from the timer interrupt once clock_ns()
+ * reaches `when` (at once if it already has).  Re-arming an armed event
+ * moves it.  Returns 0 if the heap is full. */
+int timer_at(timer_event_t *ev, uint64_t when, timer_fn_t fn, void *arg);
+
+/* timer_cancel() — Disarm ev.  Returns 1 if it was still pending. */
+int timer_cancel(timer_event_t *ev);
+
+/* timer_stats() — Snapshot of the idle counters. */
+void timer_stats(timer_stats_t *out);
+
+/* timer_mode() — "lapic one-shot", "pit 1 kHz" or "cntp one-shot". */
+const char *timer_mode(void);
+
+/* ── Back-end interface (timer.c / timer_rpi3.c ↔ timer_queue.c) ── */
+
+/* timer_hw_arm() — Make the hardware interrupt at `when` (clock_ns()
+ * time) or as soon as possible if that is past.  Called with IRQs
+ * masked, whenever the earliest deadline changes. */
+void timer_hw_arm(uint64_t when);
+
+/* timer_hw_stop() — No deadline left: no timer interrupt needed. */
+void timer_hw_stop(void);
+
+/* timer_expire() — Called by the back-end's interrupt handler: runs
+ * every event that is due and re-arms the hardware for the next one. */
+void timer_expire(void);
+
+#endif
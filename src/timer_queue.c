@@ -0,0 +1,208 @@
+/*
+ * timer_queue.c — Deadline heap, sleeping and idle accounting (both platforms)
+ *
+ * THE DEADLINE HEAP
+ * ------------------
+ * Armed events sit in a binary min-heap ordered by deadline: heap[0] is
+ * always the next one due, and the children of heap[i] are heap[2i+1]
+ * and heap[2i+2].  Inserting or removing an event moves it up or down
+ * one level at a time — O(log n) — and each event remembers its index
+ * (`pos`) so that it can be cancelled without a search.
+ *
+ * Only the earliest deadline concerns the hardware: whenever heap[0]
+ * changes, the back-end's one-shot timer is re-armed for it.  When it
+ * fires, timer_expire() pops and runs everything that is due, and arms
+ * the timer for whatever is left — or stops it.
+ *
+ * IDLE RESIDENCY
+ * ---------------
+ * cpu_idle() reads clock_ns() around the halt: the difference is time
+ * the core spent asleep, the number of calls is the number of wake-ups.
+ * On AArch64 both are exact, since the IRQ is only taken after WFI has
+ * returned and the clock has been read.  On x86 STI; HLT runs the
+ * handler before HLT returns, so its (short) run time counts as idle.
+ *
+ * With several tasks (task.h) a waiting task does not halt the core
+ * itself: cpu_idle() hands it to the scheduler, which halts in
+ * cpu_halt() only once no task at all can run.
+ */
+
+#include "timer.h"
+#include "clock.h"
+#include "irq.h"
+#include "task.h"
+#include "trace.h"
+#include <stdint.h>
+
+#define TIMER_EVENTS 32
+
+static timer_event_t *heap[TIMER_EVENTS];
+static uint32_t       count;
+
+static volatile uint64_t idle_ns;
+static volatile uint32_t wakeups, timer_irqs;
+
+static void heap_set(uint32_t i, timer_event_t *ev) {
+    heap[i] = ev;
+    ev->pos = i + 1;
+}
+
+static void sift_up(uint32_t i) {
+    timer_event_t *ev = heap[i];
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (heap[parent]->when <= ev->when)
+            break;
+        heap_set(i, heap[parent]);
+        i = parent;
+    }
+    heap_set(i, ev);
+}
+
+static void sift_down(uint32_t i) {
+    timer_event_t *ev = heap[i];
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= count)
+            break;
+        if (child + 1 < count && heap[child + 1]->when < heap[child]->when)
+            child++;
+        if (ev->when <= heap[child]->when)
+            break;
+        heap_set(i, heap[child]);
+        i = child;
+    }
+    heap_set(i, ev);
+}
+
+/* heap_remove() — Take heap[i] out: the last event fills the hole and
+ * moves up or down to its place. */
+static void heap_remove(uint32_t i) {
+    heap[i]->pos = 0;
+    if (i == --count)
+        return;
+    timer_event_t *moved = heap[count];
+    heap_set(i, moved);
+    sift_up(i);
+    sift_down(moved->pos - 1);
+}
+
+static void rearm(void) {
+    if (count)
+        timer_hw_arm(heap[0]->when);
+    else
+        timer_hw_stop();
+}
+
+int timer_at(timer_event_t *ev, uint64_t when, timer_fn_t fn, void *arg) {
+    irq_flags_t f = irq_save();
+    timer_event_t *first = count ? heap[0] : 0;
+
+    if (ev->pos)
+        heap_remove(ev->pos - 1);
+    if (count == TIMER_EVENTS) {
+        irq_restore(f);
+        return 0;
+    }
+    ev->when = when;
+    ev->fn   = fn;
+    ev->arg  = arg;
+    heap[count] = ev;
+    sift_up(count++);
+
+    if (heap[0] != first || heap[0] == ev)
+        rearm();
+    irq_restore(f);
+    return 1;
+}
+
+int timer_cancel(timer_event_t *ev) {
+    irq_flags_t f = irq_save();
+    int pending = ev->pos != 0;
+    if (pending) {
+        int was_first = ev->pos == 1;
+        heap_remove(ev->pos - 1);
+        if (was_first)
+            rearm();
+    }
+    irq_restore(f);
+    return pending;
+}
+
+/*
+ * timer_expire() — `now` is read once: an event that re-arms itself for a
+ * time that is already past runs again in this loop, but one re-armed
+ * into the future waits for the next interrupt.
+ */
+void timer_expire(void) {
+    uint64_t now = clock_ns();
+    timer_irqs++;
+    while (count && heap[0]->when <= now) {
+        timer_event_t *ev = heap[0];
+        heap_remove(0);
+        ev->fn(ev->arg);
+    }
+    rearm();
+}
+
+static void wake(void *arg) {
+    *(volatile int *)arg = 1;
+}
+
+/*
+ * timer_sleep_ms() — ev lives on the caller's stack and sits in the heap
+ * until it fires, so the task may not be killed in between.
+ */
+void timer_sleep_ms(uint32_t ms) {
+    volatile int  done = 0;
+    timer_event_t ev   = { 0 };
+    uint64_t      end  = clock_ns() + (uint64_t)ms * 1000000u;
+
+    TRACE(TRACE_SLEEP, ms);
+    task_nokill_begin();
+    if (!timer_at(&ev, end, wake, (void *)&done)) {
+        while (clock_ns() < end)    /* heap full: poll the clock */
+            ;
+        task_nokill_end();
+        return;
+    }
+    for (;;) {
+        irq_disable();
+        if (done) {
+            irq_enable();
+            break;
+        }
+        cpu_idle();
+    }
+    task_nokill_end();
+}
+
+void cpu_idle(void) {
+    if (sched_wait())
+        irq_enable();               /* another task ran meanwhile */
+    else
+        cpu_halt();
+}
+
+void cpu_halt(void) {
+    uint64_t start = clock_ns();
+#ifndef PLATFORM_RPI3
+    __asm__ volatile ("sti; hlt" ::: "memory");
+    idle_ns += clock_ns() - start;
+    wakeups++;
+#else
+    __asm__ volatile ("wfi" ::: "memory");
+    idle_ns += clock_ns() - start;
+    wakeups++;
+    __asm__ volatile ("msr daifclr, #2" ::: "memory");
+#endif
+}
+
+void timer_stats(timer_stats_t *out) {
+    irq_flags_t f = irq_save();
+    out->uptime_ns  = clock_ns();
+    out->idle_ns    = idle_ns;
+    out->wakeups    = wakeups;
+    out->timer_irqs = timer_irqs;
+    irq_restore(f);
+}
@@ -0,0 +1,83 @@
+/*
+ * timer_rpi3.c — One-shot deadlines on the ARM generic timer (RPi3)
+ *
+ * THE EL1 PHYSICAL TIMER
+ * -----------------------
+ * Each Cortex-A53 core has its own timers attached to the system counter
+ * CNTPCT_EL0 (clock.h).  The EL1 physical timer is two registers:
+ *
+ *   CNTP_CVAL_EL0  compare value: the timer condition is met once
+ *                  CNTPCT_EL0 >= CVAL
+ *   CNTP_CTL_EL0   bit 0 ENABLE, bit 1 IMASK (1 = no interrupt),
+ *                  bit 2 ISTATUS (condition met, read-only)
+ *
+ * Writing a counter value to CVAL makes it a one-shot timer for an
+ * ABSOLUTE time: a deadline already in the past fires immediately, and
+ * an interrupt that is handled late does not delay the next one.  boot_rpi3.S gives EL1 access to it
+ * (CNTHCTL_EL2.EL1PCEN).
+ *
+ * The interrupt is level-triggered: it stays asserted as long as the
+ * condition holds and the timer is enabled, so the handler disables the
+ * timer before timer_expire() sets the next deadline.  On the BCM2837 it
+ * reaches core 0 through the ARM-local block as source 1, nCNTPNSIRQ
+ * (IRQ_LOCAL(1), enabled in register 0x40000040 by irq_register()).
+ *
+ * The BCM2837 system timer (0x3F003000) is not used: there is no
+ * periodic tick, and with nothing due core 0 is never woken.
+ *
+ * The deadline is converted to cycles from NOW rather than from boot:
+ * the small scaling errors of clock_ns() and of cycles_per_ns then stay
+ * a few cycles instead of growing with uptime, and one extra cycle
+ * rounds up — an interrupt a few nanoseconds EARLY would find the event
+ * not yet due and have to be re-armed.
+ */
+
+#include "timer.h"
+#include "clock.h"
+#include "irq.h"
+#include <stdint.h>
+
+#define TIMER_IRQ     IRQ_LOCAL(1)          /* CNTPNS, core 0 */
+#define CTL_ENABLE    (1u << 0)
+
+static uint64_t cycles_per_ns;              /* 32.32 fixed point */
+
+static void cntp_ctl(uint64_t v) {
+    __asm__ volatile ("msr cntp_ctl_el0, %0; isb" : : "r"(v) : "memory");
+}
+
+static void timer_irq(void) {
+    cntp_ctl(0);                            /* de-assert the line */
+    timer_expire();
+}
+
+void timer_init(void) {
+    uint64_t freq;
+    __asm__ volatile ("mrs %0, cntfrq_el0" : "=r"(freq));
+    if (!freq)
+        freq = 19200000;
+    cycles_per_ns = (freq << 32) / 1000000000u;
+    cntp_ctl(0);
+    irq_register(TIMER_IRQ, timer_irq);
+}
+
+void timer_hw_arm(uint64_t when) {
+    uint64_t now   = clock_ns();
+    uint64_t delta = when > now ? when - now : 0;
+    uint64_t cval  = clock_cycles() +
+        (uint64_t)(((unsigned __int128)delta * cycles_per_ns) >> 32) + 1;
+    __asm__ volatile ("msr cntp_cval_el0, %0" : : "r"(cval) : "memory");
+    cntp_ctl(CTL_ENABLE);
+}
+
+void timer_hw_stop(void) {
+    cntp_ctl(0);
+}
+
+uint32_t timer_ticks(void) {
+    return (uint32_t)(clock_ns() / 1000000u);
+}
+
+const char *timer_mode(void) {
+    return "cntp one-shot";
+}
@@ -0,0 +1,112 @@
+/*
+ * trace.c — Trace rings (both platforms)
+ *
+ * head counts every record ever claimed on a ring: the slot is
+ * head % TRACE_RING, the records held are the last min(head, TRACE_RING)
+ * of them.  Without KERNEL_TRACE nothing below is compiled but the
+ * stubs, and the rings take no memory.
+ */
+
+#include "trace.h"
+#include "clock.h"
+#include "smp.h"
+#include <stdint.h>
+
+static const char *const names[TRACE_EVENTS] = {
+    [TRACE_VGA_PUT]    = "vga_put",
+    [TRACE_VGA_SCROLL] = "vga_scroll",
+    [TRACE_UART_FULL]  = "uart_full",
+    [TRACE_KBD_WAIT]   = "kbd_wait",
+    [TRACE_CMOS_READ]  = "cmos_read",
+    [TRACE_SLEEP]      = "sleep_ms",
+    [TRACE_CMD_START]  = "cmd_start",
+    [TRACE_CMD_END]    = "cmd_end",
+};
+
+const char *trace_event_name(unsigned event) {
+    return event < TRACE_EVENTS ? names[event] : "?";
+}
+
+#ifdef KERNEL_TRACE
+
+#ifdef PLATFORM_RPI3
+#  define TRACE_CPUS SMP_MAX_CORES
+#  define this_cpu() smp_cpu_id()
+#else
+#  define TRACE_CPUS 1
+#  define this_cpu() 0u
+#endif
+
+typedef struct {
+    uint32_t    head;
+    trace_rec_t rec[TRACE_RING];
+} __attribute__((aligned(64))) trace_ring_t;    /* heads in their own lines */
+
+static trace_ring_t rings[TRACE_CPUS];
+static volatile int paused;
+
+void trace_emit(trace_event_t event, uint32_t arg) {
+    if (paused)
+        return;
+    unsigned     cpu = this_cpu();
+    trace_ring_t *r  = &rings[cpu];
+    uint32_t     i   = __atomic_fetch_add(&r->head, 1, __ATOMIC_RELAXED);
+    trace_rec_t  *t  = &r->rec[i & (TRACE_RING - 1)];
+    t->ns    = clock_ns();
+    t->event = (uint16_t)event;
+    t->cpu   = (uint16_t)cpu;
+    t->arg   = arg;
+}
+
+int trace_enabled(void) {
+    return 1;
+}
+
+void trace_pause(int p) {
+    paused = p;
+}
+
+void trace_clear(void) {
+    for (unsigned c = 0; c < TRACE_CPUS; c++)
+        __atomic_store_n(&rings[c].head, 0, __ATOMIC_RELAXED);
+}
+
+static uint32_t held(const trace_ring_t *r) {
+    uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    return head < TRACE_RING ? head : TRACE_RING;
+}
+
+int trace_read(unsigned cpu, uint32_t i, trace_rec_t *out) {
+    if (cpu >= TRACE_CPUS)
+        return 0;
+    trace_ring_t *r = &rings[cpu];
+    uint32_t n = held(r);
+    if (i >= n)
+        return 0;
+    *out = r->rec[(r->head - n + i) & (TRACE_RING - 1)];
+    return 1;
+}
+
+uint32_t trace_lost(unsigned cpu) {
+    if (cpu >= TRACE_CPUS)
+        return 0;
+    return rings[cpu].head - held(&rings[cpu]);
+}
+
+#else   /* !KERNEL_TRACE */
+
+void trace_emit(trace_event_t event, uint32_t arg) {
+    (void)event;
+    (void)arg;
+}
+
+int  trace_enabled(void)   { return 0; }
+void trace_pause(int p)    { (void)p; }
+void trace_clear(void)     {}
+int  trace_read(unsigned cpu, uint32_t i, trace_rec_t *out) {
+    (void)cpu; (void)i; (void)out;
+    return 0;
+}
+uint32_t trace_lost(unsigned cpu) { (void)cpu; return 0; }
+
+#endif
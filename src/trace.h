@@ -0,0 +1,88 @@
+/*
+ * trace.h — Compile-time trace points into per-CPU rings (both platforms)
+ *
+ * WHY NOT KPRINTF?
+ * -----------------
+ * Printing from a hot path changes what is being measured: a kprintf()
+ * in the VGA code draws characters of its own, one in the UART code
+ * fills the very ring it reports on.  A trace point instead stores a
+ * 16-byte record — when, what, one argument — in memory and returns.
+ * `trace csv` sends the records to the serial port afterwards, `trace`
+ * sums them up on the console.
+ *
+ *   TRACE(TRACE_CMOS_READ, reg);
+ *
+ * Built with `make TRACE=1` (KERNEL_TRACE defined) for tracing.  Without
+ * it TRACE() expands to nothing: no call, no record, no ring in the BSS.
+ * Changing TRACE needs a `make clean`: the objects do not depend on it.
+ *
+ * THE RINGS
+ * ----------
+ * One ring per CPU (cores 1–3 may trace from SMP jobs) of TRACE_RING
+ * records.  A writer claims a slot with one atomic increment of the
+ * ring's head and then fills it, so an interrupt handler tracing in the
+ * middle of a trace point simply takes the next slot: no lock, no
+ * interrupt masking.  When the ring is full the oldest records are
+ * overwritten — it always holds the most recent history.  Timestamps are
+ * clock_ns() (clock.h).
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+#define TRACE_RING 1024                 /* records per CPU, power of two */
+
+typedef enum {
+    TRACE_VGA_PUT,          /* vga.c: one character drawn      arg = char  */
+    TRACE_VGA_SCROLL,       /* vga.c: screen scrolled one line             */
+    TRACE_UART_FULL,        /* TX ring full: RPi3 waits, x86 drops
+                               arg = bytes not yet queued                  */
+    TRACE_KBD_WAIT,         /* keyboard: ring empty, CPU to sleep          */
+    TRACE_CMOS_READ,        /* rtc.h: CMOS register read      arg = index  */
+    TRACE_SLEEP,            /* timer_sleep_ms() called        arg = ms     */
+    TRACE_CMD_START,        /* shell: command dispatched      arg = index  */
+    TRACE_CMD_END,          /*        command returned        arg = index  */
+    TRACE_EVENTS
+} trace_event_t;
+
+typedef struct {
+    uint64_t ns;
+    uint16_t event;
+    uint16_t cpu;
+    uint32_t arg;
+} trace_rec_t;
+
+#ifdef KERNEL_TRACE
+#  define TRACE(event, arg) trace_emit((event), (uint32_t)(arg))
+#else
+#  define TRACE(event, arg) ((void)0)
+#endif
+
+/* trace_emit() — Append one record to the calling CPU's ring.  Use
+ * TRACE() instead, so that the call disappears from normal builds. */
+void trace_emit(trace_event_t event, uint32_t arg);
+
+/* trace_enabled() — 1 if the kernel was built with KERNEL_TRACE. */
+int trace_enabled(void);
+
+/* trace_pause() — 1: stop recording (while dumping, so that the dump
+ * does not trace itself), 0: resume. */
+void trace_pause(int paused);
+
+/* trace_clear() — Forget every record. */
+void trace_clear(void);
+
+/* trace_read() — Copy record i (0 = oldest held) of cpu's ring to *out.
+ * Returns 0 past the newest.  Call while paused. */
+int trace_read(unsigned cpu, uint32_t i, trace_rec_t *out);
+
+/* trace_lost() — Records of cpu's ring overwritten since the last
+ * trace_clear(). */
+uint32_t trace_lost(unsigned cpu);
+
+/* trace_event_name() — "vga_put", "uart_full", … */
+const char *trace_event_name(unsigned event);
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * uart.c — Interrupt-driven 16550 UART driver for COM1 (x86)
+ *
+ * THE 16550 UART
+ * ---------------
+ * Every PC has (or emulates) up to four 8250-compatible serial ports;
+ * COM1 sits at I/O ports 0x3F8–0x3FF and raises IRQ 4.  The 16550A
+ * variant adds a 16-byte FIFO in each direction, which is what makes an
+ * interrupt per 16 bytes instead of one per byte possible.
+ *
+ * Registers (offsets from 0x3F8):
+ *   +0  THR / RBR — write: transmit holding, read: receive buffer
+ *                   (DLL, divisor low byte, while LCR.DLAB = 1)
+ *   +1  IER       — interrupt enable: bit 0 RX data, bit 1 THR empty
+ *                   (DLM, divisor high byte, while LCR.DLAB = 1)
+ *   +2  IIR / FCR — read: interrupt identification, write: FIFO control
+ *   +3  LCR       — line control: data bits, parity, stop bits, DLAB
+ *   +4  MCR       — modem control: DTR, RTS, OUT2
+ *   +5  LSR       — line status: bit 0 data ready, bit 5 THR empty
+ *   +7  SCR       — scratch: any value written reads back (presence test)
+ *
+ * BAUD RATE
+ * ----------
+ * The divisor latch divides the 1.8432 MHz UART clock by 16 × divisor:
+ *   115200 = 1 843 200 / (16 × 1)   →   DLL = 1, DLM = 0
+ *
+ * OUT2 must be set in MCR: on the PC it gates the UART's interrupt line
+ * to the PIC, and without it no interrupt ever arrives.
+ *
+ * BUFFERING
+ * ----------
+ * As on the Pi (uart_rpi3.c), output goes into a 4 KB TX ring that the
+ * "THR empty" interrupt drains, 16 bytes per interrupt: the FIFO is
+ * empty when it fires, so 16 bytes always fit.  That interrupt is only
+ * enabled while the ring holds data.  Received bytes are captured into
+ * an RX ring by the "data available" and "timeout" interrupts.
+ *
+ * Unlike uart_rpi3.c, uart_write() never waits: on x86 the serial line
+ * is a log next to the VGA screen, and a full ring (nobody listening, or
+ * a very long burst) must not slow the screen down.  Bytes that do not
+ * fit are dropped.  uart_sync() is the one call that waits.
+ */
+
+#include "uart.h"
+#include "irq.h"
+#include "io.h"
+#include "ring.h"
+#include "trace.h"
+#include <stdint.h>
+
+#define COM1      0x3F8
+#define UART_THR  (COM1 + 0)
+#define UART_RBR  (COM1 + 0)
+#define UART_DLL  (COM1 + 0)
+#define UART_IER  (COM1 + 1)
+#define UART_DLM  (COM1 + 1)
+#define UART_IIR  (COM1 + 2)
+#define UART_FCR  (COM1 + 2)
+#define UART_LCR  (COM1 + 3)
+#define UART_MCR  (COM1 + 4)
+#define UART_LSR  (COM1 + 5)
+#define UART_MSR  (COM1 + 6)
+#define UART_SCR  (COM1 + 7)
+
+#define IER_RX    0x01      /* received data available (and timeout) */
+#define IER_THRE  0x02      /* transmit holding register empty       */
+#define LSR_DR    0x01      /* data ready                            */
+#define LSR_THRE  0x20      /* TX FIFO empty                         */
+
+#define IIR_NONE  0x01      /* bit 0 set: no interrupt pending       */
+#define IIR_ID    0x0E      /* bits 3–1: cause                       */
+#define IIR_MSR   0x00      /*   modem status                        */
+#define IIR_THRE  0x02      /*   THR empty                           */
+#define IIR_RDA   0x04      /*   received data available             */
+#define IIR_LSR   0x06      /*   line status (error)                 */
+#define IIR_TMO   0x0C      /*   RX FIFO timeout                     */
+
+#define UART_FIFO 16
+#define UART_IRQ  4
+
+static uint8_t  tx_storage[4096];
+static ring_t   tx_ring = RING_INIT(tx_storage);
+static uint8_t  rx_storage[1024];
+static ring_t   rx_ring = RING_INIT(rx_storage);
+static int      present;
+
+/* uart_tx_fill() — Ring → FIFO.  Call with IRQs masked. */
+static void uart_tx_fill(void) {
+    uint8_t b;
+    if (inb(UART_LSR) & LSR_THRE)
+        for (int i = 0; i < UART_FIFO && ring_get(&tx_ring, &b); i++)
+            outb(UART_THR, b);
+    outb(UART_IER, ring_empty(&tx_ring) ? IER_RX : IER_RX | IER_THRE);
+}
+
+static void uart_irq(void) {
+    uint8_t iir;
+    while (!((iir = inb(UART_IIR)) & IIR_NONE)) {
+        switch (iir & IIR_ID) {
+        case IIR_RDA:
+        case IIR_TMO:
+            /* Reading RBR until LSR.DR clears is the acknowledgement. */
+            while (inb(UART_LSR) & LSR_DR)
+                ring_put(&rx_ring, inb(UART_RBR));
+            break;
+        case IIR_THRE:      /* reading IIR acknowledged it */
+            uart_tx_fill();
+            break;
+        case IIR_LSR:
+            inb(UART_LSR);
+            break;
+        case IIR_MSR:
+            inb(UART_MSR);
+            break;
+        }
+    }
+}
+
+void uart_init(void) {
+    /* Step 1: is there a UART at all?  The scratch register reads back
+     * what was written only if the chip exists. */
+    outb(UART_SCR, 0x5A);
+    if (inb(UART_SCR) != 0x5A)
+        return;
+    present = 1;
+
+    /* Step 2: no interrupts while configuring. */
+    outb(UART_IER, 0);
+
+    /* Step 3: 115200 baud — divisor 1, written with DLAB set. */
+    outb(UART_LCR, 0x80);
+    outb(UART_DLL, 1);
+    outb(UART_DLM, 0);
+
+    /* Step 4: 8 data bits, no parity, 1 stop bit; clears DLAB. */
+    outb(UART_LCR, 0x03);
+
+    /* Step 5: enable and clear both FIFOs, RX trigger at 14 bytes. */
+    outb(UART_FCR, 0xC7);
+
+    /* Step 6: DTR + RTS, and OUT2 to route the interrupt to the PIC. */
+    outb(UART_MCR, 0x0B);
+
+    /* Step 7: RX interrupts now; THR empty on demand (uart_tx_fill). */
+    outb(UART_IER, IER_RX);
+
+    irq_register(UART_IRQ, uart_irq);
+}
+
+void uart_write(const char *buf, uint32_t len) {
+    if (!present)
+        return;
+    irq_flags_t f = irq_save();
+    while (len && ring_put(&tx_ring, (uint8_t)*buf)) {
+        buf++;
+        len--;
+    }
+    if (len)
+        TRACE(TRACE_UART_FULL, len);   /* dropped */
+    uart_tx_fill();
+    irq_restore(f);
+}
+
+void uart_putc(char c) {
+    uart_write(&c, 1);
+}
+
+/* uart_sync() — Poll the FIFO until the ring is empty, interrupts or not. */
+void uart_sync(void) {
+    if (!present)
+        return;
+    irq_flags_t f = irq_save();
+    while (!ring_empty(&tx_ring))
+        uart_tx_fill();
+    while (!(inb(UART_LSR) & LSR_THRE))
+        ;
+    irq_restore(f);
+}
+
+int uart_poll(char *c) {
+    uint8_t b;
+    if (!ring_get(&rx_ring, &b))
+        return 0;
+    *c = (char)b;
+    return 1;
+}
+
+char uart_getc(void) {
+    uint8_t b;
+    for (;;) {
+        irq_disable();
+        if (ring_get(&rx_ring, &b)) {
+            irq_enable();
+            return (char)b;
+        }
+        cpu_idle();
+    }
+}
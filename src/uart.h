@@ -0,0 +1,54 @@
+/*
+ * uart.h — Buffered, interrupt-driven serial port interface
+ *
+ * On Raspberry Pi 3 (uart_rpi3.c) this drives the PL011 UART0, which is
+ * both the console output and the keyboard of the board.  On x86
+ * (uart.c) it drives the 16550 of COM1, a second console output next to
+ * the VGA screen: QEMU's "-serial stdio" shows it on the host.
+ *
+ * Output is queued in a software TX ring and drained into the hardware
+ * FIFO by the TX interrupt, so writers return as soon as their bytes are
+ * queued.  Input is captured by the RX interrupt into an RX ring, so
+ * bytes that arrive while the shell is busy are not lost.
+ */
+
+#ifndef UART_H
+#define UART_H
+
+#include <stdint.h>
+
+/* uart_init() — Configure 115200 8N1 with FIFOs and install the UART
+ * interrupt handler (call after irq_init()).  Output written before
+ * irq_enable() is queued and starts draining once interrupts are on. */
+void uart_init(void);
+
+/* uart_write() — Queue len raw bytes for transmission (no CRLF
+ * translation).  When the TX ring is full:
+ *   RPi3: blocks until there is room while the UART is the only output,
+ *         drops the rest once the framebuffer shows the text too;
+ *   x86 : drops the rest — the serial log must never hold up VGA. */
+void uart_write(const char *buf, uint32_t len);
+
+#ifdef PLATFORM_RPI3
+/* uart_set_drop() — 1: uart_write() drops what does not fit, as on x86
+ * (fb_init() sets it); 0: it waits for room again.  Returns the previous
+ * setting. */
+int uart_set_drop(int drop);
+#endif
+
+/* uart_putc() — Queue a single raw byte. */
+void uart_putc(char c);
+
+/* uart_sync() — Wait, polling, until everything queued has gone out.
+ * Works with interrupts disabled: for messages before a halt. */
+void uart_sync(void);
+
+/* uart_getc() — Blocking read of one received byte. */
+char uart_getc(void);
+
+/* uart_poll() — Take one received byte into *c if there is one, without
+ * waiting.  Returns 0 if none.  For a reader that also waits for other
+ * input (the x86 keyboard); call with interrupts disabled. */
+int uart_poll(char *c);
+
+#endif
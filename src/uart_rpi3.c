@@ -0,0 +1,212 @@
+/*
+ * uart_rpi3.c — Interrupt-driven PL011 UART0 driver (Raspberry Pi 3B)
+ *
+ * PL011 UART (UART0) — BCM2837 (Pi 3B)
+ * ----------------------------------------
+ * The BCM2837 peripheral base address is 0x3F000000.
+ * PL011 UART0 starts at offset 0x201000, so base = 0x3F201000.
+ *
+ * Key registers (offsets from 0x3F201000):
+ *   0x00  DR    — Data Register: write a byte to TX, read from RX
+ *   0x18  FR    — Flag Register: bits indicate FIFO state
+ *                   bit 5 (TXFF): TX FIFO full
+ *                   bit 4 (RXFE): RX FIFO empty
+ *   0x24  IBRD  — Integer part of baud rate divisor
+ *   0x28  FBRD  — Fractional part of baud rate divisor
+ *   0x2C  LCRH  — Line Control (data bits, parity, stop bits, FIFO enable)
+ *   0x30  CR    — Control Register (enable UART, TX, RX)
+ *   0x34  IFLS  — Interrupt FIFO Level Select
+ *   0x38  IMSC  — Interrupt Mask Set/Clear (1 = interrupt enabled)
+ *   0x40  MIS   — Masked Interrupt Status (what fired)
+ *   0x44  ICR   — Interrupt Clear Register
+ *
+ * BAUD RATE CALCULATION
+ * ----------------------
+ * The UART clock on BCM2837 is 48 MHz.
+ * Divisor = UART_CLK / (16 × baud_rate) = 48 000 000 / (16 × 115 200) = 26.04
+ *   IBRD = 26   (integer part)
+ *   FBRD = round(0.04 × 64) = 3   (fractional part × 64)
+ *
+ * WHY BUFFER IN SOFTWARE?
+ * ------------------------
+ * At 115200 baud one byte takes ≈ 87 µs on the wire, and the hardware
+ * FIFO holds only 16 bytes.  Spinning on FR_TXFF for a screenful of text
+ * would block the CPU for tens of milliseconds.  Instead:
+ *
+ *   TX: writers append to a 4 KB ring and return — or, when it is full,
+ *       wait for room (or drop, if uart_set_drop() said the framebuffer
+ *       shows the text anyway: the screen must not run at 11 KB/s).
+ *       uart_tx_fill() moves bytes from the ring into the FIFO until it
+ *       is full; the TX interrupt (FIFO drained to 1/8 full) calls it
+ *       again.  When the ring is empty the TX interrupt is masked,
+ *       otherwise it would fire forever on an empty FIFO.
+ *
+ *   RX: the RX interrupt (FIFO 1/2 full) and the receive-timeout
+ *       interrupt (data sitting in the FIFO for 32 bit-times, i.e. the
+ *       sender paused) both empty the FIFO into a 1 KB ring.
+ *
+ * The PL011 TX interrupt triggers when the FIFO level CROSSES the
+ * threshold, so the first bytes of a burst must be pushed into the FIFO
+ * by the writer itself — that is why uart_write() calls uart_tx_fill().
+ * Both callers run with IRQs masked, so only one of them touches the
+ * FIFO and the ring's consumer side at a time.
+ */
+
+#include "uart.h"
+#include "irq.h"
+#include "ring.h"
+#include "trace.h"
+#include <stdint.h>
+
+#define UART_BASE  ((volatile uint32_t *)0x3F201000UL)
+
+#define UART_DR    (UART_BASE + 0x00/4)   /* Data Register       */
+#define UART_FR    (UART_BASE + 0x18/4)   /* Flag Register       */
+#define UART_IBRD  (UART_BASE + 0x24/4)   /* Integer baud rate   */
+#define UART_FBRD  (UART_BASE + 0x28/4)   /* Fractional baud rate*/
+#define UART_LCRH  (UART_BASE + 0x2C/4)   /* Line control        */
+#define UART_CR    (UART_BASE + 0x30/4)   /* Control             */
+#define UART_IFLS  (UART_BASE + 0x34/4)   /* FIFO level select   */
+#define UART_IMSC  (UART_BASE + 0x38/4)   /* Interrupt mask      */
+#define UART_MIS   (UART_BASE + 0x40/4)   /* Masked int. status  */
+#define UART_ICR   (UART_BASE + 0x44/4)   /* Interrupt clear     */
+
+#define FR_TXFF  (1 << 5)   /* TX FIFO full  */
+#define FR_RXFE  (1 << 4)   /* RX FIFO empty */
+
+#define INT_RX   (1 << 4)   /* RX FIFO reached its trigger level */
+#define INT_TX   (1 << 5)   /* TX FIFO drained to its trigger level */
+#define INT_RT   (1 << 6)   /* receive timeout */
+
+#define UART_IRQ 57         /* PL011 line on the GPU interrupt controller */
+
+static uint8_t tx_storage[4096];
+static ring_t  tx_ring = RING_INIT(tx_storage);
+static uint8_t rx_storage[1024];
+static ring_t  rx_ring = RING_INIT(rx_storage);
+static int     tx_drop;
+
+/* uart_tx_fill() — Ring → FIFO.  Call with IRQs masked. */
+static void uart_tx_fill(void) {
+    uint8_t b;
+    while (!(*UART_FR & FR_TXFF) && ring_get(&tx_ring, &b))
+        *UART_DR = b;
+    if (ring_empty(&tx_ring))
+        *UART_IMSC &= ~INT_TX;
+    else
+        *UART_IMSC |= INT_TX;
+}
+
+static void uart_irq(void) {
+    uint32_t mis = *UART_MIS;
+
+    if (mis & (INT_RX | INT_RT)) {
+        /* Emptying the FIFO is what de-asserts RX/RT; a full ring drops. */
+        while (!(*UART_FR & FR_RXFE))
+            ring_put(&rx_ring, (uint8_t)(*UART_DR & 0xFF));
+        *UART_ICR = INT_RX | INT_RT;
+    }
+    if (mis & INT_TX) {
+        *UART_ICR = INT_TX;
+        uart_tx_fill();
+    }
+}
+
+void uart_init(void) {
+    /* Step 1: disable the UART before changing any settings. */
+    *UART_CR = 0;
+
+    /* Step 2: clear all pending interrupts. */
+    *UART_ICR = 0x7FF;
+
+    /* Step 3: set baud rate to 115200 bps (clock = 48 MHz).
+     *   IBRD = 26, FBRD = 3  (see calculation above) */
+    *UART_IBRD = 26;
+    *UART_FBRD = 3;
+
+    /* Step 4: configure the line:
+     *   bits [6:5] = 11 → 8-bit data
+     *   bit  [4]   =  1 → enable TX/RX FIFOs
+     *   other bits  =  0 → 1 stop bit, no parity */
+    *UART_LCRH = (3 << 5) | (1 << 4);
+
+    /* Step 5: interrupt thresholds — RX at 1/2 full (bits [5:3] = 010),
+     * TX at 1/8 full (bits [2:0] = 000) — and enable the RX interrupts.
+     * The TX interrupt is unmasked on demand by uart_tx_fill(). */
+    *UART_IFLS = (2 << 3) | 0;
+    *UART_IMSC = INT_RX | INT_RT;
+
+    /* Step 6: enable the UART, TX path, and RX path. */
+    *UART_CR = (1 << 0) | (1 << 8) | (1 << 9);
+
+    irq_register(UART_IRQ, uart_irq);
+}
+
+int uart_set_drop(int drop) {
+    int was = tx_drop;
+    tx_drop = drop;
+    return was;
+}
+
+/*
+ * uart_write() — Queue as much as fits, kick the FIFO, and if the ring is
+ * still full sleep until the TX interrupt has made room (unless in drop
+ * mode: then the rest is discarded, like on x86).  With IRQs
+ * masked by the caller (e.g. from an exception handler) sleeping is not
+ * possible, so the loop keeps calling uart_tx_fill() — i.e. it falls back
+ * to polling the FIFO.
+ */
+void uart_write(const char *buf, uint32_t len) {
+    while (len) {
+        irq_flags_t f = irq_save();
+        while (len && ring_put(&tx_ring, (uint8_t)*buf)) {
+            buf++;
+            len--;
+        }
+        uart_tx_fill();
+        if (len && tx_drop) {
+            TRACE(TRACE_UART_FULL, len);
+            irq_restore(f);
+            return;
+        }
+        if (len && irq_flags_enabled(f)) {
+            TRACE(TRACE_UART_FULL, len);
+            cpu_idle();         /* returns with IRQs enabled, i.e. f */
+        }
+        else
+            irq_restore(f);
+    }
+}
+
+void uart_putc(char c) {
+    uart_write(&c, 1);
+}
+
+/* uart_sync() — Poll the FIFO until the ring is empty, interrupts or not. */
+void uart_sync(void) {
+    irq_flags_t f = irq_save();
+    while (!ring_empty(&tx_ring))
+        uart_tx_fill();
+    irq_restore(f);
+}
+
+int uart_poll(char *c) {
+    uint8_t b;
+    if (!ring_get(&rx_ring, &b))
+        return 0;
+    *c = (char)b;
+    return 1;
+}
+
+char uart_getc(void) {
+    uint8_t b;
+    for (;;) {
+        irq_disable();
+        if (ring_get(&rx_ring, &b)) {
+            irq_enable();
+            return (char)b;
+        }
+        TRACE(TRACE_KBD_WAIT, 0);   /* the UART is the keyboard */
+        cpu_idle();
+    }
+}
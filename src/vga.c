@@ -30,39 +30,152 @@
  * The cursor position is a linear index (row * 80 + col), split across
  * two 8-bit registers because the original hardware was 8-bit wide.
  *
- * SCROLLING
- * ----------
- * When the cursor reaches the last row (row 24), we scroll the screen
- * up by one line: copy rows 1–24 to rows 0–23, then clear row 24.
+ * Each of those port writes is a VM exit under QEMU/KVM, so the cursor
+ * is NOT moved after every character.  Drawing only updates the logical
+ * position; vga_flush() programs the CRTC once, and only the registers
+ * whose value actually changed (typing on one line touches just the low
+ * byte).  Printing the whole `help` text thus costs a handful of port
+ * writes instead of about two thousand.
+ *
+ * SHADOW BUFFER
+ * --------------
+ * Video memory is slow: every access crosses the bus to the video card
+ * (a VM exit under QEMU/KVM), and READS are much slower still than
+ * writes.  So the authoritative copy of the screen lives in normal RAM
+ * and all drawing happens there.  For every screen row we remember the
+ * span of columns that changed since the last flush.  vga_flush() then
+ * copies just those spans to 0xB8000 — write-only, never reading video
+ * memory back.
+ *
+ * Each public function flushes once when it returns, so printing a whole
+ * line costs one bulk copy instead of one MMIO access per character.
+ *
+ * The driver does not print on its own behalf: vga_init() registers it
+ * as a DIRECT sink of the console (console.h), and all text reaches it
+ * through console_write().
+ *
+ * SCROLLING AND SCROLLBACK
+ * -------------------------
+ * The RAM copy is not a linear 80×25 array but a circular buffer of
+ * VGA_SCROLLBACK lines.  `top` is a free-running line counter: screen
+ * row r lives in line (top + r) mod VGA_SCROLLBACK.
+ *
+ *   lines[]:  ... | old | old | top+0 | top+1 | ... | top+24 | free ...
+ *                               \_________ live screen _________/
+ *
+ * Scrolling one line is just top++ plus blanking the new bottom line:
+ * constant cost, no matter how many lines are kept.  The lines above
+ * `top` are the history.  A viewport offset (`view`, in lines) selects
+ * which 25 lines are displayed; Shift+PgUp / Shift+PgDn in keyboard.c
+ * move it, and any new output snaps back to the live screen.
+ *
+ * Video memory itself is linear, so after a scroll every row is dirty
+ * and the next flush rewrites the whole screen — but only once per
+ * flush, however many lines scrolled in between.
  */
 
 #include "vga.h"
+#include "console.h"
+#include "timer.h"
 #include "io.h"
+#include "kstring.h"
+#include "fpu.h"
+#include "trace.h"
 #include <stdint.h>
 
 /* Pointer to VGA video memory. volatile prevents the compiler from
  * caching reads or eliminating writes — the hardware reads this memory
  * asynchronously to refresh the display. */
+#ifndef PLATFORM_HOST
 static volatile uint16_t *const VGA_MEM = (volatile uint16_t *)0xB8000;
+#else
+extern uint16_t host_vga_mem[];     /* make PLATFORM=host: a RAM buffer */
+static volatile uint16_t *const VGA_MEM = host_vga_mem;
+#endif
 
 static int     cursor_row   = 0;
 static int     cursor_col   = 0;
 static uint8_t current_color = 0x07;   /* light grey (7) on black (0) */
 
+/* Circular line buffer: 512 lines × 80 cells × 2 bytes = 80 KB. */
+#define VGA_SCROLLBACK 512                  /* must be a power of two */
+#define LINE_MASK      (VGA_SCROLLBACK - 1)
+#define HISTORY_MAX    (VGA_SCROLLBACK - VGA_HEIGHT)
+
+static uint16_t lines[VGA_SCROLLBACK][VGA_WIDTH];
+static uint32_t top;        /* line counter of screen row 0         */
+static uint32_t view;       /* lines scrolled back (0 = live screen) */
+static uint32_t history;    /* lines available above the live screen */
+
+/* Per screen row, the dirty column span [dirty_lo, dirty_hi).
+ * dirty_lo >= dirty_hi means the row is clean. */
+static uint8_t  dirty_lo[VGA_HEIGHT];
+static uint8_t  dirty_hi[VGA_HEIGHT];
+
+/* live_line() — Cells of screen row `row` of the live screen. */
+static uint16_t *live_line(int row) {
+    return lines[(top + (uint32_t)row) & LINE_MASK];
+}
+
+/* view_line() — Cells displayed on screen row `row` (honours `view`). */
+static uint16_t *view_line(int row) {
+    return lines[(top - view + (uint32_t)row) & LINE_MASK];
+}
+
 /* Pack a character and attribute byte into one VGA cell entry. */
 static uint16_t vga_entry(char c, uint8_t color) {
     return (uint16_t)(uint8_t)c | ((uint16_t)color << 8);
 }
 
+/* mark_dirty() — Grow row's dirty span to include column col. */
+static void mark_dirty(int row, int col) {
+    if (dirty_lo[row] >= dirty_hi[row]) {
+        dirty_lo[row] = (uint8_t)col;
+        dirty_hi[row] = (uint8_t)(col + 1);
+    } else {
+        if (col < dirty_lo[row])  dirty_lo[row] = (uint8_t)col;
+        if (col >= dirty_hi[row]) dirty_hi[row] = (uint8_t)(col + 1);
+    }
+}
+
+static void mark_all_dirty(void) {
+    for (int row = 0; row < VGA_HEIGHT; row++) {
+        dirty_lo[row] = 0;
+        dirty_hi[row] = VGA_WIDTH;
+    }
+}
+
+/* put_cell() — Write one cell of the live screen. */
+static void put_cell(int row, int col, uint16_t entry) {
+    live_line(row)[col] = entry;
+    mark_dirty(row, col);
+}
+
+/* blank_line() — Fill a ring line with spaces in the current colour. */
+static void blank_line(uint16_t *line) {
+    memset16(line, vga_entry(' ', current_color), VGA_WIDTH);
+}
+
+/* Position last written to the CRTC; 0xFFFF forces the first sync. */
+static uint16_t hw_cursor = 0xFFFF;
+
 /*
- * vga_update_cursor() — Write the logical cursor position to the
- * VGA hardware cursor registers so the blinking cursor matches the
- * software position.  Must be called after every cursor movement.
+ * vga_sync_cursor() — Move the hardware cursor to the logical position,
+ * writing only the CRTC bytes that changed.  Called by vga_flush().
+ * While the view is scrolled back the cursor is parked just past the
+ * last cell, which hides it.
  */
-static void vga_update_cursor(void) {
-    uint16_t pos = (uint16_t)(cursor_row * VGA_WIDTH + cursor_col);
-    outb(0x3D4, 0x0F); outb(0x3D5, (uint8_t)(pos & 0xFF));  /* low byte  */
-    outb(0x3D4, 0x0E); outb(0x3D5, (uint8_t)(pos >> 8));    /* high byte */
+static void vga_sync_cursor(void) {
+    uint16_t pos = view ? VGA_WIDTH * VGA_HEIGHT
+                        : (uint16_t)(cursor_row * VGA_WIDTH + cursor_col);
+    if (pos == hw_cursor) return;
+    if ((pos ^ hw_cursor) & 0x00FF) {
+        outb(0x3D4, 0x0F); outb(0x3D5, (uint8_t)(pos & 0xFF));  /* low byte  */
+    }
+    if ((pos ^ hw_cursor) & 0xFF00) {
+        outb(0x3D4, 0x0E); outb(0x3D5, (uint8_t)(pos >> 8));    /* high byte */
+    }
+    hw_cursor = pos;
 }
 
 /* vga_set_color() — Set the attribute byte for subsequent output.
@@ -71,31 +184,87 @@ void vga_set_color(uint8_t fg, uint8_t bg) {
     current_color = (bg << 4) | (fg & 0x0F);
 }
 
+/*
+ * vga_flush() — Copy every dirty span of the viewport to video memory
+ * and sync the hardware cursor.  Only writes to 0xB8000, never reads
+ * from it.
+ */
+void vga_flush(void) {
+    for (int row = 0; row < VGA_HEIGHT; row++) {
+        int lo = dirty_lo[row], hi = dirty_hi[row];
+        if (lo < hi)
+            memcpy((uint16_t *)&VGA_MEM[row * VGA_WIDTH + lo], &view_line(row)[lo],
+                   (size_t)(hi - lo) * sizeof(uint16_t));
+        dirty_lo[row] = dirty_hi[row] = 0;
+    }
+    vga_sync_cursor();
+}
+
+/* snap_to_live() — New output always shows up on the live screen. */
+static void snap_to_live(void) {
+    if (view) {
+        view = 0;
+        mark_all_dirty();
+    }
+}
+
+/*
+ * vga_scrollback() — Move the viewport `n` lines into the history
+ * (n > 0) or back towards the live screen (n < 0).
+ */
+void vga_scrollback(int n) {
+    int64_t target = (int64_t)view + n;
+    if (target < 0) target = 0;
+    if (target > history) target = history;
+    if ((uint32_t)target == view) return;
+    view = (uint32_t)target;
+    mark_all_dirty();
+    vga_flush();
+}
+
+static console_sink_t vga_sink;   /* defined below, with vga_write() */
+
 void vga_init(void) {
     current_color = 0x07;
     vga_clear();
+    history = 0;            /* nothing worth scrolling back to yet */
+    console_register(&vga_sink);
+}
+
+/* push_history() — `n` more lines have left the top of the screen. */
+static void push_history(uint32_t n) {
+    history = history + n < HISTORY_MAX ? history + n : HISTORY_MAX;
 }
 
-/* vga_clear() — Fill all 2000 cells with a space and reset the cursor. */
+/* vga_clear() — Start a blank screen and reset the cursor.  The old
+ * screen is pushed into the history rather than erased. */
 void vga_clear(void) {
-    for (int i = 0; i < VGA_WIDTH * VGA_HEIGHT; i++)
-        VGA_MEM[i] = vga_entry(' ', current_color);
+    top += VGA_HEIGHT;
+    push_history(VGA_HEIGHT);
+    view = 0;
+    for (int row = 0; row < VGA_HEIGHT; row++)
+        blank_line(live_line(row));
+    mark_all_dirty();
     cursor_row = 0;
     cursor_col = 0;
-    vga_update_cursor();
+    vga_flush();
 }
 
-/* vga_scroll() — Shift every row up by one and blank the last row. */
+/* vga_scroll() — Advance the ring by one line and blank the new bottom
+ * row.  Constant cost; the next flush redraws the screen. */
 static void vga_scroll(void) {
-    for (int row = 0; row < VGA_HEIGHT - 1; row++)
-        for (int col = 0; col < VGA_WIDTH; col++)
-            VGA_MEM[row * VGA_WIDTH + col] = VGA_MEM[(row + 1) * VGA_WIDTH + col];
-    for (int col = 0; col < VGA_WIDTH; col++)
-        VGA_MEM[(VGA_HEIGHT - 1) * VGA_WIDTH + col] = vga_entry(' ', current_color);
+    TRACE(TRACE_VGA_SCROLL, 0);
+    top++;
+    push_history(1);
+    blank_line(live_line(VGA_HEIGHT - 1));
+    mark_all_dirty();
     cursor_row = VGA_HEIGHT - 1;
 }
 
-void vga_putchar(char c) {
+/* vga_put() — Draw one character into the ring, without flushing. */
+static void vga_put(char c) {
+    TRACE(TRACE_VGA_PUT, (uint8_t)c);
+    snap_to_live();
     if (c == '\n') {
         cursor_col = 0;
         cursor_row++;
@@ -104,10 +273,10 @@ void vga_putchar(char c) {
     } else if (c == '\b') {
         if (cursor_col > 0) {
             cursor_col--;
-            VGA_MEM[cursor_row * VGA_WIDTH + cursor_col] = vga_entry(' ', current_color);
+            put_cell(cursor_row, cursor_col, vga_entry(' ', current_color));
         }
     } else {
-        VGA_MEM[cursor_row * VGA_WIDTH + cursor_col] = vga_entry(c, current_color);
+        put_cell(cursor_row, cursor_col, vga_entry(c, current_color));
         cursor_col++;
         if (cursor_col >= VGA_WIDTH) {
             cursor_col = 0;
@@ -116,48 +285,69 @@ void vga_putchar(char c) {
     }
     if (cursor_row >= VGA_HEIGHT)
         vga_scroll();
-    vga_update_cursor();    /* always sync hardware cursor */
-}
-
-void vga_print(const char *str) {
-    while (*str) vga_putchar(*str++);
-}
-
-void vga_newline(void) {
-    vga_putchar('\n');
 }
 
-void vga_print_int(uint32_t n) {
-    if (n == 0) { vga_putchar('0'); return; }
-    char buf[12];
-    int i = 0;
-    while (n > 0) { buf[i++] = '0' + (n % 10); n /= 10; }
-    for (int j = i - 1; j >= 0; j--)
-        vga_putchar(buf[j]);
+/* vga_write() — The console sink: draw the whole buffer into the ring,
+ * then flush once. */
+static void vga_write(const char *buf, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++)
+        vga_put(buf[i]);
+    vga_flush();
 }
 
-void vga_print_int2(uint8_t n) {
-    vga_putchar('0' + (n / 10));
-    vga_putchar('0' + (n % 10));
-}
+static console_sink_t vga_sink = {
+    .name   = "vga",
+    .write  = vga_write,
+    .policy = CONSOLE_DIRECT,
+};
 
 /*
  * vga_flash() — Visual bell.
- * Swap foreground and background colours of every cell, pause, then
- * swap back.  The effect is a full-screen colour inversion flash.
+ * Write every displayed cell to video memory with foreground and
+ * background swapped, pause for VGA_FLASH_MS, then restore the screen
+ * from the RAM copy.  The effect is a full-screen colour inversion flash
+ * of the same length on every machine.
+ *
+ * Swapping the two nibbles of the attribute byte is the same shift-and-
+ * mask on every cell, so with SSE2 (fpu.c) it is done 8 cells at a time:
+ * cells8_t is a GCC vector type, and target("sse2") lets the compiler use
+ * XMM registers for it in this one function.
  */
-void vga_flash(void) {
-    for (int i = 0; i < VGA_WIDTH * VGA_HEIGHT; i++) {
-        uint16_t entry = VGA_MEM[i];
+#define VGA_FLASH_MS 100
+
+typedef uint16_t cells8_t __attribute__((vector_size(16)));
+
+static void invert_row(uint16_t *dst, const uint16_t *src) {
+    for (int col = 0; col < VGA_WIDTH; col++) {
+        uint16_t entry = src[col];
         uint8_t attr = (uint8_t)(entry >> 8);
         uint8_t inv  = (uint8_t)(((attr & 0x0F) << 4) | ((attr >> 4) & 0x0F));
-        VGA_MEM[i] = (entry & 0x00FF) | ((uint16_t)inv << 8);
+        dst[col] = (entry & 0x00FF) | ((uint16_t)inv << 8);
     }
-    for (volatile int i = 0; i < 5000000; i++);
-    for (int i = 0; i < VGA_WIDTH * VGA_HEIGHT; i++) {
-        uint16_t entry = VGA_MEM[i];
-        uint8_t attr = (uint8_t)(entry >> 8);
-        uint8_t inv  = (uint8_t)(((attr & 0x0F) << 4) | ((attr >> 4) & 0x0F));
-        VGA_MEM[i] = (entry & 0x00FF) | ((uint16_t)inv << 8);
+}
+
+__attribute__((target("sse2")))
+static void invert_row_sse2(uint16_t *dst, const uint16_t *src) {
+    for (int col = 0; col < VGA_WIDTH; col += 8) {
+        cells8_t c;
+        __builtin_memcpy(&c, &src[col], sizeof(c));     /* any alignment */
+        c = (c & 0x00FF) | ((c << 4) & 0xF000) | ((c >> 4) & 0x0F00);
+        __builtin_memcpy(&dst[col], &c, sizeof(c));
+    }
+}
+
+void vga_flash(void) {
+    uint16_t inv[VGA_WIDTH];
+
+    vga_flush();
+    for (int row = 0; row < VGA_HEIGHT; row++) {
+        if (fpu_simd())
+            invert_row_sse2(inv, view_line(row));
+        else
+            invert_row(inv, view_line(row));
+        memcpy((uint16_t *)&VGA_MEM[row * VGA_WIDTH], inv, sizeof(inv));
     }
+    timer_sleep_ms(VGA_FLASH_MS);
+    mark_all_dirty();
+    vga_flush();
 }
@@ -15,10 +15,15 @@
  * Example: attribute 0x07 = light grey (7) on black (0) = default.
  *          attribute 0x1F = white (15) on blue (1).
  *
- * On Raspberry Pi 3 this header is still included, but the
- * implementation (vga_rpi3.c) sends ANSI escape sequences over
- * UART instead of writing to VGA memory.  The interface is
- * identical so shell.c compiles unchanged on both platforms.
+ * Text does not go through this header: everything the kernel prints
+ * goes to the console (console.h), and vga_init() registers the screen
+ * as one of its sinks.  What remains here is display CONTROL — clear,
+ * colour, visual bell, scrollback.
+ *
+ * On Raspberry Pi 3 the display is the serial terminal and, when there
+ * is one, the HDMI framebuffer (fb.h): vga_rpi3.c implements the same
+ * calls with ANSI escape sequences and on the framebuffer, and the text
+ * itself reaches both through their console sinks.
  */
 
 #ifndef VGA_H
@@ -53,30 +58,14 @@ typedef enum {
     VGA_COLOR_WHITE         = 15,
 } vga_color_t;
 
-/* vga_init()    — Clear screen, reset cursor and colour. */
+/* vga_init()    — Clear screen, reset cursor and colour, and register
+ *                 the screen as a console sink (x86, and the RPi3
+ *                 framebuffer; call after console_init()). */
 void vga_init(void);
 
 /* vga_clear()   — Fill the screen with spaces in the current colour. */
 void vga_clear(void);
 
-/* vga_putchar() — Write one character at the cursor and advance it.
- *   '\n' moves to the next line (with scroll if needed).
- *   '\b' moves the cursor one position left and erases the cell. */
-void vga_putchar(char c);
-
-/* vga_print()   — Write a null-terminated string. */
-void vga_print(const char *str);
-
-/* vga_newline() — Shorthand for vga_putchar('\n'). */
-void vga_newline(void);
-
-/* vga_print_int()  — Print an unsigned 32-bit integer in decimal. */
-void vga_print_int(uint32_t n);
-
-/* vga_print_int2() — Print a uint8 as exactly two decimal digits,
- *                    zero-padded (e.g. 7 → "07", 23 → "23"). */
-void vga_print_int2(uint8_t n);
-
 /* vga_set_color() — Change the foreground/background colour for
  *                   all subsequent output.
  *   fg, bg: colour index (bg only uses 0–7). */
@@ -85,4 +74,21 @@ void vga_set_color(uint8_t fg, uint8_t bg);
 /* vga_flash() — Visual bell: briefly invert the entire screen. */
 void vga_flash(void);
 
+/* vga_flush() — Push pending output to the device.
+ *   x86 : copy the dirty spans of the RAM shadow buffer to 0xB8000 and
+ *         move the hardware cursor (only here: drawing does not touch
+ *         the CRTC).  Every vga_* call and every console write already
+ *         flushes once before it returns.
+ *   RPi3: no-op (the UART TX interrupt drains its queue on its own, and
+ *         the framebuffer is flushed at the end of every write). */
+void vga_flush(void);
+
+/* vga_scrollback() — Scroll the view n lines back into the history
+ * (n > 0) or forward towards the live screen (n < 0).  Any new output
+ * returns to the live screen.
+ *   x86 : 512-line ring buffer, bound to Shift+PgUp / Shift+PgDn.
+ *   RPi3: no-op (the terminal emulator keeps its own scrollback; the
+ *         framebuffer keeps none). */
+void vga_scrollback(int n);
+
 #endif
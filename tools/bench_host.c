@@ -0,0 +1,551 @@
+/*
+ * bench_host.c — Unit tests and micro-benchmarks of kernel code, run on
+ *                the build machine: make PLATFORM=host bench-host
+ *
+ * Booting QEMU to find out whether a formatter change broke "%08x", or
+ * made the console slower, takes a while.  The code that needs no real
+ * hardware — printf formatting (kprintf.c), the console sinks
+ * (console.c), the VGA scrollback ring (vga.c), the note parser
+ * (sound_seq.c), the wall clock (rtc.c), the initrd's tar reader
+ * (initrd.c), the line editor (readline.c) — is compiled here as an ordinary
+ * program instead, against the fakes of host_mock.h, and checked in a
+ * fraction of a second.
+ *
+ * TESTS
+ * ------
+ * CHECK(cond) counts a failure and prints its line; the program exits
+ * with status 1 if any check failed, and `make` fails with it.
+ *
+ * BENCHMARKS
+ * -----------
+ * Each case runs a batch of operations N times (default 15, or argv[1]);
+ * the table gives min / median / max nanoseconds per operation, like the
+ * kernel's `bench` (cmd_bench.c).  The build machine is not the target:
+ * the numbers compare two versions of the code on the same machine, they
+ * do not predict speeds in QEMU.
+ *
+ * The build machine must be x86 (32 or 64-bit): vga.c keeps its SSE2
+ * path and clock.h its RDTSC.
+ */
+
+#include "host_mock.h"
+#include "kprintf.h"
+#include "console.h"
+#include "vga.h"
+#include "sound.h"
+#include "rtc.h"
+#include "initrd.h"
+#include "keyboard.h"
+#include "slab.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* ── Checks ───────────────────────────────────────────────────────── */
+
+static int checks, failures;
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+static void check(int ok, const char *what, int line) {
+    checks++;
+    if (!ok) {
+        failures++;
+        printf("FAIL line %d: %s\n", line, what);
+    }
+}
+
+/* CHECK_FMT() — ksnprintf() of the arguments must give `want`. */
+#define CHECK_FMT(want, ...) do {                                       \
+        char got_[64];                                                  \
+        ksnprintf(got_, sizeof(got_), __VA_ARGS__);                     \
+        check_str(got_, (want), __LINE__);                              \
+    } while (0)
+
+static void check_str(const char *got, const char *want, int line) {
+    checks++;
+    if (strcmp(got, want) != 0) {
+        failures++;
+        printf("FAIL line %d: \"%s\", expected \"%s\"\n", line, got, want);
+    }
+}
+
+/* row_text() — Characters of screen row `row`, trailing spaces cut. */
+static const char *row_text(int row) {
+    static char s[VGA_WIDTH + 1];
+    int n = 0;
+    for (int col = 0; col < VGA_WIDTH; col++)
+        s[n++] = (char)(host_vga_mem[row * VGA_WIDTH + col] & 0xFF);
+    while (n > 0 && s[n - 1] == ' ')
+        n--;
+    s[n] = '\0';
+    return s;
+}
+
+static int io_is(unsigned i, uint16_t port, uint8_t val, uint8_t out) {
+    return i < host_io_len && host_io[i].port == port &&
+           host_io[i].val == val && host_io[i].out == out;
+}
+
+/* ── Tests ────────────────────────────────────────────────────────── */
+
+static void test_format(void) {
+    char b[8];
+
+    CHECK_FMT("-42", "%d", -42);
+    CHECK_FMT("   42|42   |00042", "%5d|%-5d|%05u", 42, 42, 42u);
+    CHECK_FMT("-0042", "%05d", -42);
+    CHECK_FMT("beef BEEF 0000beef", "%x %X %08x", 0xbeefu, 0xbeefu, 0xbeefu);
+    CHECK_FMT("4294967296", "%llu", 1ull << 32);
+    CHECK_FMT("18446744073709551615", "%llu", 18446744073709551615ull);
+    CHECK_FMT("-9223372036854775808", "%lld", (long long)INT64_MIN);
+    CHECK_FMT("123 -5", "%zu %ld", (size_t)123, -5l);
+    CHECK_FMT("[  abc][abc  ]", "[%5s][%-5s]", "abc", "abc");
+    CHECK_FMT("[   7]", "[%*u]", 4, 7u);
+    CHECK_FMT("0x1f", "%p", (void *)0x1f);
+    CHECK_FMT("x%y", "%c%%%c", 'x', 'y');
+
+    CHECK(ksnprintf(b, sizeof(b), "%s", "truncated") == 9);
+    check_str(b, "truncat", __LINE__);
+    CHECK(ksnprintf(b, 0, "%u", 1234u) == 4);
+}
+
+static void test_rtc(void) {
+    CHECK(bcd2dec(0x00) == 0);
+    CHECK(bcd2dec(0x47) == 47);
+    CHECK(bcd2dec(0x59) == 59);
+    CHECK(bcd2dec(0x99) == 99);
+
+    /* Index to 0x70, io_wait()'s write to 0x80, data from 0x71. */
+    host_cmos[0x09] = 0x26;
+    host_reset_io();
+    CHECK(cmos_read(0x09) == 0x26);
+    CHECK(host_io_len == 3);
+    CHECK(io_is(0, 0x70, 0x09, 1));
+    CHECK(io_is(1, 0x80, 0x00, 1));
+    CHECK(io_is(2, 0x71, 0x26, 0));
+}
+
+/* rtc_is() — rtc_now() must give this date and time. */
+static int rtc_is(uint16_t y, uint8_t mo, uint8_t d, uint8_t h, uint8_t mi,
+                  uint8_t s) {
+    rtc_time_t t;
+    rtc_now(&t);
+    return t.year == y && t.month == mo && t.day == d &&
+           t.hour == h && t.min == mi && t.sec == s;
+}
+
+static void test_wall_clock(void) {
+    rtc_time_t t;
+
+    rtc_civil(0, &t);
+    CHECK(t.year == 1970 && t.month == 1 && t.day == 1 && t.weekday == 4);
+    rtc_civil(951782400, &t);
+    CHECK(t.year == 2000 && t.month == 2 && t.day == 29 && t.weekday == 2);
+    rtc_civil(4102444799u, &t);
+    CHECK(t.year == 2099 && t.month == 12 && t.day == 31 && t.hour == 23 &&
+          t.min == 59 && t.sec == 59);
+
+    /* One BCD, 24-hour reading at boot, then the nanosecond clock. */
+    static const uint8_t boot[][2] = {
+        { 0x00, 0x58 }, { 0x02, 0x59 }, { 0x04, 0x23 }, { 0x07, 0x31 },
+        { 0x08, 0x12 }, { 0x09, 0x99 }, { 0x32, 0x19 }, { 0x0A, 0x26 },
+        { 0x0B, 0x02 },
+    };
+    for (unsigned i = 0; i < sizeof(boot) / sizeof(boot[0]); i++)
+        host_cmos[boot[i][0]] = boot[i][1];
+    host_ms = 0;
+    rtc_init();
+    CHECK(rtc_is(1999, 12, 31, 23, 59, 58));
+    CHECK(strcmp(rtc_source(), "cmos") == 0);
+    CHECK(host_irq[8] && (host_cmos[0x0B] & 0x10));     /* IRQ 8 asked for */
+
+    host_ms = 1999;
+    host_reset_io();
+    CHECK(rtc_is(1999, 12, 31, 23, 59, 59));
+    CHECK(host_io_len == 0);                            /* no port access */
+    host_ms = 2000;
+    rtc_now(&t);
+    CHECK(t.year == 2000 && t.month == 1 && t.day == 1 && t.hour == 0 &&
+          t.weekday == 6);
+
+    /* Update ended: binary, 12-hour registers, 1 PM.  The time restarts
+     * from them, IRQ 8 goes off until the resync event. */
+    host_cmos[0x00] = 0;  host_cmos[0x02] = 0;  host_cmos[0x04] = 0x81;
+    host_cmos[0x07] = 29; host_cmos[0x08] = 2;  host_cmos[0x09] = 24;
+    host_cmos[0x32] = 20; host_cmos[0x0B] = 0x04 | 0x10;
+    host_cmos[0x0C] = 0x10;
+    host_ms = 5000;
+    host_irq[8]();
+    CHECK(rtc_is(2024, 2, 29, 13, 0, 0));
+    CHECK(strcmp(rtc_source(), "cmos, irq 8") == 0);
+    CHECK(!(host_cmos[0x0B] & 0x10));
+    CHECK(host_timer_fire() && host_ms == 5000 + RTC_RESYNC_S * 1000);
+    CHECK(host_cmos[0x0B] & 0x10);
+    CHECK(rtc_is(2024, 2, 29, 14, 0, 0));
+
+    /* Not an update-ended interrupt: nothing changes. */
+    host_cmos[0x0C] = 0x00;
+    host_cmos[0x04] = 0x05;
+    host_irq[8]();
+    CHECK(rtc_is(2024, 2, 29, 14, 0, 0));
+}
+
+static uint16_t flashed[VGA_WIDTH * VGA_HEIGHT];
+
+static void snapshot(uint32_t ms) {
+    (void)ms;
+    memcpy(flashed, host_vga_mem, sizeof(flashed));
+}
+
+/* Registered in the kernel's order: serial sink first, then the screen. */
+static void test_console(void) {
+    console_init();
+    vga_init();
+    CHECK(host_vga_mem[0] == 0x0720 && host_vga_mem[VGA_WIDTH * VGA_HEIGHT - 1] == 0x0720);
+    CHECK(host_cursor() == 0);
+
+    /* Drawn at once, one CRTC byte pair for the cursor; the serial line
+     * waits for the end of the line. */
+    host_reset_io();
+    host_reset_uart();
+    console_write("hello", 5);
+    check_str(row_text(0), "hello", __LINE__);
+    CHECK(host_vga_mem[0] == (0x0700 | 'h'));
+    CHECK(host_io_len == 2 && io_is(0, 0x3D4, 0x0F, 1) && io_is(1, 0x3D5, 5, 1));
+    CHECK(host_uart_len == 0);
+    console_write("\nab\b", 4);
+    console_flush();
+    CHECK(host_uart_len == 12 && memcmp(host_uart, "hello\r\nab\b \b", 12) == 0);
+    check_str(row_text(1), "a", __LINE__);
+    CHECK(host_cursor() == VGA_WIDTH + 1);
+
+    /* Wrapping at column 80. */
+    vga_clear();
+    for (int i = 0; i < VGA_WIDTH + 5; i++)
+        console_putchar('x');
+    CHECK(strlen(row_text(0)) == VGA_WIDTH);
+    check_str(row_text(1), "xxxxx", __LINE__);
+
+    /* Scrolling, then the scrollback view and the return to the live
+     * screen with new output. */
+    vga_clear();
+    for (int i = 0; i < 30; i++)
+        kprintf("L%02d\n", i);
+    check_str(row_text(0), "L06", __LINE__);
+    check_str(row_text(VGA_HEIGHT - 2), "L29", __LINE__);
+    check_str(row_text(VGA_HEIGHT - 1), "", __LINE__);
+    CHECK(host_cursor() == (VGA_HEIGHT - 1) * VGA_WIDTH);
+    vga_scrollback(6);
+    check_str(row_text(0), "L00", __LINE__);
+    CHECK(host_cursor() == VGA_WIDTH * VGA_HEIGHT);     /* hidden */
+    vga_scrollback(-100);
+    check_str(row_text(0), "L06", __LINE__);
+    vga_scrollback(3);
+    console_write("z", 1);
+    check_str(row_text(0), "L06", __LINE__);
+    check_str(row_text(VGA_HEIGHT - 1), "z", __LINE__);
+
+    /* Colour, and the visual bell with and without SSE2. */
+    vga_set_color(VGA_COLOR_WHITE, VGA_COLOR_BLUE);
+    console_write("c", 1);
+    vga_set_color(VGA_COLOR_LIGHT_GREY, VGA_COLOR_BLACK);
+    int cell = (VGA_HEIGHT - 1) * VGA_WIDTH + 1;
+    CHECK(host_vga_mem[cell] == (0x1F00 | 'c'));
+
+    host_sleep_hook = snapshot;
+    for (host_simd = 0; host_simd <= 1; host_simd++) {
+        memset(flashed, 0, sizeof(flashed));
+        vga_flash();
+        CHECK(flashed[cell] == (0xF100 | 'c'));
+        CHECK(flashed[0] == (0x7000 | 'L'));
+        CHECK(host_vga_mem[cell] == (0x1F00 | 'c'));
+    }
+    host_simd = 0;
+    host_sleep_hook = 0;
+
+    vga_clear();
+    check_str(row_text(VGA_HEIGHT - 1), "", __LINE__);
+    CHECK(host_cursor() == 0);
+}
+
+/* readline() — keyboard_readline() of the bytes keys, on a clear
+ * screen; returns what it read. */
+static const char *readline(const char *keys) {
+    static char buf[16];
+    console_flush();
+    vga_clear();
+    host_reset_uart();
+    host_keys = keys;
+    keyboard_readline(buf, sizeof(buf));
+    return buf;
+}
+
+/* Runs after test_console(): the serial and VGA sinks are registered. */
+static void test_readline(void) {
+    /* A paste is taken in one wake-up and echoed in one write: one
+     * update of the VGA cursor, one wait for keys. */
+    host_key_waits = 0;
+    host_reset_io();
+    check_str(readline("note do\r\nmeminfo\r"), "note do", __LINE__);
+    CHECK(host_key_waits == 1 && host_io_len == 2);
+    check_str(row_text(0), "note do", __LINE__);
+    CHECK(host_uart_len == 9 && memcmp(host_uart, "note do\r\n", 9) == 0);
+    check_str(readline(host_keys), "meminfo", __LINE__);    /* rest queued */
+
+    /* Backspace (BS and DEL), control bytes, and a line cut at max - 1. */
+    check_str(readline("ab\bc\x7f" "d\x01\n"), "ad", __LINE__);
+    check_str(readline("0123456789abcdefXYZ\r"), "0123456789abcde", __LINE__);
+    check_str(readline("\r"), "", __LINE__);
+
+    /* History: ESC [ A and ESC O A go back, ESC [ B forward, past the
+     * newest to the line being typed; a repeat is stored once. */
+    check_str(readline("\x1b[A\r"), "0123456789abcde", __LINE__);
+    check_str(readline("\x1b[A\x1b" "OA\r"), "ad", __LINE__);
+    check_str(readline("\x1b[A\x1b[A\x1b[A\x1b[A\x1b[A\r"), "note do", __LINE__);
+    check_str(readline("\x1b[A\x1b[A\x1b[A\x1b[A\x1b[A\x1b[A\x1b[A\r"), "note do",
+              __LINE__);                                /* the oldest */
+    check_str(readline("x\x1b[A\x1b[B\x1b[By\r"), "xy", __LINE__);
+    check_str(readline("\x1b[A\x1b[A\x1b[A\x1b[A\x1b[B\r"), "ad", __LINE__);
+    check_str(row_text(0), "ad", __LINE__);                 /* redrawn */
+
+    /* Other sequences are swallowed, a lone ESC is dropped. */
+    check_str(readline("\x1b[2~a\x1b[1;5Cb\x1b" "c\r"), "abc", __LINE__);
+
+    /* Each line is a kmalloc() block; the newest frees the oldest, in
+     * the cache the short lines above came from. */
+    const kmem_cache_t *c = kmem_cache_list();
+    while (c && c->obj_size != 16)
+        c = c->next;
+    CHECK(c && c->in_use == 9);
+    char line[8];
+    for (int i = 0; i < 40; i++) {
+        snprintf(line, sizeof(line), "l%d\r", i);
+        readline(line);
+    }
+    CHECK(c && c->in_use == 32 && c->slabs == 1);
+    check_str(readline("\x1b[A\x1b[A\r"), "l38", __LINE__);
+}
+
+/* The PIT periods of la4 (440 Hz) and la5 at 1193180 Hz. */
+#define LA4 2712
+#define LA5 1356
+
+static uint16_t first_tone(const char *tune) {
+    return sound_sequence(tune) ? host_tone : 0;
+}
+
+static void test_sound(void) {
+    /* One beat at 120 bpm: 438 ms of tone, 62 ms of gap, then silence. */
+    host_ms = 1000;
+    CHECK(sound_sequence("la"));
+    CHECK(host_tone == LA4 && sound_playing());
+    CHECK(host_timer_fire() && host_ms == 1438 && host_tone == 0);
+    CHECK(host_timer_fire() && host_ms == 1500 && host_tone == 0);
+    CHECK(!host_timer_fire() && !sound_playing());
+
+    /* Tempo and octave, and the same note under every spelling. */
+    host_ms = 0;
+    CHECK(first_tone("t60 o5 la") == LA5);
+    CHECK(host_timer_fire() && host_ms == 875);
+    CHECK(first_tone("la5") == LA5);
+    CHECK(first_tone("o5 la4") == LA4);
+    CHECK(first_tone("la#4") == first_tone("sib4"));
+    CHECK(first_tone("si4") == first_tone("dob5"));
+    CHECK(first_tone("do4") > first_tone("do#4"));
+
+    /* A rest is one silent beat. */
+    host_ms = 0;
+    CHECK(sound_sequence("- la") && host_tone == 0);
+    CHECK(host_timer_fire() && host_ms == 500 && host_tone == LA4);
+    sound_stop();
+    CHECK(!sound_playing() && host_tone == 0);
+
+    /* One bad token and nothing plays at all. */
+    const char *bad[] = { "la9", "o9 la", "t10 la", "t601", "xyz", "la wrong",
+                          "sol#55", "dododododo", "o", "t" };
+    for (unsigned i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        int ok = sound_sequence(bad[i]);
+        check(!ok && !sound_playing() && host_tone == 0, bad[i], __LINE__);
+    }
+}
+
+/* tar_add() — Append one ustar entry to the archive in a; returns the
+ * offset after its data. */
+static uint32_t tar_add(uint8_t *a, uint32_t at, const char *name, char type,
+                        const char *data) {
+    uint8_t *h = a + at;
+    uint32_t len = (uint32_t)strlen(data), sum = 0;
+
+    memset(h, 0, 512);
+    strcpy((char *)h, name);
+    snprintf((char *)h + 124, 12, "%011o", len);
+    h[156] = (uint8_t)type;
+    memcpy(h + 257, "ustar\0" "00", 8);
+    memset(h + 148, ' ', 8);
+    for (int i = 0; i < 512; i++)
+        sum += h[i];
+    snprintf((char *)h + 148, 8, "%06o", sum);
+    memcpy(h + 512, data, len);
+    return at + 512 + (len + 511) / 512 * 512;
+}
+
+static void test_initrd(void) {
+    static uint8_t a[8192];
+    initrd_file_t f = { 0 };
+    uint32_t end;
+
+    end = tar_add(a, 0, "./", '5', "");
+    end = tar_add(a, end, "./rc", '0', "date\nbench 5\n");
+    end = tar_add(a, end, "notes", '0', "");
+    end = tar_add(a, end, "big", '0', "0123456789");
+    memset(a + end, 0, 1024);                           /* end marker */
+
+    CHECK(initrd_init(a, end + 1024) == 3);
+    CHECK(initrd_size() == end);
+    CHECK(initrd_next(&f) && strcmp(f.name, "rc") == 0 && f.size == 13);
+    CHECK(f.data == (const char *)a + 1024);            /* in place */
+    CHECK(initrd_next(&f) && strcmp(f.name, "notes") == 0 && f.size == 0);
+    CHECK(initrd_next(&f) && strcmp(f.name, "big") == 0);
+    CHECK(!initrd_next(&f));
+    CHECK(initrd_open("big", &f) && memcmp(f.data, "0123456789", 10) == 0);
+    CHECK(!initrd_open("nothing", &f) && !initrd_open("", &f));
+
+    /* A truncated file, then a bad checksum: the archive ends before. */
+    CHECK(initrd_init(a, end - 512) == 2);
+    CHECK(!initrd_open("big", &f));
+    a[512 + 148] ^= 1;
+    CHECK(initrd_init(a, sizeof(a)) == 0 && !initrd_open("rc", &f));
+    CHECK(initrd_init(0, 0) == 0 && initrd_size() == 0);
+}
+
+/* ── Benchmarks ───────────────────────────────────────────────────── */
+
+#define SAMPLES_DEFAULT 15
+#define SAMPLES_MAX     101
+
+typedef struct {
+    const char *name;
+    void      (*run)(unsigned ops);
+    unsigned    ops;                /* per sample */
+} host_case_t;
+
+static char line_row[VGA_WIDTH], line_scroll[VGA_WIDTH];
+static volatile int sink;           /* results the compiler must keep */
+
+static void run_format(unsigned ops) {
+    char b[64];
+    for (unsigned i = 0; i < ops; i++)
+        sink += ksnprintf(b, sizeof(b), "%d %s %08x", (int)i, "abc", i);
+}
+
+static void run_format64(unsigned ops) {
+    char b[64];
+    for (unsigned i = 0; i < ops; i++)
+        sink += ksnprintf(b, sizeof(b), "%llu", 12345678901234567ull + i);
+}
+
+static void run_row(unsigned ops) {
+    host_reset_uart();
+    for (unsigned i = 0; i < ops; i++)
+        console_write(line_row, VGA_WIDTH);
+}
+
+static void run_scroll(unsigned ops) {
+    host_reset_uart();
+    for (unsigned i = 0; i < ops; i++)
+        console_write(line_scroll, VGA_WIDTH);
+}
+
+static void run_clear(unsigned ops) {
+    for (unsigned i = 0; i < ops; i++)
+        vga_clear();
+}
+
+static void run_scrollback(unsigned ops) {
+    for (unsigned i = 0; i < ops; i++)
+        vga_scrollback(i & 1 ? -1 : 1);
+}
+
+static void run_rtc_civil(unsigned ops) {
+    rtc_time_t t;
+    for (unsigned i = 0; i < ops; i++) {
+        rtc_civil(1700000000u + i * 86399u, &t);
+        sink += t.day;
+    }
+}
+
+static void run_sequence(unsigned ops) {
+    for (unsigned i = 0; i < ops; i++)
+        sink += sound_sequence("t140 o5 do re mi fa sol la si do6 - "
+                               "si la sol fa mi re do4");
+}
+
+static const host_case_t cases[] = {
+    { "ksnprintf %d %s %08x",     run_format,     1000 },
+    { "ksnprintf %llu",           run_format64,   1000 },
+    { "console 80 ch, one row",   run_row,        100 },
+    { "console 80 ch, scrolling", run_scroll,     100 },
+    { "vga_clear",                run_clear,      100 },
+    { "vga_scrollback +1 / -1",   run_scrollback, 100 },
+    { "rtc_civil",                run_rtc_civil,  1000 },
+    { "sound_sequence 16 notes",  run_sequence,   100 },
+};
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void bench(unsigned n) {
+    uint64_t v[SAMPLES_MAX];
+
+    for (int i = 0; i < VGA_WIDTH - 1; i++)
+        line_row[i] = line_scroll[i] = (char)('0' + i % 10);
+    line_row[VGA_WIDTH - 1]    = '\r';
+    line_scroll[VGA_WIDTH - 1] = '\n';
+
+    printf("\n%u samples each, ns per operation\n", n);
+    printf("%-28s%10s%10s%10s\n", "case", "min", "median", "max");
+    for (unsigned c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        const host_case_t *hc = &cases[c];
+        hc->run(hc->ops);                               /* warm-up */
+        for (unsigned i = 0; i < n; i++) {
+            uint64_t t0 = now_ns();
+            hc->run(hc->ops);
+            v[i] = (now_ns() - t0) / hc->ops;
+        }
+        qsort(v, n, sizeof(v[0]), cmp_u64);
+        printf("%-28s%10llu%10llu%10llu\n", hc->name, (unsigned long long)v[0],
+               (unsigned long long)v[n / 2], (unsigned long long)v[n - 1]);
+    }
+}
+
+int main(int argc, char **argv) {
+    unsigned n = argc > 1 ? (unsigned)atoi(argv[1]) : SAMPLES_DEFAULT;
+    if (n < 1 || n > SAMPLES_MAX) {
+        fprintf(stderr, "usage: %s [samples, 1-%d]\n", argv[0], SAMPLES_MAX);
+        return 2;
+    }
+
+    slab_init();                    /* for the history, as in kernel_main() */
+    test_format();
+    test_rtc();
+    test_wall_clock();
+    test_console();
+    test_readline();
+    test_sound();
+    test_initrd();
+    printf("%d checks, %d failed\n", checks, failures);
+
+    bench(n);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+/*
+ * host_mock.c — Fake hardware and kernel services for make PLATFORM=host
+ *
+ * See host_mock.h for what each fake stands for.  Only one timer event
+ * is kept — the sequencer (sound_seq.c) and the RTC resync (rtc.c) never
+ * arm more than one each, and no test runs both at once.
+ */
+
+#include "host_mock.h"
+#include "io.h"
+#include "timer.h"
+#include "clock.h"
+#include "uart.h"
+#include "task.h"
+#include "fpu.h"
+#include "sound.h"
+#include "kstring.h"
+#include "vga.h"
+#include "keyboard.h"
+#include "pmm.h"
+#include <stdint.h>
+
+host_io_t host_io[HOST_IO_LOG];
+unsigned  host_io_len;
+uint8_t   host_cmos[128];
+static uint8_t cmos_index;
+static uint8_t crtc_index, crtc[32];
+
+uint16_t  host_vga_mem[VGA_WIDTH * VGA_HEIGHT];
+
+char      host_uart[HOST_UART_BUF];
+unsigned  host_uart_len;
+
+uint32_t  host_ms;
+void    (*host_sleep_hook)(uint32_t ms);
+
+irq_handler_t host_irq[16];
+
+const char *host_keys = "";
+unsigned    host_key_waits;
+
+uint16_t  host_tone;
+int       host_simd;
+
+static timer_event_t *armed;
+
+void host_reset_io(void)   { host_io_len = 0; }
+void host_reset_uart(void) { host_uart_len = 0; }
+
+static void log_io(uint16_t port, uint8_t val, uint8_t out) {
+    if (host_io_len < HOST_IO_LOG)
+        host_io[host_io_len++] = (host_io_t){ port, val, out };
+}
+
+/* ── io.h ─────────────────────────────────────────────────────────── */
+
+uint8_t inb(uint16_t port) {
+    uint8_t val = port == 0x71 ? host_cmos[cmos_index & 0x7F] : 0xFF;
+    log_io(port, val, 0);
+    return val;
+}
+
+void outb(uint16_t port, uint8_t val) {
+    if (port == 0x70)
+        cmos_index = val;
+    if (port == 0x71)
+        host_cmos[cmos_index & 0x7F] = val;
+    if (port == 0x3D4)
+        crtc_index = val & 0x1F;
+    if (port == 0x3D5)
+        crtc[crtc_index] = val;
+    log_io(port, val, 1);
+}
+
+uint16_t host_cursor(void) {
+    return (uint16_t)(crtc[0x0E] << 8 | crtc[0x0F]);
+}
+
+/* ── timer.h, clock.h ─────────────────────────────────────────────── */
+
+uint64_t clock_base;
+uint32_t clock_mult;                /* 0: clock_ns() = timer_ticks() ms */
+
+uint32_t timer_ticks(void) {
+    return host_ms;
+}
+
+void timer_sleep_ms(uint32_t ms) {
+    if (host_sleep_hook)
+        host_sleep_hook(ms);
+    host_ms += ms;
+}
+
+int timer_at(timer_event_t *ev, uint64_t when, timer_fn_t fn, void *arg) {
+    ev->when = when;
+    ev->fn   = fn;
+    ev->arg  = arg;
+    ev->pos  = 1;
+    armed    = ev;
+    return 1;
+}
+
+int timer_cancel(timer_event_t *ev) {
+    int pending = ev->pos != 0;
+    ev->pos = 0;
+    if (armed == ev)
+        armed = 0;
+    return pending;
+}
+
+int host_timer_fire(void) {
+    timer_event_t *ev = armed;
+    if (!ev)
+        return 0;
+    armed   = 0;
+    ev->pos = 0;
+    host_ms = (uint32_t)(ev->when / 1000000u);
+    ev->fn(ev->arg);
+    return 1;
+}
+
+/* ── irq.h ────────────────────────────────────────────────────────── */
+
+void irq_register(unsigned irq, irq_handler_t handler) {
+    if (irq < 16)
+        host_irq[irq] = handler;
+}
+
+/* ── uart.h ───────────────────────────────────────────────────────── */
+
+void uart_write(const char *buf, uint32_t len) {
+    for (uint32_t i = 0; i < len && host_uart_len < HOST_UART_BUF; i++)
+        host_uart[host_uart_len++] = buf[i];
+}
+
+void uart_putc(char c) {
+    uart_write(&c, 1);
+}
+
+void uart_sync(void) {
+}
+
+/* ── keyboard.h, pmm.h ────────────────────────────────────────────── */
+
+int keyboard_key(int wait) {
+    if (wait)
+        host_key_waits++;
+    while (*host_keys) {
+        int k = keyboard_serial(*host_keys++);
+        if (k != KEY_NONE)
+            return k;
+    }
+    return wait ? '\n' : KEY_NONE;
+}
+
+/* Pages for the slabs of the tests, never freed. */
+static uint8_t  pages[4 * PAGE_SIZE] __attribute__((aligned(PAGE_SIZE)));
+static uint32_t pages_used;
+
+void *pmm_alloc(unsigned order) {
+    uint32_t size = (uint32_t)PAGE_SIZE << order;
+    if (size > sizeof(pages) - pages_used)
+        return 0;
+    pages_used += size;
+    return pages + pages_used - size;
+}
+
+/* ── task.h, fpu.h, kstring.h, sound.h ────────────────────────────── */
+
+void sched_lock(void)   { }
+void sched_unlock(void) { }
+
+int fpu_simd(void) {
+    return host_simd;
+}
+
+void memset16(uint16_t *dst, uint16_t v, size_t n) {
+    while (n--)
+        *dst++ = v;
+}
+
+void sound_hw_tone(uint16_t period) { host_tone = period; }
+void sound_hw_off(void)             { host_tone = 0; }
@@ -0,0 +1,83 @@
+/*
+ * host_mock.h — The machine and the rest of the kernel, faked for
+ *               `make PLATFORM=host` (tools/host_mock.c)
+ *
+ * tools/bench_host.c runs kernel translation units — kprintf.c,
+ * console.c, vga.c, rtc.c, initrd.c, readline.c, slab.c, trace.c and
+ * sound_seq.c — as an ordinary program on
+ * the build machine.  Built with -DPLATFORM_HOST, they find here what
+ * they would get from the hardware and from the other kernel files:
+ *
+ *   port I/O (io.h)         every inb() / outb() is appended to host_io[];
+ *                           port 0x71 reads and writes host_cmos[], indexed
+ *                           by the last byte written to port 0x70, and the
+ *                           CRTC cursor registers (0x3D4 / 0x3D5) are kept
+ *                           for host_cursor()
+ *   VGA memory (vga.c)      host_vga_mem[], in place of 0xB8000
+ *   serial (uart.h)         uart_write() appends to host_uart[]
+ *   time (timer.h, clock.h) host_ms, moved on by timer_sleep_ms() and by
+ *                           the tests; clock_ns() follows it (clock_mult
+ *                           is 0, the "no TSC" path of clock.h)
+ *   timer events            timer_at() only records the event:
+ *                           host_timer_fire() runs it when asked
+ *   interrupt handlers      irq_register() stores them in host_irq[]: a
+ *                           test raises IRQ n by calling host_irq[n]()
+ *   keyboard (keyboard.h)   keyboard_key() decodes host_keys, a string of
+ *                           serial bytes, with keyboard_serial(); a
+ *                           waiting call on an empty string counts in
+ *                           host_key_waits and returns Enter
+ *   page allocator (pmm.h)  pmm_alloc() hands out a static 16 KB, once
+ *   sound back-end          the last period given to sound_hw_tone()
+ *   scheduler, FPU          no-ops; fpu_simd() returns host_simd
+ *
+ * The interrupt masking of irq.h needs no mock: PLATFORM_HOST makes it
+ * empty (a user program may not execute CLI).
+ */
+
+#ifndef HOST_MOCK_H
+#define HOST_MOCK_H
+
+#include "irq.h"
+#include <stdint.h>
+
+#define HOST_IO_LOG   256
+#define HOST_UART_BUF 8192
+
+typedef struct {
+    uint16_t port;
+    uint8_t  val;
+    uint8_t  out;               /* 1: outb(), 0: inb() */
+} host_io_t;
+
+extern host_io_t host_io[HOST_IO_LOG];
+extern unsigned  host_io_len;   /* accesses logged (at most HOST_IO_LOG) */
+extern uint8_t   host_cmos[128];
+
+extern uint16_t  host_vga_mem[];        /* 80 × 25 cells */
+
+extern char      host_uart[HOST_UART_BUF];
+extern unsigned  host_uart_len;         /* bytes kept; the rest dropped */
+
+extern uint32_t  host_ms;
+extern void    (*host_sleep_hook)(uint32_t ms);    /* while "sleeping" */
+
+extern irq_handler_t host_irq[16];
+
+extern const char *host_keys;           /* the bytes still to be typed */
+extern unsigned    host_key_waits;      /* keyboard_key(1) calls */
+
+extern uint16_t  host_tone;             /* 0: silent */
+extern int       host_simd;
+
+/* host_reset_io() / host_reset_uart() — Empty the logs. */
+void host_reset_io(void);
+void host_reset_uart(void);
+
+/* host_cursor() — Hardware cursor position, as last programmed. */
+uint16_t host_cursor(void);
+
+/* host_timer_fire() — Move host_ms to the armed event's deadline and run
+ * it.  Returns 0 if no event is armed. */
+int host_timer_fire(void);
+
+#endif
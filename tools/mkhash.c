@@ -0,0 +1,66 @@
+/*
+ * mkhash.c — Build-time perfect hash generator (runs on the HOST)
+ *
+ * Usage:  mkhash PREFIX key1 key2 ...
+ *
+ * Finds a seed for phash() (src/phash.h) under which all keys fall into
+ * distinct slots of a power-of-two table of at least 2 × (number of
+ * keys) entries, and prints it as C preprocessor definitions:
+ *
+ *     #define PREFIX_HASH_SEED 3u
+ *     #define PREFIX_HASH_SIZE 32u
+ *
+ * The Makefile collects the keys from the sources (SHELL_COMMAND() lines,
+ * colour table entries) and appends the output of each run to
+ * build/<platform>/shell_hash.h.  A key given twice is an error: no seed
+ * could ever separate it from itself.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "phash.h"
+
+#define MAX_SEED 1000000u
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s PREFIX key...\n", argv[0]);
+        return 2;
+    }
+    const char *prefix = argv[1];
+    char **keys = argv + 2;
+    int n = argc - 2;
+
+    for (int i = 0; i < n; i++)
+        for (int j = i + 1; j < n; j++)
+            if (strcmp(keys[i], keys[j]) == 0) {
+                fprintf(stderr, "mkhash: %s: duplicate key '%s'\n", prefix, keys[i]);
+                return 1;
+            }
+
+    uint32_t size = 2;
+    while (size < 2u * (uint32_t)n)
+        size <<= 1;
+
+    unsigned char *used = malloc(size);
+    for (uint32_t seed = 0; seed < MAX_SEED; seed++) {
+        int i;
+        memset(used, 0, size);
+        for (i = 0; i < n; i++) {
+            uint32_t slot = phash_slot(seed, size, keys[i]);
+            if (used[slot]) break;
+            used[slot] = 1;
+        }
+        if (i == n) {
+            printf("/* %s: %d keys, generated by tools/mkhash.c - do not edit */\n", prefix, n);
+            printf("#define %s_HASH_SEED %uu\n", prefix, seed);
+            printf("#define %s_HASH_SIZE %uu\n", prefix, size);
+            free(used);
+            return 0;
+        }
+    }
+    fprintf(stderr, "mkhash: %s: no perfect seed below %u\n", prefix, MAX_SEED);
+    free(used);
+    return 1;
+}
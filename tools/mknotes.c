@@ -0,0 +1,121 @@
+/*
+ * mknotes.c — Build-time note table generator (runs on the HOST)
+ *
+ * Usage:  mknotes CLOCK_HZ > note_table.h
+ *
+ * Prints the tables sound_seq.c plays from, so that the kernel never
+ * computes a frequency or a period:
+ *
+ *   note_period[]   CLOCK_HZ / f rounded, the back-end's period unit, of
+ *                   every semitone from do1 (C1, 32.70 Hz) to si8 (B8,
+ *                   7902 Hz): 8 octaves × 12.
+ *                     x86 : 1193180, the PIT channel 2 divisor.  Lower
+ *                           octaves do not fit the 16-bit counter.
+ *                     RPi3: 96000, PWM samples per HALF period at
+ *                           192,000 samples per second.
+ *   note_names[]    the solfège names — naturals, sharps (do#) and
+ *                   flats (reb) — at their phash() slot, each with its
+ *                   semitone within the octave.
+ *
+ * Frequencies are equal-tempered from A4 = 440 Hz:
+ *
+ *     f = 440 × 2^((n − 57) / 12),   n = 12 × octave + semitone
+ *
+ * (C0 is n = 0, so A4 is 12 × 4 + 9 = 57).  Like tools/mkhash.c, the
+ * seed search tries 0, 1, 2, … until all names land in distinct slots
+ * of a power-of-two table at least twice as large as the name count.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "phash.h"
+
+#define OCTAVE_FIRST  1
+#define OCTAVE_LAST   8
+#define MAX_SEED      1000000u
+
+/* Semitones from do of the same octave; dob and si# cross into the
+ * neighbouring octave. */
+static const struct {
+    const char *name;
+    int         semitone;
+} names[] = {
+    { "dob", -1 }, { "do",   0 }, { "do#",   1 },
+    { "reb",  1 }, { "re",   2 }, { "re#",   3 },
+    { "mib",  3 }, { "mi",   4 }, { "mi#",   5 },
+    { "fab",  4 }, { "fa",   5 }, { "fa#",   6 },
+    { "solb", 6 }, { "sol",  7 }, { "sol#",  8 },
+    { "lab",  8 }, { "la",   9 }, { "la#",  10 },
+    { "sib", 10 }, { "si",  11 }, { "si#",  12 },
+};
+
+#define NAME_COUNT (int)(sizeof(names) / sizeof(names[0]))
+
+int main(int argc, char **argv) {
+    double clock_hz = argc == 2 ? atof(argv[1]) : 0;
+    if (clock_hz <= 0) {
+        fprintf(stderr, "usage: %s CLOCK_HZ\n", argv[0]);
+        return 2;
+    }
+
+    uint32_t size = 2;
+    while (size < 2u * NAME_COUNT)
+        size <<= 1;
+
+    int *slot_of = malloc(size * sizeof(int));
+    uint32_t seed;
+    for (seed = 0; seed < MAX_SEED; seed++) {
+        int i;
+        for (uint32_t s = 0; s < size; s++)
+            slot_of[s] = -1;
+        for (i = 0; i < NAME_COUNT; i++) {
+            uint32_t s = phash_slot(seed, size, names[i].name);
+            if (slot_of[s] >= 0) break;
+            slot_of[s] = i;
+        }
+        if (i == NAME_COUNT)
+            break;
+    }
+    if (seed == MAX_SEED) {
+        fprintf(stderr, "mknotes: no perfect seed below %u\n", MAX_SEED);
+        return 1;
+    }
+
+    printf("/* note_table.h: generated by tools/mknotes.c - do not edit.\n"
+           " * Included by sound_seq.c only. */\n\n");
+    printf("#define NOTE_CLOCK_HZ     %.0fu\n", clock_hz);
+    printf("#define NOTE_OCTAVE_FIRST %d\n", OCTAVE_FIRST);
+    printf("#define NOTE_OCTAVE_LAST  %d\n", OCTAVE_LAST);
+    printf("#define NOTE_COUNT        %d\n", 12 * (OCTAVE_LAST - OCTAVE_FIRST + 1));
+    printf("#define NOTE_HASH_SEED    %uu\n", seed);
+    printf("#define NOTE_HASH_SIZE    %uu\n\n", size);
+
+    printf("/* period of semitone n, do%d = 0 */\n", OCTAVE_FIRST);
+    printf("static const uint16_t note_period[NOTE_COUNT] = {\n");
+    for (int oct = OCTAVE_FIRST; oct <= OCTAVE_LAST; oct++) {
+        printf("   ");
+        for (int st = 0; st < 12; st++) {
+            double f = 440.0 * pow(2.0, (12 * oct + st - 57) / 12.0);
+            long period = lround(clock_hz / f);
+            if (period < 1 || period > 65535) {
+                fprintf(stderr, "mknotes: period %ld out of 16 bits\n", period);
+                return 1;
+            }
+            printf(" %5ld,", period);
+        }
+        printf("   /* octave %d */\n", oct);
+    }
+    printf("};\n\n");
+
+    printf("typedef struct {\n    const char *name;\n    int8_t      semitone;\n} note_name_t;\n\n");
+    printf("static const note_name_t note_names[NOTE_HASH_SIZE] = {\n");
+    for (uint32_t s = 0; s < size; s++)
+        if (slot_of[s] >= 0)
+            printf("    [%2u] = { \"%s\", %d },\n", s, names[slot_of[s]].name,
+                   names[slot_of[s]].semitone);
+    printf("};\n");
+    free(slot_of);
+    return 0;
+}
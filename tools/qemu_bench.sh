@@ -0,0 +1,128 @@
+#!/bin/sh
+#
+# qemu_bench.sh — Boot ExigeOS headless in QEMU, run the benchmarks, and
+#                 print the results as CSV (used by `make bench`)
+#
+#   usage: qemu_bench.sh PLATFORM N qemu-command...
+#
+# The kernel reads its keyboard input from the serial port too
+# (keyboard.c), so a script can type at the shell prompt like a user:
+#
+#   bootstats        how long the boot took
+#   bench N          the in-kernel benchmarks, N samples per case
+#   exit 0           leave QEMU (qemu.h)
+#
+# QEMU's stdout is the serial console: it is kept in $BENCH_LOG
+# (default: bench.log) and parsed into one line per result on stdout:
+#
+#   platform,case,unit,min,median,max
+#   x86,boot,ms,41.220,41.220,41.220
+#   x86,boot: pmm_init,ms,0.180,0.180,0.180
+#   x86,memcpy 4 KB,MB/s,8123,8410,8477
+#
+# EXIT STATUS
+# -----------
+# QEMU's exit status says whether the kernel got as far as `exit 0`.
+# isa-debug-exit (x86) turns the code written to its port into
+# 2 × code + 1, so success is 1 there; semihosting SYS_EXIT (RPi3)
+# passes the code through, so success is 0.  A run that does not reach
+# it — a hang before the prompt, a crash in a benchmark — is stopped
+# after $BENCH_TIMEOUT seconds (default 300) and fails the script.
+#
+# The commands wait BENCH_DELAY seconds (default 3) before being typed:
+# until the kernel has set up its UART, what QEMU delivers may be lost.
+# The blank lines in front of them clear whatever half line did arrive.
+
+set -u
+
+if [ $# -lt 3 ]; then
+    echo "usage: $0 PLATFORM N qemu-command..." >&2
+    exit 2
+fi
+
+platform=$1
+samples=$2
+shift 2
+
+log=${BENCH_LOG:-bench.log}
+delay=${BENCH_DELAY:-3}
+
+case $platform in
+    x86)  ok=1 ;;
+    *)    ok=0 ;;
+esac
+
+{
+    sleep "$delay"
+    printf '\n\nbootstats\nbench %s\nexit 0\n' "$samples"
+} | timeout "${BENCH_TIMEOUT:-300}" "$@" > "$log" 2>&1
+status=$?
+
+if [ "$status" -ne "$ok" ]; then
+    echo "qemu_bench: QEMU exited with $status, expected $ok — see $log" >&2
+    exit 1
+fi
+
+# ── Parse the serial log ────────────────────────────────────────────
+#
+# The tables are the ones cmd_boot.c and cmd_bench.c print, in fixed
+# columns:
+#
+#   bootstats  "phase" (24 columns), "at (ms)" (10), "took (ms)" (11)
+#   bench      "case" (18), "unit" (9), then min, median, max (11 each)
+#
+# A table ends at the first blank line.  Names may contain spaces and
+# commas ("text, one row"), so they are cut by column, not by field,
+# and quoted in the CSV when they need it.
+
+tr -d '\r' < "$log" | awk -v platform="$platform" '
+    function trim(s) {
+        sub(/^ +/, "", s)
+        sub(/ +$/, "", s)
+        return s
+    }
+    function csv(s) {
+        if (s ~ /[,"]/) {
+            gsub(/"/, "\"\"", s)
+            s = "\"" s "\""
+        }
+        return s
+    }
+    function out(name, unit, min, med, max) {
+        print platform "," csv(name) "," unit "," min "," med "," max
+        found++
+    }
+
+    BEGIN           { print "platform,case,unit,min,median,max" }
+
+    /^$/            { table = ""; next }
+    /^phase +at/    { table = "boot"; next }
+    /^case +unit/   { table = "bench"; next }
+
+    table == "boot" {
+        name = trim(substr($0, 1, 24))
+        n = split(substr($0, 25), f, " ")
+        if (n == 2 && name != "first prompt")
+            out("boot: " name, "ms", f[2], f[2], f[2])
+        next
+    }
+    table == "bench" {
+        name = trim(substr($0, 1, 18))
+        unit = trim(substr($0, 19, 9))
+        n = split(substr($0, 28), f, " ")
+        if (n == 3)
+            out(name, unit, f[1], f[2], f[3])
+        next
+    }
+
+    /^_start to first prompt: / {
+        out("boot", "ms", $5, $5, $5)
+    }
+
+    END {
+        if (!found) {
+            print "qemu_bench: no results in the log" > "/dev/stderr"
+            exit 1
+        }
+    }
+'